@@ -0,0 +1,113 @@
+#ifndef TUE_CONTROL_ADAPTIVE_NOTCH_H_
+#define TUE_CONTROL_ADAPTIVE_NOTCH_H_
+
+#include <tue/config/configuration.h>
+
+#include "tue/control/discrete_filter.h"
+#include "tue/control/spectral.h"
+
+namespace tue
+{
+namespace control
+{
+
+// Notch filter that tracks the dominant resonance in the error signal. A bank of recursive DFT bins
+// (with exponential forgetting) spanning [min_frequency, max_frequency] estimates the spectrum of
+// the error with constant work per sample. Every 'update_interval' samples the peak bin is refined
+// by parabolic interpolation, and if it stands out enough the notch is retuned in place.
+//
+// The notch and the spectrum estimate are discretized for the nominal sample time only; the actual
+// elapsed time (ControllerInput::dt) is not used. With a varying sample time the frequencies are
+// therefore off by the relative deviation from the nominal sample time (e.g. 2% at 20 us jitter
+// on 1 kHz), which is small compared to the notch width for the usual jitter.
+//
+// Example configuration (in the 'filters' group of GenericController):
+//
+//     adaptive_notch:
+//       frequency: 40          # initial notch frequency [Hz]
+//       min_frequency: 20
+//       max_frequency: 100
+//       dz: 0.02               # notch depth (zero damping)
+//       dp: 0.5                # notch width (pole damping)
+//       bins: 16               # optional, at most MAX_BINS
+//       forgetting: 0.999      # optional, per sample forgetting factor of the spectrum estimate
+//       update_interval: 100   # optional, samples between retunes
+//       min_peak_ratio: 4      # optional, peak / mean power required to retune
+//       adaptation: 0.3        # optional, smoothing of the frequency estimate (0, 1]
+
+class AdaptiveNotch
+{
+
+public:
+
+    static const unsigned int MAX_BINS = 32;
+
+    AdaptiveNotch();
+
+    ~AdaptiveNotch();
+
+    void configure(tue::Configuration& config, double dt);
+
+    /// False if the parameters passed to the last configure() were invalid
+    bool is_configured() const { return num_bins_ > 0; }
+
+    /// Filters 'x' and feeds 'error' to the resonance estimator
+    double update(double x, double error);
+
+    double frequency() const { return frequency_; }
+
+    /// Clears the filter state. The frequency and spectrum estimate are kept.
+    void reset() { state_ = FilterState(); }
+
+    /// Presets the filter state to output y in steady state (the notch passes DC)
+    void reset(double y) { presetFilter(coefficients_, state_, y); }
+
+    static const unsigned int STATE_SIZE = 3;
+
+    /// Saves the notch frequency and filter state. The spectrum estimate is not saved and is
+    /// rebuilt after a restore.
+    void saveState(double* state) const;
+
+    void restoreState(const double* state);
+
+private:
+
+    double dt_;
+
+    double dz_;
+
+    double dp_;
+
+    // Filter
+
+    FilterCoefficients coefficients_;
+
+    FilterState state_;
+
+    double frequency_;
+
+    // Resonance estimation
+
+    DFTBin bins_[MAX_BINS];
+
+    unsigned int num_bins_;
+
+    double forgetting_;
+
+    unsigned int update_interval_;
+
+    unsigned int count_;
+
+    double min_peak_ratio_;
+
+    double adaptation_;
+
+    void retune();
+
+};
+
+} // end namespace control
+
+} // end namespace tue
+
+#endif
@@ -0,0 +1,99 @@
+#ifndef TUE_CONTROL_BATCH_SIMULATION_H_
+#define TUE_CONTROL_BATCH_SIMULATION_H_
+
+#include <memory>
+#include <vector>
+
+namespace tue
+{
+namespace control
+{
+
+class SupervisedController;
+
+// ----------------------------------------------------------------------------------------------------
+
+/// Mass-damper plant used for closed-loop batch simulation: mass * acc = output - damping * vel
+struct BatchPlant
+{
+    BatchPlant() : mass(1), damping(0), position(0), velocity(0) {}
+
+    double mass;
+    double damping;
+
+    // Initial state
+    double position;
+    double velocity;
+};
+
+// ----------------------------------------------------------------------------------------------------
+
+// Runs a group of controllers for many ticks at once (offline analysis). All traces are row-major
+// arrays of size() x num_ticks values, i.e., trace[j * num_ticks + t] is the value of joint j at
+// tick t, so they can be shared with (C-contiguous) NumPy arrays without copying.
+//
+// The joints are independent, so they are divided over num_threads threads (0 = one per core); each
+// thread writes the contiguous traces of its own joints. The controllers are not reset, so
+// consecutive runs continue where the previous one stopped.
+
+class BatchSimulation
+{
+
+public:
+
+    BatchSimulation();
+
+    ~BatchSimulation();
+
+    void addController(const std::shared_ptr<SupervisedController>& controller);
+
+    unsigned int size() const { return controllers_.size(); }
+
+    const std::shared_ptr<SupervisedController>& controller(unsigned int i) const { return controllers_[i]; }
+
+    void setNumThreads(unsigned int num_threads) { num_threads_ = num_threads; }
+
+    /// Sets the plant of joint i for closed-loop runs
+    void setPlant(unsigned int i, const BatchPlant& plant) { plants_[i] = plant; }
+
+    const BatchPlant& plant(unsigned int i) const { return plants_[i]; }
+
+    /// Updates the controllers with recorded measurements
+    /**
+    @param measurements input trace
+    @param num_ticks number of ticks
+    @param outputs controller output trace
+    @param errors (optional) tracking error trace
+    */
+    void runOpenLoop(const double* measurements, unsigned int num_ticks, double* outputs, double* errors = 0);
+
+    /// Updates the controllers in closed loop with their plant. The plant state is kept for the next run.
+    /**
+    @param references (optional) position reference trace, applied while the controller is ACTIVE
+    @param num_ticks number of ticks
+    @param positions plant position trace (the measurement of the next tick)
+    @param outputs controller output trace
+    */
+    void runClosedLoop(const double* references, unsigned int num_ticks, double* positions, double* outputs);
+
+private:
+
+    std::vector<std::shared_ptr<SupervisedController> > controllers_;
+
+    std::vector<BatchPlant> plants_;
+
+    unsigned int num_threads_;
+
+    void runJoint(unsigned int j, const double* measurements, const double* references, unsigned int num_ticks,
+                  double* positions, double* outputs, double* errors, bool closed_loop);
+
+    void run(const double* measurements, const double* references, unsigned int num_ticks,
+             double* positions, double* outputs, double* errors, bool closed_loop);
+
+};
+
+} // end namespace control
+
+} // end namespace tue
+
+#endif
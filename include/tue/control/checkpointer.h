@@ -0,0 +1,110 @@
+#ifndef TUE_CONTROL_CHECKPOINTER_H_
+#define TUE_CONTROL_CHECKPOINTER_H_
+
+#include "tue/control/supervised_controller.h"
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace tue
+{
+namespace control
+{
+
+static const unsigned int MAX_CHECKPOINT_CONTROLLERS = 32;
+
+/// Layout of the shared memory segment. The sequence is a sequence lock over both slots: checkpoint
+/// set k (k = 1, 2, ...) is written to slot (k & 1) while the sequence is 2k - 1 (odd), and
+/// published by setting it to 2k. The latest complete set is therefore set (sequence / 2); a
+/// sequence of 0 or 1 means nothing has been published yet. A writer that finds the sequence odd
+/// (the previous writer died while writing) writes that set again.
+struct CheckpointBuffer
+{
+    std::atomic<unsigned long> sequence;
+
+    unsigned int num_controllers[2];
+
+    ControllerCheckpoint slots[2][MAX_CHECKPOINT_CONTROLLERS];
+};
+
+// ----------------------------------------------------------------------------------------------------
+
+// Checkpoints a set of controllers into a shared memory double buffer, so that a restarted or
+// standby process can continue where the previous one stopped, without re-homing.
+//
+// The writer (the real-time loop) marks the sequence odd, fills the slot that is not the latest and
+// then publishes it by making the sequence even again; it never waits. The reader (restore) copies
+// the latest slot, and retries if the writer started to overwrite that slot while it was copying.
+//
+// Usage, in the real-time process:
+//
+//     checkpointer.addController(c);          // for every controller, in a fixed order
+//     checkpointer.open("tue_control", 10);   // checkpoint every 10 ticks
+//     checkpointer.restore();                 // continue from the previous process (if any)
+//
+//     loop: update the controllers, then checkpointer.update()
+//
+// A standby process opens the same segment, and calls restore() when it takes over.
+
+class Checkpointer
+{
+
+public:
+
+    Checkpointer();
+
+    ~Checkpointer();
+
+    void addController(const std::shared_ptr<SupervisedController>& controller);
+
+    /// Opens (or creates) the shared memory segment '/name'. A checkpoint is written every 'interval'
+    /// calls of update().
+    bool open(const std::string& name, unsigned int interval);
+
+    void close();
+
+    bool is_open() const { return buffer_ != 0; }
+
+    /// Call every tick, after the controllers are updated
+    void update()
+    {
+        if (++ticks_ >= interval_)
+        {
+            ticks_ = 0;
+            write();
+        }
+    }
+
+    /// Writes a checkpoint of all controllers
+    void write();
+
+    /// Restores all controllers from the latest checkpoint. Returns false (see error_message()) if
+    /// there is no checkpoint, or it does not match the controllers; no controller is changed then.
+    bool restore();
+
+    /// Number of checkpoints written to the segment so far (e.g. for a standby to monitor the writer)
+    unsigned long sequence() const;
+
+    const std::string& error_message() const { return error_msg_; }
+
+private:
+
+    std::vector<std::shared_ptr<SupervisedController> > controllers_;
+
+    CheckpointBuffer* buffer_;
+
+    unsigned int interval_;
+
+    unsigned int ticks_;
+
+    std::string error_msg_;
+
+};
+
+} // end namespace control
+
+} // end namespace tue
+
+#endif
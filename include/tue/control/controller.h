@@ -26,7 +26,7 @@ public:
     /**
     Destructor that finalizes, i.e. resets parameters of the controller
     */
-    ~Controller();
+    virtual ~Controller();
 
     /// Controller configuration
     /**
@@ -45,6 +45,50 @@ public:
     */
     virtual void update(const ControllerInput& input, ControllerOutput& output) = 0;
 
+    /// Output limit feedback
+    /**
+    Called after update if the output was limited (saturation, slew rate), such that the controller
+    can prevent integrator windup. By default the limit is ignored.
+    @param requested output as computed by update
+    @param applied output that was actually applied
+    */
+    virtual void applyOutputLimit(double /*requested*/, double /*applied*/) {}
+
+    /// Controller reset
+    /**
+    Clears the internal state (filter states, integrators) in place, without reconfiguring
+    */
+    virtual void reset() {}
+
+    /// Bumpless controller reset
+    /**
+    Presets the internal state such that, for the given input at zero error, the controller
+    continues with the given output. The feedforward the controller adds for this input is part
+    of that output. By default the state is cleared.
+    @param initial_output output to continue with
+    @param input input of the first update after the reset
+    */
+    virtual void reset(double /*initial_output*/, const ControllerInput& /*input*/) { reset(); }
+
+    /// Internal state size
+    /**
+    Number of values of the internal state (filter states, integrators, models) that are written
+    by saveState and read by restoreState. Controllers without internal state return 0.
+    */
+    virtual unsigned int stateSize() const { return 0; }
+
+    /// Save the internal state (for checkpointing)
+    /**
+    @param state stateSize() values
+    */
+    virtual void saveState(double* /*state*/) const {}
+
+    /// Restore the internal state, as saved by a controller with the same configuration
+    /**
+    @param state stateSize() values
+    */
+    virtual void restoreState(const double* /*state*/) {}
+
     void setName(const std::string& name) { name_ = name; }
 
     const std::string& name() const { return name_; }
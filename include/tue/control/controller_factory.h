@@ -2,9 +2,12 @@
 #define TUE_CONTROL_CONTROLLER_FACTORY_H_
 
 #include <memory>
+#include <vector>
 
 #include <tue/config/configuration.h>
 
+#include "tue/control/supervised_controller.h"
+
 namespace tue
 {
 
@@ -12,7 +15,6 @@ namespace control
 {
 
 class Controller;
-class SupervisedController;
 
 // ----------------------------------------------------------------------------------------------------
 
@@ -27,6 +29,18 @@ std::shared_ptr<Controller> _createController() { return std::make_shared<T>();
 
 // ----------------------------------------------------------------------------------------------------
 
+/// Determines which registered types are stored inline in the SupervisedController
+template<typename T>
+struct InlineControllerTraits { static const InlineControllerType type = INLINE_NONE; };
+
+template<>
+struct InlineControllerTraits<GenericController> { static const InlineControllerType type = INLINE_GENERIC; };
+
+template<>
+struct InlineControllerTraits<SetpointController> { static const InlineControllerType type = INLINE_SETPOINT; };
+
+// ----------------------------------------------------------------------------------------------------
+
 class ControllerFactory
 {
 
@@ -38,12 +52,23 @@ public:
 
     std::shared_ptr<SupervisedController> createController(tue::Configuration& config, double dt) const;
 
+    /// Creates the controllers in array 'controllers' of the given configuration. Validation and
+    /// construction are distributed over 'num_threads' threads (0 = number of cores). The resulting
+    /// controllers are in configuration order; errors are added to 'config' per controller, in the
+    /// same order. Returns false if any of the controllers has an error.
+    bool createControllers(tue::Configuration& config, double dt, std::vector<std::shared_ptr<SupervisedController> >& controllers,
+                           unsigned int num_threads = 0) const;
+
     /// Register a new type of controller. The controller must derive from 'Controller'. Parameter
-    /// 'name' determines the name of the controller type.
+    /// 'name' determines the name of the controller type. GenericController and SetpointController
+    /// are stored inline in the SupervisedController (unless wrapped in delay compensation) and
+    /// updated without virtual dispatch; all other types are updated through the virtual interface.
     template<typename T>
     void registerControllerType(const std::string& name)
     {
-        controller_types_[name] = _createController<T>;
+        ControllerType& t = controller_types_[name];
+        t.create = _createController<T>;
+        t.inline_type = InlineControllerTraits<T>::type;
     }
 
 private:
@@ -51,8 +76,16 @@ private:
     /// Controller creator function pointer type definition
     typedef std::shared_ptr<Controller> (*t_controller_creator)();
 
-    /// Mapping from controller types to function pointers that create a controller of this type
-    std::map<std::string, t_controller_creator> controller_types_;
+    struct ControllerType
+    {
+        /// Function that creates a controller of this type
+        t_controller_creator create;
+
+        InlineControllerType inline_type;
+    };
+
+    /// Mapping from controller type names to controller types
+    std::map<std::string, ControllerType> controller_types_;
 
 };
 
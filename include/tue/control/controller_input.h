@@ -12,7 +12,9 @@ struct ControllerInput
 {
     ControllerInput()
         : pos_reference(INVALID_DOUBLE), vel_reference(INVALID_DOUBLE),
-          acc_reference(INVALID_DOUBLE), measurement(INVALID_DOUBLE) {}
+          acc_reference(INVALID_DOUBLE), measurement(INVALID_DOUBLE),
+          vel_estimate(INVALID_DOUBLE), disturbance_estimate(INVALID_DOUBLE),
+          scheduling_variable(INVALID_DOUBLE), dt(INVALID_DOUBLE) {}
 
     /// Position reference
     double pos_reference;
@@ -26,6 +28,19 @@ struct ControllerInput
     /// measurement
     double measurement;
 
+    /// (optional) estimated velocity, set if an observer is configured
+    double vel_estimate;
+
+    /// (optional) estimated lumped disturbance, in output units, set if an observer is configured
+    double disturbance_estimate;
+
+    /// (optional) external scheduling variable, used by gain-scheduled controllers
+    double scheduling_variable;
+
+    /// (optional) actual time elapsed since the previous update [s]. If not set, the nominal sample
+    /// time is assumed
+    double dt;
+
 };
 
 } // end namespace tue
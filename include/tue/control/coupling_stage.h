@@ -0,0 +1,92 @@
+#ifndef TUE_CONTROL_COUPLING_STAGE_H_
+#define TUE_CONTROL_COUPLING_STAGE_H_
+
+#include <memory>
+#include <vector>
+
+#include <tue/config/configuration.h>
+
+#include "tue/control/small_matrix.h"
+
+namespace tue
+{
+namespace control
+{
+
+class SupervisedController;
+
+// ----------------------------------------------------------------------------------------------------
+
+// MIMO stage around a group of supervised controllers. Motor space measurements are transformed to
+// joint space before the controllers are updated, and the joint space controller outputs are
+// transformed (decoupled) back to motor space:
+//
+//     joint_measurements = measurement_transform * motor_measurements
+//     motor_outputs      = output_transform * joint_outputs
+//
+// Example configuration:
+//
+//     coupling:
+//       - joint: wrist_pitch
+//         measurement: "0.5 0.5"
+//         output: "1 1"
+//       - joint: wrist_roll
+//         measurement: "0.5 -0.5"
+//         output: "1 -1"
+//
+// Row i of 'measurement' belongs to joint i, row i of 'output' to motor i. If 'output' is omitted,
+// the identity is used for that row.
+//
+// An invalid (INVALID_DOUBLE) motor measurement only invalidates the joints whose row has a nonzero
+// coefficient for that motor; the other joints keep being controlled.
+
+class CouplingStage
+{
+
+public:
+
+    CouplingStage();
+
+    ~CouplingStage();
+
+    /// Configures the stage. The joint names in the configuration are looked up in 'controllers'.
+    void configure(tue::Configuration& config, const std::vector<std::shared_ptr<SupervisedController> >& controllers);
+
+    /// Transforms the motor measurements, updates all controllers and writes the decoupled motor
+    /// outputs. Both arrays must have size() elements.
+    void update(const double* motor_measurements, double* motor_outputs);
+
+    unsigned int size() const { return size_; }
+
+    double jointMeasurement(unsigned int i) const { return joint_measurements_[i]; }
+
+    double jointOutput(unsigned int i) const { return joint_outputs_[i]; }
+
+    const std::shared_ptr<SupervisedController>& controller(unsigned int i) const { return controllers_[i]; }
+
+private:
+
+    unsigned int size_;
+
+    std::vector<std::shared_ptr<SupervisedController> > controllers_;
+
+    t_mat_vec mat_vec_;
+
+    double measurement_transform_[MAX_MATRIX_SIZE * MAX_MATRIX_SIZE];
+
+    double output_transform_[MAX_MATRIX_SIZE * MAX_MATRIX_SIZE];
+
+    double joint_measurements_[MAX_MATRIX_SIZE];
+
+    double joint_outputs_[MAX_MATRIX_SIZE];
+
+    // y = A x, row by row if some elements of x are invalid
+    void transform(const double* A, const double* x, double* y) const;
+
+};
+
+} // end namespace control
+
+} // end namespace tue
+
+#endif
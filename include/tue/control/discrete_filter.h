@@ -0,0 +1,234 @@
+#ifndef TUE_CONTROL_DISCRETE_FILTER_H_
+#define TUE_CONTROL_DISCRETE_FILTER_H_
+
+#include <tue/config/configuration.h>
+
+#include <cmath>
+
+namespace tue
+{
+namespace control
+{
+
+// ----------------------------------------------------------------------------------------------------
+
+/// Coefficients of a discrete second order section (a0 = 1):
+///
+///            b0 + b1 z^-1 + b2 z^-2
+///     H(z) = ----------------------
+///             1 + a1 z^-1 + a2 z^-2
+struct FilterCoefficients
+{
+    double b0, b1, b2, a1, a2;
+};
+
+/// Internal state of a second order section (transposed direct form II)
+struct FilterState
+{
+    FilterState() : z1(0), z2(0) {}
+
+    double z1, z2;
+};
+
+// ----------------------------------------------------------------------------------------------------
+
+/// Transposed direct form II update. Since the state does not depend on the coefficients directly,
+/// coefficients can be changed between updates without discontinuities in the state.
+inline double updateFilter(const FilterCoefficients& c, FilterState& s, double x)
+{
+    double y = c.b0 * x + s.z1;
+    s.z1 = c.b1 * x - c.a1 * y + s.z2;
+    s.z2 = c.b2 * x - c.a2 * y;
+    return y;
+}
+
+/// Sets the state (in place) to the steady state in which the section outputs y for a constant input,
+/// and returns that input. A section with an integrator holds y with zero input. A section with zero
+/// DC gain can only output 0 in steady state, so its state is cleared.
+inline double presetFilter(const FilterCoefficients& c, FilterState& s, double y)
+{
+    double num = c.b0 + c.b1 + c.b2;
+    double den = 1 + c.a1 + c.a2;
+
+    double x;
+    if (std::abs(den) < 1e-12 * (1 + std::abs(num)))
+        x = 0;
+    else if (num == 0)
+    {
+        s = FilterState();
+        return 0;
+    }
+    else
+        x = y * den / num;
+
+    s.z2 = c.b2 * x - c.a2 * y;
+    s.z1 = c.b1 * x - c.a1 * y + s.z2;
+    return x;
+}
+
+/// Conditional integration (anti-windup) for an integrating section: undoes its last update if that
+/// update drove the output further into the limit. 'before' is the state before the last update and
+/// 'excess' the requested minus the applied output. Assumes the stages after the section have a
+/// positive DC gain.
+inline void limitIntegration(const FilterState& before, FilterState& s, double excess)
+{
+    if ((s.z1 - before.z1) * excess > 0)
+        s = before;
+}
+
+/// out = (1 - f) * c1 + f * c2
+inline void interpolate(const FilterCoefficients& c1, const FilterCoefficients& c2, double f, FilterCoefficients& out)
+{
+    out.b0 = c1.b0 + f * (c2.b0 - c1.b0);
+    out.b1 = c1.b1 + f * (c2.b1 - c1.b1);
+    out.b2 = c1.b2 + f * (c2.b2 - c1.b2);
+    out.a1 = c1.a1 + f * (c2.a1 - c1.a1);
+    out.a2 = c1.a2 + f * (c2.a2 - c1.a2);
+}
+
+// ----------------------------------------------------------------------------------------------------
+// Discretization (Tustin) of the filters supported by GenericController
+
+/// Section that passes its input unchanged
+FilterCoefficients unityFilter();
+
+/// Tustin discretization of (n2 s^2 + n1 s + n0) / (d2 s^2 + d1 s + d0)
+FilterCoefficients discretize(double n2, double n1, double n0, double d2, double d1, double d0, double dt);
+
+/// (s + 2 pi fz) / s
+FilterCoefficients weakIntegrator(double fz, double dt);
+
+/// (s / (2 pi fz) + 1) / (s / (2 pi fp) + 1)
+FilterCoefficients leadLag(double fz, double fp, double dt);
+
+/// (s^2 / wz^2 + 2 dz s / wz + 1) / (s^2 / wp^2 + 2 dp s / wp + 1)
+FilterCoefficients skewedNotch(double fz, double dz, double fp, double dp, double dt);
+
+/// wp^2 / (s^2 + 2 dp wp s + wp^2)
+FilterCoefficients secondOrderLowPass(double fp, double dp, double dt);
+
+// ----------------------------------------------------------------------------------------------------
+
+/// Filter stages, in the order in which they are applied
+enum FilterStage
+{
+    WEAK_INTEGRATOR = 0,
+    LEAD_LAG = 1,
+    SKEWED_NOTCH = 2,
+    SECOND_ORDER_LOW_PASS = 3,
+    NUM_FILTER_STAGES = 4
+};
+
+/// Coefficients of a chain of filter stages. Stages that are not configured are unity filters, so
+/// two chains always have the same structure and can be interpolated.
+struct FilterChainCoefficients
+{
+    FilterCoefficients stage[NUM_FILTER_STAGES];
+};
+
+struct FilterChainState
+{
+    FilterState stage[NUM_FILTER_STAGES];
+};
+
+inline double updateFilterChain(const FilterChainCoefficients& c, FilterChainState& s, double x)
+{
+    for(unsigned int i = 0; i < NUM_FILTER_STAGES; ++i)
+        x = updateFilter(c.stage[i], s.stage[i], x);
+    return x;
+}
+
+/// Presets all stages such that the chain outputs y in steady state (see presetFilter), and returns
+/// the corresponding chain input
+inline double presetFilterChain(const FilterChainCoefficients& c, FilterChainState& s, double y)
+{
+    for(int i = NUM_FILTER_STAGES - 1; i >= 0; --i)
+        y = presetFilter(c.stage[i], s.stage[i], y);
+    return y;
+}
+
+static const unsigned int FILTER_CHAIN_STATE_SIZE = 2 * NUM_FILTER_STAGES;
+
+inline void saveFilterChainState(const FilterChainState& s, double* x)
+{
+    for(unsigned int i = 0; i < NUM_FILTER_STAGES; ++i)
+    {
+        x[2 * i] = s.stage[i].z1;
+        x[2 * i + 1] = s.stage[i].z2;
+    }
+}
+
+inline void restoreFilterChainState(const double* x, FilterChainState& s)
+{
+    for(unsigned int i = 0; i < NUM_FILTER_STAGES; ++i)
+    {
+        s.stage[i].z1 = x[2 * i];
+        s.stage[i].z2 = x[2 * i + 1];
+    }
+}
+
+/// Continuous-time parameters of a filter stage (fz, fp or fz, dz, fp, dp, depending on the stage)
+struct FilterStageParameters
+{
+    FilterStageParameters() : active(false) {}
+
+    bool active;
+
+    double p[4];
+};
+
+struct FilterChainParameters
+{
+    FilterStageParameters stage[NUM_FILTER_STAGES];
+};
+
+/// Reads the filter stages (weak_integrator, lead_lag, skewed_notch, second_order_low_pass) from
+/// the current group of the configuration
+void configureFilterChain(tue::Configuration& config, FilterChainParameters& p);
+
+/// Discretizes the filter stages for sample time dt. Stages that are not active become unity filters.
+void discretizeFilterChain(const FilterChainParameters& p, double dt, FilterChainCoefficients& c);
+
+/// Reads and discretizes the filter stages
+void configureFilterChain(tue::Configuration& config, double dt, FilterChainCoefficients& c);
+
+// ----------------------------------------------------------------------------------------------------
+
+/// Sample times dt_min + i * dt_step (i < size) for which filters are discretized in advance, such
+/// that the discretization closest to the actual elapsed time can be used every update:
+///
+///     dt_table:
+///       min: 0.0005
+///       max: 0.003
+///       size: 26
+struct SampleTimeTable
+{
+    SampleTimeTable() : dt_min(0), dt_step(0), size(0) {}
+
+    /// Reads the 'dt_table' group from the current group of the configuration. Leaves the table
+    /// empty (size 0) if there is none.
+    void configure(tue::Configuration& config);
+
+    double dt(unsigned int i) const { return dt_min + i * dt_step; }
+
+    /// Index of the sample time closest to dt (dt must be set, and the table not empty)
+    unsigned int index(double dt) const
+    {
+        int i = static_cast<int>((dt - dt_min) / dt_step + 0.5);
+        if (i < 0)
+            return 0;
+        if (i >= static_cast<int>(size))
+            return size - 1;
+        return i;
+    }
+
+    double dt_min;
+    double dt_step;
+    unsigned int size;
+};
+
+} // end namespace control
+
+} // end namespace tue
+
+#endif
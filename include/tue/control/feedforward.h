@@ -0,0 +1,45 @@
+#ifndef TUE_CONTROL_FEEDFORWARD_H_
+#define TUE_CONTROL_FEEDFORWARD_H_
+
+#include <tue/config/configuration.h>
+
+#include "tue/control/controller_input.h"
+
+namespace tue
+{
+namespace control
+{
+
+// Reference feedforward (gravity, static and dynamic friction, acceleration) and compensation of the
+// estimated disturbance.
+//
+//     feedforward:
+//       gravity: 0.07
+//       static: 0.05
+//       dynamic: 0.4
+//       acceleration: 0.3
+//       direction: -1       # optional, default 1
+//       disturbance: 1      # optional, gain on the estimated disturbance
+
+struct Feedforward
+{
+    Feedforward() : gravity(0), static_friction(0), dynamic_friction(0), acceleration(0), direction(0), disturbance(0) {}
+
+    /// Reads the feedforward parameters from the current group of the configuration
+    void configure(tue::Configuration& config);
+
+    double compute(const ControllerInput& input) const;
+
+    double gravity;
+    double static_friction;
+    double dynamic_friction;
+    double acceleration;
+    double direction;
+    double disturbance;
+};
+
+} // end namespace control
+
+} // end namespace tue
+
+#endif
@@ -0,0 +1,138 @@
+#ifndef TUE_CONTROL_GAIN_SCHEDULED_CONTROLLER_H_
+#define TUE_CONTROL_GAIN_SCHEDULED_CONTROLLER_H_
+
+#include "controller.h"
+#include "discrete_filter.h"
+#include "feedforward.h"
+
+#include <vector>
+
+namespace tue
+{
+
+namespace control
+{
+
+// Gain-scheduled variant of GenericController. The configuration defines a number of operating
+// points, each with its own gain and filters. The discretized coefficients of all operating points
+// are computed at configuration time; every update the coefficients are linearly interpolated
+// between the two operating points surrounding the scheduling variable. Filter states are shared by
+// all operating points, so they stay continuous when the operating point changes.
+//
+// Example configuration:
+//
+//     type: gain_scheduled
+//     scheduling_variable: position      # position, velocity or external
+//     operating_points:
+//       - value: 0
+//         gain: -80
+//         filters:
+//           lead_lag:
+//             fz: 1.6
+//             fp: 60
+//       - value: 0.3
+//         gain: -120
+//         filters:
+//           lead_lag:
+//             fz: 2
+//             fp: 60
+//     feedforward:
+//       ...
+//     dt_table:                          # optional, see GenericController
+//       ...
+//
+// Outside the range of the operating points, the nearest operating point is used.
+
+class GainScheduledController : public Controller
+{
+public:
+
+    static const unsigned int MAX_OPERATING_POINTS = 8;
+
+    enum SchedulingVariable
+    {
+        POSITION = 0,
+        VELOCITY = 1,
+        EXTERNAL = 2
+    };
+
+    /// Default constructor
+    /**
+    Constructor for the controller
+    */
+    GainScheduledController();
+
+    /// Destructor
+    /**
+    Destructor that finalizes, i.e. resets parameters of the controller
+    */
+    ~GainScheduledController();
+
+    /// Controller configuration
+    /**
+    Function used to configure the operating points, the scheduling variable and the feedforward
+    @param config The configuration of the controller
+    @param sample_time The sample time of the controller
+    */
+    void configure(tue::Configuration &config, double dt);
+
+    /// Controller update
+    /**
+    Function used for update of the current controller output,
+    depending on the given current input
+    @param measurement measurement provided by the sensor
+    @param reference provided by the user
+    */
+    void update(const ControllerInput& input, ControllerOutput& output);
+
+    void applyOutputLimit(double requested, double applied);
+
+    unsigned int stateSize() const;
+
+    void saveState(double* state) const;
+
+    void restoreState(const double* state);
+
+    void reset();
+
+    void reset(double initial_output, const ControllerInput& input);
+
+    unsigned int numOperatingPoints() const { return num_points_; }
+
+protected:
+
+    SchedulingVariable scheduling_variable_;
+
+    unsigned int num_points_;
+
+    // Operating points, sorted on value
+
+    double values_[MAX_OPERATING_POINTS];
+
+    double gains_[MAX_OPERATING_POINTS];
+
+    FilterChainCoefficients coefficients_[MAX_OPERATING_POINTS];
+
+    // Coefficients of all operating points for the sample times of dt_table_ (only if a 'dt_table'
+    // is configured): [k * num_points_ + i] for sample time k and operating point i
+    SampleTimeTable dt_table_;
+    std::vector<FilterChainCoefficients> table_;
+
+    // Interpolated coefficients (working copy) and filter states
+
+    FilterChainCoefficients current_;
+
+    FilterChainState state_;
+
+    // State of the weak integrator before the last update (for anti-windup)
+    FilterState integrator_before_;
+
+    Feedforward feedforward_;
+
+};
+
+}
+
+}
+
+#endif // TUE_CONTROL_GAIN_SCHEDULED_CONTROLLER_H_
@@ -13,6 +13,10 @@ static double INVALID_DOUBLE = std::numeric_limits<double>::quiet_NaN();
 
 inline bool is_set(double v) { return !std::isnan(v); }
 
+/// Cache line size assumed for data layout: state that is written by different threads is kept
+/// at least this far apart
+static const unsigned int CACHE_LINE_SIZE = 64;
+
 } // end namespace tue
 
 } // end namespace control
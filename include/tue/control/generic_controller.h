@@ -2,14 +2,12 @@
 #define GENERICCONTROLLER_H
 
 #include "controller.h"
+#include "feedforward.h"
+#include "adaptive_notch.h"
+#include "discrete_filter.h"
 
-#include <scl/filters/DFirstOrderLowpass.hpp>
-#include <scl/filters/DLeadLag.hpp>
-#include <scl/filters/DPD.hpp>
-#include <scl/filters/DPID.hpp>
-#include <scl/filters/DSecondOrderLowpass.hpp>
-#include <scl/filters/DSkewedNotch.hpp>
-#include <scl/filters/DWeakIntegrator.hpp>
+#include <memory>
+#include <vector>
 
 namespace tue
 {
@@ -20,27 +18,35 @@ namespace control
 /// Filters
 struct Filters
 {
-    Filters() : first_order_low_pass(0), lead_lag(0), PD(0), PID(0), second_order_low_pass(0), skewed_notch(0), weak_integrator(0) {}
-    ~Filters() { clear(); }
-
     void clear()
     {
-        delete first_order_low_pass;
-        delete lead_lag;
-        delete PD;
-        delete PID;
-        delete second_order_low_pass;
-        delete skewed_notch;
-        delete weak_integrator;
+        table.clear();
+        adaptive_notch.reset();
+    }
+
+    /// Returns the discretization for the given sample time (nominal if dt is not set)
+    const FilterChainCoefficients& coefficients(double dt) const
+    {
+        if (table.empty() || !is_set(dt))
+            return nominal;
+
+        return table[dt_table.index(dt)];
     }
 
-    DFILTERS::DFirstOrderLowpass* first_order_low_pass;
-    DFILTERS::DLeadLag* lead_lag;
-    DFILTERS::DPD* PD;
-    DFILTERS::DPID* PID;
-    DFILTERS::DSecondOrderLowpass* second_order_low_pass;
-    DFILTERS::DSkewedNotch* skewed_notch;
-    DFILTERS::DWeakIntegrator* weak_integrator;
+    /// Discretization for the nominal sample time
+    FilterChainCoefficients nominal;
+
+    /// Discretizations for the sample times of dt_table (only if a 'dt_table' is configured)
+    std::vector<FilterChainCoefficients> table;
+    SampleTimeTable dt_table;
+
+    FilterChainState state;
+
+    /// State of the weak integrator before the last update (for anti-windup)
+    FilterState integrator_before;
+
+    /// Only if an 'adaptive_notch' is configured
+    std::unique_ptr<AdaptiveNotch> adaptive_notch;
 };
 
 class GenericController : public Controller
@@ -62,7 +68,16 @@ public:
     /// Controller configuration
     /**
     Function used to configure the specific controller, it contains the set-up
-    of the feedforward and the selected filters
+    of the feedforward and the selected filters. The filters are discretized for the
+    nominal sample time, and optionally for a range of sample times:
+
+        dt_table:
+          min: 0.0005
+          max: 0.003
+          size: 26
+
+    in which case the discretization closest to the actual elapsed time (ControllerInput::dt)
+    is used every update. The adaptive notch always uses the nominal sample time.
     @param config The configuration of the controller
     @param sample_time The sample time of the controller
     */
@@ -77,17 +92,28 @@ public:
     */
     void update(const ControllerInput& input, ControllerOutput& output);
 
+    void applyOutputLimit(double requested, double applied);
+
+    unsigned int stateSize() const;
+
+    void saveState(double* state) const;
+
+    void restoreState(const double* state);
+
+    void reset();
+
+    void reset(double initial_output, const ControllerInput& input);
+
 protected:
 
     double gain_;
     Filters filters_;
 
+    // Velocity feedback on the estimated velocity (optional)
+    double damping_;
+
     // Feed forward
-    double ffw_gravity_;
-    double ffw_static_;
-    double ffw_dynamic_;
-    double ffw_acceleration_;
-    double ffw_direction_;
+    Feedforward feedforward_;
 
 };
 
@@ -0,0 +1,102 @@
+#ifndef TUE_CONTROL_HOMING_COORDINATOR_H_
+#define TUE_CONTROL_HOMING_COORDINATOR_H_
+
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace tue
+{
+namespace control
+{
+
+class SupervisedController;
+
+// ----------------------------------------------------------------------------------------------------
+
+// Homes a group of joints concurrently. A joint starts homing as soon as all joints in its
+// 'homing/preconditions' are homed, so independent joints home in parallel and the total homing time
+// is determined by the longest chain of dependent joints. The end stop of each joint is detected
+// with its 'homing/end_stop' configuration, after which stopHoming is called with the configured
+// end stop position.
+//
+// If a joint fails (error or timeout while homing), the joints that are still homing are set to
+// error as well, and the joints that did not start yet are left as they are.
+//
+// Usage: add the controllers, initialize(), start(), and call update() every tick after the
+// controllers have been updated, until done() or failed().
+
+class HomingCoordinator
+{
+
+public:
+
+    enum JointState
+    {
+        WAITING = 0,
+        IN_PROGRESS = 1,
+        HOMED = 2,
+        FAILED = 3
+    };
+
+    HomingCoordinator();
+
+    ~HomingCoordinator();
+
+    void addController(const std::shared_ptr<SupervisedController>& controller);
+
+    /// Resolves the preconditions. Returns false (see error_message()) if a precondition is unknown,
+    /// the preconditions are cyclic, or a homable joint has no end stop detection configured.
+    bool initialize(double dt);
+
+    void start();
+
+    /// Checks the end stops and starts joints of which the preconditions are met
+    void update();
+
+    /// Sets the measured effort (e.g. motor current) of joint i. If no effort is set, the absolute
+    /// controller output is used.
+    void setEffort(unsigned int i, double effort) { joints_[i].effort = effort; }
+
+    bool done() const { return num_homed_ == joints_.size(); }
+
+    bool failed() const { return failed_; }
+
+    unsigned int size() const { return joints_.size(); }
+
+    JointState state(unsigned int i) const { return joints_[i].state; }
+
+    const std::string& error_message() const { return error_msg_; }
+
+private:
+
+    struct Joint
+    {
+        std::shared_ptr<SupervisedController> controller;
+        std::vector<unsigned int> preconditions;
+        JointState state;
+        double effort;
+        unsigned int detections;
+        unsigned int ticks;
+        unsigned int max_ticks;
+    };
+
+    std::vector<Joint> joints_;
+
+    unsigned int num_homed_;
+
+    bool running_;
+
+    bool failed_;
+
+    std::string error_msg_;
+
+    void fail(Joint& joint, const std::string& msg);
+
+};
+
+} // end namespace control
+
+} // end namespace tue
+
+#endif
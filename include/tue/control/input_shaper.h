@@ -0,0 +1,119 @@
+#ifndef TUE_CONTROL_INPUT_SHAPER_H_
+#define TUE_CONTROL_INPUT_SHAPER_H_
+
+#include <tue/config/configuration.h>
+
+#include <vector>
+
+namespace tue
+{
+namespace control
+{
+
+enum InputShaperType
+{
+    SHAPER_ZV = 0,
+    SHAPER_ZVD = 1,
+    SHAPER_EI = 2
+};
+
+/// Impulse sequence of a shaper: amplitudes (summing to 1) at the given times [s]
+struct ShaperImpulses
+{
+    static const unsigned int MAX_IMPULSES = 3;
+
+    ShaperImpulses() : size(0) {}
+
+    unsigned int size;
+
+    double amplitude[MAX_IMPULSES];
+    double time[MAX_IMPULSES];
+};
+
+/// Computes the impulse sequence of a shaper for a mode with the given frequency [Hz] and relative
+/// damping. The tolerance (allowed residual vibration at the nominal frequency) is used by EI only.
+/// Returns false if the parameters are out of range.
+bool computeShaperImpulses(InputShaperType type, double frequency, double damping, double tolerance,
+                           ShaperImpulses& impulses);
+
+// ----------------------------------------------------------------------------------------------------
+
+// Input shaper: convolves a signal with an impulse sequence, such that a mode with the configured
+// frequency is not excited (ZV: 2 impulses, ZVD and EI: 3 impulses, increasingly robust against
+// errors in the frequency, at the cost of a longer delay of half, respectively one period).
+//
+// Impulse times that are not a multiple of the sample time are realized by linear interpolation
+// between samples. The delay line is allocated at configure time. A shaper can process several
+// channels at once (e.g. position, velocity and acceleration reference of one joint, or the
+// references of many joints); each channel can have its own impulse sequence.
+//
+// Example configuration:
+//
+//     input_shaping:
+//       type: zvd           # zv, zvd or ei
+//       frequency: 12.5     # mode frequency [Hz]
+//       damping: 0.02       # optional, relative damping of the mode
+//       tolerance: 0.05     # optional (ei only), residual vibration at the nominal frequency
+
+class InputShaper
+{
+
+public:
+
+    InputShaper();
+
+    ~InputShaper();
+
+    /// Reads the shaper from the current group of the configuration. All channels use the same
+    /// impulse sequence.
+    void configure(tue::Configuration& config, double dt, unsigned int num_channels);
+
+    /// One channel per impulse sequence (e.g. a mode frequency per joint)
+    void configure(const std::vector<ShaperImpulses>& impulses, double dt);
+
+    bool is_configured() const { return configured_; }
+
+    unsigned int num_channels() const { return num_channels_; }
+
+    /// Longest impulse time of all channels, i.e. the delay until a step is fully applied [s]
+    double duration() const { return duration_; }
+
+    /// Shapes one sample of every channel. 'in' and 'out' may be the same array.
+    void update(const double* in, double* out);
+
+    /// Fills the delay line with the given values (one per channel), such that the output continues
+    /// at these values without transient
+    void reset(const double* values);
+
+private:
+
+    bool configured_;
+
+    unsigned int num_channels_;
+
+    double duration_;
+
+    // Taps (two per impulse, for the interpolation): delay [samples] and weight, stored as
+    // [tap * num_channels + channel]
+
+    unsigned int num_taps_;
+
+    std::vector<unsigned int> tap_delay_;
+
+    std::vector<double> tap_weight_;
+
+    // Delay line (ring buffer), stored as [slot * num_channels + channel]
+
+    unsigned int size_;
+
+    unsigned int index_;
+
+    std::vector<double> history_;
+
+};
+
+} // end namespace control
+
+} // end namespace tue
+
+#endif
@@ -0,0 +1,141 @@
+#ifndef TUE_CONTROL_LOOP_STATISTICS_H_
+#define TUE_CONTROL_LOOP_STATISTICS_H_
+
+#include <tue/control/generic.h>
+
+#include <tue/config/configuration.h>
+
+namespace tue
+{
+namespace control
+{
+
+// ----------------------------------------------------------------------------------------------------
+
+/// Statistics over one (completed) window. Until the first window is complete, samples is 0 and
+/// the statistics are INVALID_DOUBLE.
+struct LoopStatisticsWindow
+{
+    LoopStatisticsWindow() : duration(0), samples(0), error_rms(INVALID_DOUBLE), error_peak(INVALID_DOUBLE),
+        output_rms(INVALID_DOUBLE), saturation_duty_cycle(INVALID_DOUBLE), oscillation_frequency(INVALID_DOUBLE),
+        oscillating(false) {}
+
+    /// Window length [s]
+    double duration;
+
+    /// Number of samples that contributed to the statistics (0 if no window was completed yet)
+    unsigned int samples;
+
+    double error_rms;
+
+    double error_peak;
+
+    double output_rms;
+
+    /// Fraction of samples in which the output was saturated [0, 1]
+    double saturation_duty_cycle;
+
+    /// Error oscillation frequency [Hz], estimated from the number of zero crossings
+    double oscillation_frequency;
+
+    bool oscillating;
+};
+
+// ----------------------------------------------------------------------------------------------------
+
+static const unsigned int MAX_STATISTICS_WINDOWS = 4;
+
+struct LoopStatisticsSnapshot
+{
+    LoopStatisticsSnapshot() : num_windows(0) {}
+
+    unsigned int num_windows;
+
+    LoopStatisticsWindow windows[MAX_STATISTICS_WINDOWS];
+};
+
+// ----------------------------------------------------------------------------------------------------
+
+// Incremental loop-health statistics. Each window is a tumbling window: samples are accumulated in
+// a fixed-size accumulator, and when the window is full the statistics are computed and the
+// accumulator is cleared. Updating costs O(1) per window and no sample buffers are kept.
+//
+// Example configuration:
+//
+//     statistics:
+//       windows:
+//         - duration: 0.1
+//         - duration: 10
+//       oscillation:
+//         deadband: 0.001     # error hysteresis used for zero crossing detection
+//         frequency: 5        # minimum crossing frequency [Hz] to flag oscillation
+//         error_rms: 0.002    # minimum error rms to flag oscillation
+
+class LoopStatistics
+{
+
+public:
+
+    LoopStatistics();
+
+    ~LoopStatistics();
+
+    void configure(tue::Configuration& config, double dt);
+
+    /// Adds one sample. Should be called once per tick in which the controller is active.
+    void update(double error, double output, bool saturated);
+
+    /// Clears all accumulators and completed windows
+    void reset();
+
+    /// Discards the windows in progress, such that no window mixes samples from before and after an
+    /// interruption. The completed windows are kept.
+    void restart();
+
+    unsigned int numWindows() const { return num_windows_; }
+
+    /// Returns the statistics of the last completed window i
+    const LoopStatisticsWindow& window(unsigned int i) const { return completed_[i]; }
+
+    void getSnapshot(LoopStatisticsSnapshot& snapshot) const;
+
+private:
+
+    struct Accumulator
+    {
+        unsigned int size;
+        unsigned int n;
+        unsigned int n_saturated;
+        unsigned int n_crossings;
+        double sum_error_sq;
+        double sum_output_sq;
+        double error_peak;
+    };
+
+    double dt_;
+
+    unsigned int num_windows_;
+
+    Accumulator acc_[MAX_STATISTICS_WINDOWS];
+
+    LoopStatisticsWindow completed_[MAX_STATISTICS_WINDOWS];
+
+    // Zero crossing detection
+
+    int error_sign_;
+
+    double deadband_;
+
+    double oscillation_frequency_;
+
+    double oscillation_error_rms_;
+
+    void clear(Accumulator& acc);
+
+};
+
+} // end namespace control
+
+} // end namespace tue
+
+#endif
@@ -0,0 +1,113 @@
+#ifndef TUE_CONTROL_MEASUREMENT_FILTER_H_
+#define TUE_CONTROL_MEASUREMENT_FILTER_H_
+
+#include <tue/config/configuration.h>
+
+#include "tue/control/generic.h"
+
+namespace tue
+{
+namespace control
+{
+
+// Pre-processing stage for raw measurements. Rejects spikes (samples that deviate too much from
+// the predicted value), limits the rate of change, and bridges missing (NaN) or rejected samples by
+// extrapolating with a constant velocity model. The number of consecutively bridged samples
+// (missing and rejected alike) is limited; once this budget is exceeded the filter reports a failure.
+//
+// Example configuration:
+//
+//     measurement:
+//       max_jump: 0.05        # reject samples that deviate more than this from the prediction
+//       max_velocity: 2.0     # rate limit [unit/s]
+//       max_dropouts: 5       # maximum number of consecutive extrapolated samples
+//       velocity_filter: 0.2  # velocity estimate smoothing factor (0, 1], 1 = no smoothing
+
+class MeasurementFilter
+{
+
+public:
+
+    MeasurementFilter();
+
+    ~MeasurementFilter();
+
+    void configure(tue::Configuration& config, double dt);
+
+    /// Processes a raw measurement and returns the filtered measurement. Returns INVALID_DOUBLE if
+    /// no valid measurement can be given (no measurement received yet, or budget exceeded). 'dt' is
+    /// the time elapsed since the previous sample (the nominal sample time if not set).
+    double update(double raw_measurement, double dt = INVALID_DOUBLE);
+
+    /// Forgets the measurement history (the next valid sample is accepted as is)
+    void reset();
+
+    /// True if the last update exceeded the dropout budget. The history is then forgotten, so the
+    /// next valid sample is accepted as is.
+    bool failed() const { return failed_; }
+
+    bool is_configured() const { return configured_; }
+
+    /// Total number of missing (NaN) samples
+    unsigned long num_dropouts() const { return num_dropouts_; }
+
+    /// Total number of rejected spikes
+    unsigned long num_rejected() const { return num_rejected_; }
+
+    /// Total number of rate limited samples
+    unsigned long num_rate_limited() const { return num_rate_limited_; }
+
+    /// Number of consecutive samples that have been extrapolated
+    unsigned int consecutive_dropouts() const { return consecutive_dropouts_; }
+
+    /// Filtered position (INVALID_DOUBLE if there is no history) and velocity
+    double position() const { return position_; }
+
+    double velocity() const { return velocity_; }
+
+    /// Sets the history (e.g. restored from a checkpoint)
+    void setState(double position, double velocity, unsigned int consecutive_dropouts)
+    {
+        position_ = position;
+        velocity_ = velocity;
+        consecutive_dropouts_ = consecutive_dropouts;
+        failed_ = false;
+    }
+
+private:
+
+    bool configured_;
+
+    double dt_;
+
+    double max_jump_;
+
+    double max_velocity_;
+
+    unsigned int max_dropouts_;
+
+    double velocity_filter_;
+
+    // State
+
+    double position_;
+
+    double velocity_;
+
+    bool failed_;
+
+    unsigned int consecutive_dropouts_;
+
+    unsigned long num_dropouts_;
+
+    unsigned long num_rejected_;
+
+    unsigned long num_rate_limited_;
+
+};
+
+} // end namespace control
+
+} // end namespace tue
+
+#endif
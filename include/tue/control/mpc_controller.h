@@ -0,0 +1,165 @@
+#ifndef TUE_CONTROL_MPC_CONTROLLER_H_
+#define TUE_CONTROL_MPC_CONTROLLER_H_
+
+#include "controller.h"
+
+namespace tue
+{
+
+namespace control
+{
+
+// Model predictive controller for a linear single-input plant
+//
+//     x[k+1] = A x[k] + B (u[k] + d)
+//     y[k]   = C x[k]
+//
+// with y the measured position and d an (estimated) constant input disturbance, which makes the
+// tracking offset-free. Every update the controller minimizes
+//
+//     sum_{k=1..N} position * (y[k] - r[k])^2 + sum_{k=0..N-1} input * u[k]^2 + input_rate * (u[k] - u[k-1])^2
+//
+// subject to |u[k]| <= input_limit, over the horizon N. The reference r is extrapolated from the
+// position, velocity and acceleration reference.
+//
+// All matrices of the condensed problem (the QP in u[0..N-1] only) are computed at configuration
+// time. At runtime the state and disturbance are estimated with a steady-state Kalman filter, and the
+// box-constrained QP is solved with a fixed number of accelerated projected gradient iterations,
+// warm-started with the shifted solution of the previous update. The runtime cost is therefore
+// constant: about iterations * N^2 multiply-adds, without allocations.
+//
+// Example configuration:
+//
+//     type: mpc
+//     model:                          # state dimension n <= MAX_STATES
+//       A: "1 0.001; 0 1"             # rows separated by ';'
+//       B: "0.0000005 0.001"          # column, written as a row
+//       C: "1 0"
+//     horizon: 20                     # N <= MAX_HORIZON
+//     weights:
+//       position: 1e8
+//       input: 1
+//       input_rate: 0                 # optional
+//     input_limit: 10                 # optional
+//     iterations: 20                  # optional
+//     estimator:                      # optional noise variances of the Kalman filter
+//       process_noise: 1e-8
+//       disturbance_noise: 1e-2
+//       measurement_noise: 1e-10
+
+class MPCController : public Controller
+{
+public:
+
+    static const unsigned int MAX_STATES = 4;
+
+    static const unsigned int MAX_HORIZON = 20;
+
+    /// Default constructor
+    /**
+    Constructor for the controller
+    */
+    MPCController();
+
+    /// Destructor
+    /**
+    Destructor that finalizes, i.e. resets parameters of the controller
+    */
+    ~MPCController();
+
+    /// Controller configuration
+    /**
+    Function used to configure the model, horizon, weights and constraints, and to precompute
+    the condensed problem and the estimator gains
+    @param config The configuration of the controller
+    @param sample_time The sample time of the controller
+    */
+    void configure(tue::Configuration &config, double dt);
+
+    /// Controller update
+    /**
+    Estimates the state, solves the QP and applies the first input of the solution
+    @param input measurement and reference
+    @param output first input of the optimal input sequence
+    */
+    void update(const ControllerInput& input, ControllerOutput& output);
+
+    void applyOutputLimit(double requested, double applied);
+
+    unsigned int stateSize() const;
+
+    void saveState(double* state) const;
+
+    void restoreState(const double* state);
+
+    void reset();
+
+    void reset(double initial_output, const ControllerInput& input);
+
+    /// Longest time spent in update [s]
+    double max_solve_time() const { return max_solve_time_; }
+
+    /// Multiply-adds per update (fixed, so it bounds the solve time)
+    unsigned int operations() const;
+
+protected:
+
+    double dt_;
+
+    unsigned int n_;
+
+    unsigned int horizon_;
+
+    unsigned int iterations_;
+
+    double input_limit_;
+
+    // Augmented model (state, disturbance): dimension n + 1
+
+    double A_[MAX_STATES + 1][MAX_STATES + 1];
+
+    double B_[MAX_STATES + 1];
+
+    double C_[MAX_STATES + 1];
+
+    // Estimator gain
+
+    double L_[MAX_STATES + 1];
+
+    // Condensed problem: gradient = H u + F x + G r + h * u_prev
+
+    double H_[MAX_HORIZON][MAX_HORIZON];
+
+    double F_[MAX_HORIZON][MAX_STATES + 1];
+
+    double G_[MAX_HORIZON][MAX_HORIZON];
+
+    double h_[MAX_HORIZON];
+
+    // 1 / (largest eigenvalue of H), the gradient step size
+
+    double step_;
+
+    // Runtime state
+
+    double x_[MAX_STATES + 1];
+
+    double u_[MAX_HORIZON];
+
+    double u_prev_;
+
+    bool initialized_;
+
+    // Output to start from after a reset
+
+    double preset_output_;
+
+    double max_solve_time_;
+
+};
+
+}
+
+}
+
+#endif // TUE_CONTROL_MPC_CONTROLLER_H_
@@ -0,0 +1,139 @@
+#ifndef TUE_CONTROL_PLANT_MODEL_H_
+#define TUE_CONTROL_PLANT_MODEL_H_
+
+#include <tue/config/configuration.h>
+
+#include <vector>
+
+namespace tue
+{
+namespace control
+{
+
+enum PlantType
+{
+    PLANT_MASS = 0,
+    PLANT_MASS_SPRING_DAMPER = 1,
+    PLANT_TWO_MASS = 2
+};
+
+struct PlantParameters
+{
+    PlantParameters() : type(PLANT_MASS), mass(1), stiffness(0), damping(0), load_mass(1), measure_load(false),
+        coulomb(0), viscous(0), backlash(0), delay(0), resolution(0) {}
+
+    PlantType type;
+
+    /// (Motor) mass [kg]
+    double mass;
+
+    /// Spring and damper to the fixed world (mass_spring_damper), or between motor and load (two_mass)
+    double stiffness;
+    double damping;
+
+    /// Load mass (two_mass)
+    double load_mass;
+
+    /// Measure the load instead of the motor (two_mass)
+    bool measure_load;
+
+    /// Friction on the (motor) mass
+    double coulomb;
+    double viscous;
+
+    /// Total play between motor and load (two_mass), or between the mass and the sensor
+    double backlash;
+
+    /// Measurement transport delay [samples]
+    unsigned int delay;
+
+    /// Encoder resolution (0: not quantized)
+    double resolution;
+};
+
+// ----------------------------------------------------------------------------------------------------
+
+// Simulated plant of a single joint, driven by a force and measured by a position sensor. The
+// dynamics are integrated with semi-implicit Euler (velocity first) once per update. Example
+// configuration:
+//
+//     plant:
+//       type: two_mass        # mass, mass_spring_damper or two_mass
+//       mass: 2.0             # (motor) mass
+//       load_mass: 0.5        # two_mass only
+//       stiffness: 4000       # spring to the world (mass_spring_damper), or motor-load coupling (two_mass)
+//       damping: 2
+//       sensor: load          # motor (default) or load, two_mass only
+//       friction:
+//         coulomb: 0.5        # includes stiction: the mass sticks while the other forces are smaller
+//         viscous: 0.1
+//       backlash: 0.001       # total play
+//       delay: 2              # measurement transport delay [samples]
+//       resolution: 1e-5      # encoder resolution
+
+class PlantModel
+{
+
+public:
+
+    PlantModel();
+
+    PlantModel(const PlantParameters& params);
+
+    ~PlantModel();
+
+    void configure(tue::Configuration& config);
+
+    void setParameters(const PlantParameters& params);
+
+    const PlantParameters& parameters() const { return params_; }
+
+    /// Puts the plant at rest at the given position
+    void reset(double position);
+
+    /// Applies force 'f' during 'dt' seconds
+    void update(double f, double dt);
+
+    /// Measured position: delayed, quantized, and behind the backlash (if configured)
+    double measurement() const { return history_[(index_ + 1) % history_.size()]; }
+
+    /// True position of the measured mass
+    double position() const { return params_.measure_load ? load_pos_ : pos_; }
+
+    double velocity() const { return params_.measure_load ? load_vel_ : vel_; }
+
+    double motor_position() const { return pos_; }
+
+    double load_position() const { return load_pos_; }
+
+private:
+
+    PlantParameters params_;
+
+    // (Motor) mass
+    double pos_;
+    double vel_;
+
+    // Load mass (two_mass)
+    double load_pos_;
+    double load_vel_;
+
+    // Sensor side of the backlash (single mass)
+    double sensor_pos_;
+
+    // Measurements of the last 'delay' + 1 updates
+    std::vector<double> history_;
+    unsigned int index_;
+
+    // Returns the velocity after 'dt', given force 'f' (excluding friction) on mass 'm'
+    double integrateVelocity(double v, double f, double m, double dt) const;
+
+    double sense() const;
+
+};
+
+} // end namespace control
+
+} // end namespace tue
+
+#endif
@@ -0,0 +1,121 @@
+#ifndef TUE_CONTROL_PLANT_SERVER_H_
+#define TUE_CONTROL_PLANT_SERVER_H_
+
+#include <tue/control/plant_model.h>
+#include <tue/control/process_image.h>
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace tue
+{
+namespace control
+{
+
+/// Timing of the bus cycles and of the responses of the controller side
+struct PlantServerStatistics
+{
+    PlantServerStatistics() : cycles(0), missed(0), responses(0), response_time_mean(0), response_time_max(0),
+        wakeup_latency_max(0) {}
+
+    unsigned long cycles;
+
+    /// Cycles in which no new outputs were available (the previous outputs were applied again)
+    unsigned long missed;
+
+    unsigned long responses;
+
+    /// Time from writing the inputs to writing the outputs that respond to them [s]
+    double response_time_mean;
+    double response_time_max;
+
+    /// Delay of the start of a bus cycle with respect to its schedule [s]
+    double wakeup_latency_max;
+};
+
+// ----------------------------------------------------------------------------------------------------
+
+// Simulates the robot hardware behind a ProcessImage: at a fixed period, applies the latest outputs
+// of the controller side to the plant models, steps them, and writes their measurements as the
+// inputs of the next cycle. Like real drives, it holds the previous outputs when the controller side
+// did not answer in time. Measures the response time of the controller side and the timing of its
+// own cycles, so a controller set can be tested and benchmarked in real time without hardware.
+//
+// Usage:
+//
+//     server.addPlant(plant);                       // one per joint, in the order of the process image
+//     server.open("tue_control_sim");
+//     server.start(0.001);                          // or call cycle() from an own loop
+//     ... run the controller side ...
+//     server.stop();
+
+class PlantServer
+{
+
+public:
+
+    PlantServer();
+
+    ~PlantServer();
+
+    void addPlant(const std::shared_ptr<PlantModel>& plant);
+
+    /// Creates the process image '/name', and writes the initial measurements
+    bool open(const std::string& name);
+
+    void close();
+
+    /// Starts the bus thread. If priority > 0, the thread is given that SCHED_FIFO priority. Returns
+    /// false if the priority could not be set (the thread runs nevertheless).
+    bool start(double period, int priority = 0);
+
+    void stop();
+
+    /// Runs a single bus cycle of 'dt' seconds (called by the bus thread)
+    void cycle(double dt);
+
+    /// Number of completed cycles. Can be called from any thread.
+    unsigned long cycles() const { return cycles_.load(std::memory_order_acquire); }
+
+    /// Bus thread only, or after stop()
+    const PlantServerStatistics& statistics() const { return statistics_; }
+
+    const std::string& error_message() const { return image_.error_message(); }
+
+private:
+
+    std::vector<std::shared_ptr<PlantModel> > plants_;
+
+    ProcessImage image_;
+
+    // Latest applied outputs, and the input cycle they respond to
+    ProcessData outputs_;
+
+    double measurements_[MAX_PROCESS_IMAGE_JOINTS];
+
+    // Write times of the last inputs, indexed by cycle
+    static const unsigned int HISTORY_SIZE = 64;
+    double input_times_[HISTORY_SIZE];
+
+    std::atomic<unsigned long> cycles_;
+
+    PlantServerStatistics statistics_;
+
+    std::thread thread_;
+
+    std::atomic<bool> running_;
+
+    void run(double period);
+
+    void writeInputs();
+
+};
+
+} // end namespace control
+
+} // end namespace tue
+
+#endif
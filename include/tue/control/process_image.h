@@ -0,0 +1,126 @@
+#ifndef TUE_CONTROL_PROCESS_IMAGE_H_
+#define TUE_CONTROL_PROCESS_IMAGE_H_
+
+#include <tue/control/generic.h>
+
+#include <atomic>
+#include <string>
+
+namespace tue
+{
+namespace control
+{
+
+static const unsigned int MAX_PROCESS_IMAGE_JOINTS = 64;
+
+/// Data of one direction of the process image
+struct ProcessData
+{
+    /// Bus cycle: for inputs the cycle in which they were sampled, for outputs the input cycle they
+    /// respond to
+    unsigned long cycle;
+
+    /// Time at which the data was written [s] (see ProcessImage::now())
+    double timestamp;
+
+    double values[MAX_PROCESS_IMAGE_JOINTS];
+};
+
+/// Layout of the shared memory segment. Each direction has a single writer and is protected by its
+/// own sequence lock (odd while written, 0 if nothing was written yet).
+struct ProcessImageBuffer
+{
+    unsigned int num_joints;
+
+    // Plant to controllers (measurements)
+    alignas(CACHE_LINE_SIZE) std::atomic<unsigned long> input_sequence;
+    ProcessData inputs;
+
+    // Controllers to plant (actuator outputs)
+    alignas(CACHE_LINE_SIZE) std::atomic<unsigned long> output_sequence;
+    ProcessData outputs;
+};
+
+// ----------------------------------------------------------------------------------------------------
+
+// Stand-in for the process image of a fieldbus (e.g. EtherCAT), in shared memory, such that a
+// controller process can be tested against a simulated plant (see PlantServer) in another process
+// or thread exactly as it would run against the drives: every bus cycle the plant side writes the
+// measurements, and the controller side answers with the outputs. Neither side ever waits for the
+// other; a side that reads while the other is writing retries.
+//
+// Usage, on the controller side:
+//
+//     image.open("tue_control_sim");
+//
+//     loop: image.waitForInputs(inputs.cycle, inputs, timeout)
+//           update the controllers with inputs.values
+//           image.writeOutputs(inputs.cycle, outputs)
+
+class ProcessImage
+{
+
+public:
+
+    ProcessImage();
+
+    ~ProcessImage();
+
+    /// Creates (or clears) the shared memory segment '/name' for the given number of joints (plant side)
+    bool create(const std::string& name, unsigned int num_joints);
+
+    /// Opens an existing segment (controller side)
+    bool open(const std::string& name);
+
+    void close();
+
+    /// Removes the name of the segment; existing mappings stay valid until closed
+    void unlink();
+
+    bool is_open() const { return buffer_ != 0; }
+
+    unsigned int num_joints() const { return buffer_ ? buffer_->num_joints : 0; }
+
+    // Plant side
+
+    void writeInputs(unsigned long cycle, const double* measurements);
+
+    /// Returns false if no outputs were written yet, or no consistent copy could be made
+    bool readOutputs(ProcessData& outputs) const;
+
+    // Controller side
+
+    /// Returns false if no inputs were written yet, or no consistent copy could be made
+    bool readInputs(ProcessData& inputs) const;
+
+    /// Polls until inputs of a cycle after 'last_cycle' are available. Returns false after 'timeout' [s].
+    bool waitForInputs(unsigned long last_cycle, ProcessData& inputs, double timeout) const;
+
+    void writeOutputs(unsigned long cycle, const double* outputs);
+
+    /// Time [s] on the clock used for the timestamps (monotonic, shared by all processes)
+    static double now();
+
+    const std::string& error_message() const { return error_msg_; }
+
+private:
+
+    ProcessImageBuffer* buffer_;
+
+    std::string name_;
+
+    std::string error_msg_;
+
+    bool map(const std::string& name, bool create);
+
+    void write(std::atomic<unsigned long>& sequence, ProcessData& data, unsigned long cycle, const double* values);
+
+    bool read(const std::atomic<unsigned long>& sequence, const ProcessData& data, ProcessData& copy) const;
+
+};
+
+} // end namespace control
+
+} // end namespace tue
+
+#endif
@@ -0,0 +1,70 @@
+#ifndef TUE_CONTROL_SMALL_MATRIX_H_
+#define TUE_CONTROL_SMALL_MATRIX_H_
+
+#include <sstream>
+#include <string>
+
+namespace tue
+{
+namespace control
+{
+
+// Maximum dimension of the fixed-size matrix kernels
+static const unsigned int MAX_MATRIX_SIZE = 16;
+
+// ----------------------------------------------------------------------------------------------------
+
+// y = A * x, with A a row-major N x N matrix. Since N is known at compile time, the compiler can
+// fully unroll and vectorize the inner loop.
+template<unsigned int N>
+inline void matVec(const double* A, const double* x, double* y)
+{
+    for(unsigned int i = 0; i < N; ++i)
+    {
+        const double* row = A + i * N;
+        double sum = 0;
+        for(unsigned int j = 0; j < N; ++j)
+            sum += row[j] * x[j];
+        y[i] = sum;
+    }
+}
+
+// ----------------------------------------------------------------------------------------------------
+
+/// Matrix-vector kernel function pointer type definition
+typedef void (*t_mat_vec)(const double* A, const double* x, double* y);
+
+/// Returns the fixed-size kernel for dimension n (1 <= n <= MAX_MATRIX_SIZE), or 0 if n is out of range
+inline t_mat_vec matVecKernel(unsigned int n)
+{
+    static const t_mat_vec KERNELS[] = { 0,
+        matVec<1>,  matVec<2>,  matVec<3>,  matVec<4>,  matVec<5>,  matVec<6>,  matVec<7>,  matVec<8>,
+        matVec<9>,  matVec<10>, matVec<11>, matVec<12>, matVec<13>, matVec<14>, matVec<15>, matVec<16> };
+
+    if (n > MAX_MATRIX_SIZE)
+        return 0;
+
+    return KERNELS[n];
+}
+
+// ----------------------------------------------------------------------------------------------------
+
+// Parses a whitespace separated matrix row of exactly n values into 'row'
+inline bool parseRow(const std::string& str, unsigned int n, double* row)
+{
+    std::istringstream ss(str);
+    for(unsigned int j = 0; j < n; ++j)
+    {
+        if (!(ss >> row[j]))
+            return false;
+    }
+
+    double dummy;
+    return !(ss >> dummy);
+}
+
+} // end namespace control
+
+} // end namespace tue
+
+#endif
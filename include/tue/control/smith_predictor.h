@@ -0,0 +1,119 @@
+#ifndef TUE_CONTROL_SMITH_PREDICTOR_H_
+#define TUE_CONTROL_SMITH_PREDICTOR_H_
+
+#include "tue/control/controller.h"
+
+#include <memory>
+
+namespace tue
+{
+
+namespace control
+{
+
+// Transport-delay compensating wrapper (Smith predictor). An internal plant model (mass-damper) is
+// driven with the controller output. The wrapped controller gets the delayed measurement corrected
+// with the difference between the current and the delayed model position:
+//
+//     y_predicted(k) = y_measured(k) + y_model(k) - y_model(k - delay)
+//
+// The factory wraps a controller in a SmithPredictor if its configuration contains:
+//
+//     delay_compensation:
+//       delay: 3            # measurement delay [samples], at most MAX_DELAY
+//       model:
+//         mass: 1
+//         damping: 0        # optional
+
+class SmithPredictor : public Controller
+{
+public:
+
+    static const unsigned int MAX_DELAY = 32;
+
+    /// Default constructor
+    /**
+    Constructor for the controller
+    */
+    SmithPredictor();
+
+    /// Destructor
+    /**
+    Destructor that finalizes, i.e. resets parameters of the controller
+    */
+    ~SmithPredictor();
+
+    /// Sets the wrapped controller. Must be called before configure.
+    void setController(const std::shared_ptr<Controller>& controller) { controller_ = controller; }
+
+    /// Controller configuration
+    /**
+    Function used to configure the delay and the internal plant model
+    @param config The configuration of the delay compensation
+    @param sample_time The sample time of the controller
+    */
+    void configure(tue::Configuration &config, double dt);
+
+    /// Controller update
+    /**
+    Predicts the undelayed measurement and updates the wrapped controller with it
+    @param input measurement (delayed) and reference
+    @param output output of the wrapped controller
+    */
+    void update(const ControllerInput& input, ControllerOutput& output);
+
+    void applyOutputLimit(double requested, double applied);
+
+    unsigned int stateSize() const;
+
+    void saveState(double* state) const;
+
+    void restoreState(const double* state);
+
+    void reset();
+
+    void reset(double initial_output, const ControllerInput& input);
+
+    unsigned int delay() const { return delay_; }
+
+private:
+
+    std::shared_ptr<Controller> controller_;
+
+    double dt_;
+
+    unsigned int delay_;
+
+    // Plant model
+
+    double mass_;
+
+    double damping_;
+
+    double model_pos_;
+
+    double model_vel_;
+
+    // Model state before, and sample time of, the last update (to redo it with the limited output)
+
+    double model_pos_before_;
+
+    double model_vel_before_;
+
+    double model_dt_;
+
+    void updateModel(double u);
+
+    // History of model positions (ring buffer)
+
+    double history_[MAX_DELAY];
+
+    unsigned int history_index_;
+
+};
+
+}
+
+}
+
+#endif // TUE_CONTROL_SMITH_PREDICTOR_H_
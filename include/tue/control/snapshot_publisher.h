@@ -0,0 +1,113 @@
+#ifndef TUE_CONTROL_SNAPSHOT_PUBLISHER_H_
+#define TUE_CONTROL_SNAPSHOT_PUBLISHER_H_
+
+#include "tue/control/supervised_controller.h"
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+namespace tue
+{
+namespace control
+{
+
+/// State of a joint at the end of a tick
+struct JointSnapshot
+{
+    ControllerStatus status;
+    bool homed;
+
+    double measurement;
+
+    double pos_reference;
+    double vel_reference;
+    double acc_reference;
+
+    double output;
+    double error;
+
+    // Applied minus requested output (see SupervisedController::output_clamp)
+    double output_clamp;
+};
+
+// ----------------------------------------------------------------------------------------------------
+
+// Publishes the state of a set of controllers once per tick, such that readers in other threads
+// (GUI, diagnostics, ROS publishers) get a consistent copy of all joints for the same tick, instead
+// of mixing values of different ticks by calling the getters one at a time.
+//
+// The snapshots are stored in a ring of slots, each protected by a sequence lock. The writer (the
+// real-time loop) fills the oldest slot and never waits. Readers copy the latest slot and check its
+// sequence afterwards; they do not write any shared state (not even a retry counter: read() returns
+// the retries of the call), so any number of readers can read concurrently without slowing down the
+// writer or each other. A read is only retried if the writer has gone around the complete ring while
+// the reader was copying.
+//
+// Usage:
+//
+//     publisher.addController(c);      // for every controller, in a fixed order
+//     publisher.initialize();
+//
+//     real-time loop: update the controllers, then publisher.publish()
+//
+//     any other thread: publisher.read(joints, tick)
+
+class SnapshotPublisher
+{
+
+public:
+
+    SnapshotPublisher();
+
+    ~SnapshotPublisher();
+
+    void addController(const std::shared_ptr<SupervisedController>& controller);
+
+    /// Allocates the ring of snapshots (at least 2 slots)
+    void initialize(unsigned int num_slots = 4);
+
+    /// Publishes the current state of all controllers (real-time thread only)
+    void publish();
+
+    /// Copies the latest snapshot of all joints (in the order in which they were added), and sets
+    /// 'tick' to the number of the tick it was published in. Returns false if nothing was
+    /// published yet. Can be called from any thread.
+    bool read(std::vector<JointSnapshot>& joints, unsigned long& tick) const
+    {
+        unsigned int retries;
+        return read(joints, tick, retries);
+    }
+
+    /// Same, and sets 'retries' to the number of times the copy had to be retried because the
+    /// writer overwrote the slot during the copy (per reader, so readers can keep their own count)
+    bool read(std::vector<JointSnapshot>& joints, unsigned long& tick, unsigned int& retries) const;
+
+    /// Number of published snapshots
+    unsigned long ticks() const { return published_.load(std::memory_order_acquire); }
+
+    unsigned int size() const { return controllers_.size(); }
+
+private:
+
+    std::vector<std::shared_ptr<SupervisedController> > controllers_;
+
+    unsigned int num_slots_;
+
+    // Sequence lock per slot (odd while the slot is written)
+    std::vector<std::atomic<unsigned long> > sequences_;
+
+    // Tick per slot, and the joint snapshots as [slot * number of joints + joint]
+    std::vector<unsigned long> slot_ticks_;
+
+    std::vector<JointSnapshot> slots_;
+
+    std::atomic<unsigned long> published_;
+
+};
+
+} // end namespace control
+
+} // end namespace tue
+
+#endif
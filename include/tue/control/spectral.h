@@ -0,0 +1,52 @@
+#ifndef TUE_CONTROL_SPECTRAL_H_
+#define TUE_CONTROL_SPECTRAL_H_
+
+#include <cmath>
+
+namespace tue
+{
+namespace control
+{
+
+// Single-frequency recursive DFT bin. Every sample, the accumulated phasor is rotated over the bin
+// frequency and the new sample is added, optionally with exponential forgetting:
+//
+//     X(n) = lambda * exp(j w dt) * X(n-1) + x(n)
+//
+// This costs a constant amount of work per sample, without sample buffers (the lambda = 1 case
+// is the Goertzel / sliding DFT recursion over all samples since the last reset).
+
+struct DFTBin
+{
+    DFTBin() : frequency(0), cos_w(1), sin_w(0), re(0), im(0) {}
+
+    void setFrequency(double f, double dt)
+    {
+        frequency = f;
+        cos_w = std::cos(2 * M_PI * f * dt);
+        sin_w = std::sin(2 * M_PI * f * dt);
+    }
+
+    void reset() { re = 0; im = 0; }
+
+    void update(double x, double lambda = 1)
+    {
+        double r = lambda * (cos_w * re - sin_w * im) + x;
+        im = lambda * (sin_w * re + cos_w * im);
+        re = r;
+    }
+
+    double power() const { return re * re + im * im; }
+
+    double frequency;
+
+    double cos_w, sin_w;
+
+    double re, im;
+};
+
+} // end namespace control
+
+} // end namespace tue
+
+#endif
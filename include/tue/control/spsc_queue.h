@@ -0,0 +1,82 @@
+#ifndef TUE_CONTROL_SPSC_QUEUE_H_
+#define TUE_CONTROL_SPSC_QUEUE_H_
+
+#include <tue/control/generic.h>
+
+#include <atomic>
+#include <vector>
+
+namespace tue
+{
+namespace control
+{
+
+// Bounded lock-free queue for exactly one producer thread and one consumer thread. The buffer is
+// allocated at construction; push and pop are wait-free and never allocate, so either side can be a
+// real-time thread. The producer and consumer positions are on separate cache lines.
+
+template<typename T>
+class SPSCQueue
+{
+
+public:
+
+    /// The capacity is rounded up to a power of two
+    SPSCQueue(unsigned int capacity) : head_(0), tail_(0)
+    {
+        unsigned int size = 1;
+        while(size < capacity)
+            size *= 2;
+
+        buffer_.resize(size);
+        mask_ = size - 1;
+    }
+
+    /// Producer only. Returns false (and drops the item) if the queue is full.
+    bool push(const T& item)
+    {
+        unsigned long tail = tail_.load(std::memory_order_relaxed);
+        if (tail - head_.load(std::memory_order_acquire) > mask_)
+            return false;
+
+        buffer_[tail & mask_] = item;
+        tail_.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    /// Consumer only. Returns false if the queue is empty.
+    bool pop(T& item)
+    {
+        unsigned long head = head_.load(std::memory_order_relaxed);
+        if (head == tail_.load(std::memory_order_acquire))
+            return false;
+
+        item = buffer_[head & mask_];
+        head_.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    unsigned int capacity() const { return mask_ + 1; }
+
+    /// Number of queued items (exact only when called from the producer or consumer)
+    unsigned int size() const { return tail_.load(std::memory_order_acquire) - head_.load(std::memory_order_acquire); }
+
+private:
+
+    // Consumer position
+    alignas(CACHE_LINE_SIZE) std::atomic<unsigned long> head_;
+
+    // Producer position
+    alignas(CACHE_LINE_SIZE) std::atomic<unsigned long> tail_;
+
+    alignas(CACHE_LINE_SIZE) unsigned long mask_;
+
+    std::vector<T> buffer_;
+
+};
+
+} // end namespace control
+
+} // end namespace tue
+
+#endif
@@ -0,0 +1,129 @@
+#ifndef TUE_CONTROL_STATE_OBSERVER_H_
+#define TUE_CONTROL_STATE_OBSERVER_H_
+
+#include <tue/config/configuration.h>
+
+#include "tue/control/generic.h"
+
+namespace tue
+{
+namespace control
+{
+
+// ----------------------------------------------------------------------------------------------------
+
+/// Discrete observer coefficients for the model
+///
+///     mass * acc = input + disturbance,    disturbance constant
+///
+/// with predictor-corrector gains for position, velocity and disturbance. Without a mass, the
+/// input is ignored and the disturbance is not estimated (alpha-beta filter).
+struct ObserverCoefficients
+{
+    ObserverCoefficients() : dt(0), b_pos(0), b_vel(0), k_pos(0), k_vel(0), k_dist(0) {}
+
+    double dt;
+
+    /// Input to position / velocity: dt^2 / (2 mass) and dt / mass
+    double b_pos;
+    double b_vel;
+
+    /// Correction gains
+    double k_pos;
+    double k_vel;
+    double k_dist;
+};
+
+// ----------------------------------------------------------------------------------------------------
+
+/// Observer kernel: predicts the state using the input of the previous sample and corrects it with
+/// the measurement.
+inline void updateObserver(const ObserverCoefficients& c, double measurement, double input,
+                           double& pos, double& vel, double& dist)
+{
+    double f = input + dist;
+    double p = pos + c.dt * vel + c.b_pos * f;
+    double v = vel + c.b_vel * f;
+
+    double e = measurement - p;
+    pos = p + c.k_pos * e;
+    vel = v + c.k_vel * e;
+    dist += c.k_dist * e;
+}
+
+// ----------------------------------------------------------------------------------------------------
+
+// Velocity and disturbance observer for a single joint. Each SupervisedController runs its own
+// observer within its update, between the measurement filter and the controller, so the observers
+// are not batched across joints. The kernel (updateObserver) is separate, such that a group update
+// path could run it over arrays of joints.
+//
+// Example configurations:
+//
+//     observer:
+//       type: alpha_beta
+//       alpha: 0.3
+//       beta: 0.02
+//       mass: 1                  # optional, uses input in prediction
+//
+//     observer:
+//       type: kalman             # steady-state Kalman filter, gains computed at configure time
+//       mass: 1
+//       process_noise:
+//         velocity: 1e-6
+//         disturbance: 1e-4
+//       measurement_noise: 1e-10
+
+class StateObserver
+{
+
+public:
+
+    StateObserver();
+
+    ~StateObserver();
+
+    void configure(tue::Configuration& config, double dt);
+
+    /// Resets the estimate to the given position, with zero velocity and disturbance
+    void reset(double position);
+
+    /// Sets the estimate (e.g. when restoring a checkpoint)
+    void setState(double position, double velocity, double disturbance);
+
+    /// Updates the estimate. 'input' is the (saturated) controller output of the previous sample,
+    /// and 'dt' the time elapsed since then (the nominal sample time if not set). The prediction
+    /// uses the actual elapsed time; the correction gains are those of the nominal sample time.
+    void update(double measurement, double input, double dt = INVALID_DOUBLE);
+
+    bool is_configured() const { return configured_; }
+
+    const ObserverCoefficients& coefficients() const { return coefficients_; }
+
+    double position() const { return pos_; }
+
+    double velocity() const { return vel_; }
+
+    double disturbance() const { return dist_; }
+
+private:
+
+    bool configured_;
+
+    bool initialized_;
+
+    ObserverCoefficients coefficients_;
+
+    double pos_;
+
+    double vel_;
+
+    double dist_;
+
+};
+
+} // end namespace control
+
+} // end namespace tue
+
+#endif
@@ -1,10 +1,19 @@
 #ifndef TUE_CONTROL_SUPERVISED_CONTROLLER_H_
 #define TUE_CONTROL_SUPERVISED_CONTROLLER_H_
 
+#include <atomic>
 #include <memory>
+#include <type_traits>
+#include <vector>
 
 #include <tue/config/configuration.h>
 #include <tue/control/controller_input.h>
+#include <tue/control/generic_controller.h>
+#include <tue/control/input_shaper.h>
+#include <tue/control/setpoint_controller.h>
+#include <tue/control/loop_statistics.h>
+#include <tue/control/measurement_filter.h>
+#include <tue/control/state_observer.h>
 
 namespace tue
 {
@@ -12,6 +21,7 @@ namespace control
 {
 
 class Controller;
+class SystemIdentification;
 struct ControllerInput;
 struct ControllerOutput;
 
@@ -40,6 +50,107 @@ enum ControllerEvent
 
 // ----------------------------------------------------------------------------------------------------
 
+/// End stop detection, used by the HomingCoordinator. The end stop is detected once the absolute
+/// tracking error or effort exceeds its threshold for 'samples' consecutive samples.
+struct HomingEndStop
+{
+    HomingEndStop() : position(INVALID_DOUBLE), error(INVALID_DOUBLE), effort(INVALID_DOUBLE), samples(1),
+        timeout(INVALID_DOUBLE) {}
+
+    /// Position of the joint at the end stop (passed to stopHoming)
+    double position;
+
+    /// Tracking error threshold
+    double error;
+
+    /// Effort (current, or controller output if no effort is given) threshold
+    double effort;
+
+    unsigned int samples;
+
+    /// Maximum homing duration [s]
+    double timeout;
+};
+
+// ----------------------------------------------------------------------------------------------------
+
+/// Controller types that can be stored inline in the SupervisedController, and are updated without
+/// virtual dispatch. All other types (INLINE_NONE) are held through a shared pointer.
+enum InlineControllerType
+{
+    INLINE_NONE = 0,
+    INLINE_GENERIC = 1,
+    INLINE_SETPOINT = 2
+};
+
+// ----------------------------------------------------------------------------------------------------
+
+static const unsigned int MAX_CHECKPOINT_NAME = 32;
+static const unsigned int MAX_CHECKPOINT_STATE = 64;
+
+/// Snapshot of everything needed to continue controlling without re-homing: status, homing offset,
+/// references, observer estimate and the internal state of the controller. Plain data, so it can be
+/// stored in shared memory (see Checkpointer).
+struct ControllerCheckpoint
+{
+    char name[MAX_CHECKPOINT_NAME];
+
+    int status;
+
+    int homed;
+
+    double measurement_offset;
+
+    double homing_pos;
+    double homing_vel;
+
+    double pos_reference;
+    double vel_reference;
+    double acc_reference;
+
+    double output;
+    double previous_output;
+
+    // Measurement filter position, velocity and number of consecutive dropouts
+    double measurement_filter[3];
+
+    // Observer position, velocity and disturbance estimate
+    double observer[3];
+
+    unsigned int state_size;
+    double state[MAX_CHECKPOINT_STATE];
+};
+
+// ----------------------------------------------------------------------------------------------------
+
+enum WatchdogFallback
+{
+    FALLBACK_ZERO = 0,
+    FALLBACK_HOLD = 1
+};
+
+/// Update deadline, monitored by the Watchdog
+struct WatchdogSettings
+{
+    WatchdogSettings() : budget(INVALID_DOUBLE), timeout(INVALID_DOUBLE), fallback(FALLBACK_ZERO), decay(INVALID_DOUBLE) {}
+
+    bool is_configured() const { return is_set(budget); }
+
+    /// Maximum interval between two updates [s]. A longer interval counts as a late tick.
+    double budget;
+
+    /// Interval without updates after which the watchdog trips [s]
+    double timeout;
+
+    /// Output written by the watchdog once tripped
+    WatchdogFallback fallback;
+
+    /// Time constant with which the held output decays to zero [s] (FALLBACK_HOLD only)
+    double decay;
+};
+
+// ----------------------------------------------------------------------------------------------------
+
 // Wraps Controller with safety and homing functionality
 
 class SupervisedController
@@ -55,11 +166,23 @@ public:
 
     SupervisedController& operator=(const SupervisedController&) = delete;
 
+    /// Allocates cache line aligned (plain operator new only guarantees the alignment of the
+    /// fundamental types). Note that std::make_shared does not use these.
+    static void* operator new(std::size_t size);
+
+    static void operator delete(void* p);
+
 
     // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
     // Configuration
 
-    void setController(const std::shared_ptr<Controller>& controller) { controller_ = controller; }
+    void setController(const std::shared_ptr<Controller>& controller);
+
+    /// Constructs a controller of the given (closed set) type in the inline storage, and returns it
+    /// so it can be configured. Returns 0 for INLINE_NONE.
+    Controller* emplaceController(InlineControllerType type);
+
+    InlineControllerType inline_controller_type() const { return inline_type_; }
 
     void configure(tue::Configuration& config, double dt);
 
@@ -67,8 +190,13 @@ public:
     // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
     // Update
 
+    /// Update with the nominal sample time
     void update(double measurement);
 
+    /// Update with the actual elapsed time, derived from the timestamp [s] of the measurement. The
+    /// controller (if it supports it) uses the discretization closest to the elapsed time.
+    void update(double measurement, double timestamp);
+
     void updateHoming(double measurement, ControllerOutput& output);
 
 
@@ -82,6 +210,9 @@ public:
         input_.acc_reference = acc;
     }
 
+    /// Sets the external scheduling variable (for gain-scheduled controllers)
+    void setSchedulingVariable(double s) { input_.scheduling_variable = s; }
+
     void startHoming() { event_ = START_HOMING; }
 
     void stopHoming(double current_pos) { event_ = STOP_HOMING; homed_measurement_ = current_pos; }
@@ -90,13 +221,37 @@ public:
 
     void disable() { event_ = DISABLE; }
 
+    /// Starts injecting the identification excitation (only if configured and ACTIVE). The
+    /// identification stops automatically when the controller leaves ACTIVE.
+    void startIdentification();
+
+    void stopIdentification();
+
     void enable() { event_ = ENABLE; }
 
 
+    // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+    // Checkpoint / restore
+
+    /// Returns false if the controller state does not fit in the checkpoint
+    bool saveCheckpoint(ControllerCheckpoint& checkpoint) const;
+
+    /// Returns true if the checkpoint was saved by a controller with the same name and state size
+    bool matchesCheckpoint(const ControllerCheckpoint& checkpoint) const;
+
+    /// Continues from the checkpoint. Returns false (and leaves the controller untouched) if the
+    /// checkpoint does not match.
+    bool restoreCheckpoint(const ControllerCheckpoint& checkpoint);
+
+
     // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
     // Getters
 
-    ControllerStatus status() const { return status_; }
+    /// ERROR as soon as the watchdog tripped, even before the next update handles it
+    ControllerStatus status() const
+    {
+        return watchdog_tripped_.load(std::memory_order_relaxed) ? ERROR : status_;
+    }
 
     const char* status_string() const
     {
@@ -110,6 +265,10 @@ public:
 
     double output() const { return output_; }
 
+    /// Amount by which the output was limited (saturation and slew rate) in the last update: the
+    /// applied minus the requested output, or 0 if not limited
+    double output_clamp() const { return output_clamp_; }
+
     bool accepts_references() const { return status() == ACTIVE; }
 
     const std::string& name() const;
@@ -126,40 +285,171 @@ public:
 
     bool is_homable() const { return homable_; }
 
+    /// Names of the joints that must be homed before this one
+    const std::vector<std::string>& homing_preconditions() const { return homing_preconditions_; }
+
+    const HomingEndStop& homing_end_stop() const { return homing_end_stop_; }
+
+    double dt() const { return dt_; }
+
+    const WatchdogSettings& watchdog_settings() const { return watchdog_; }
+
+    /// Number of updates so far. Can be read from any thread.
+    unsigned long heartbeat() const { return heartbeat_.load(std::memory_order_acquire); }
+
+    /// Steady clock time [s] of the last update (INVALID_DOUBLE if none yet, or no watchdog is
+    /// configured). Read after heartbeat(), it is at least as recent as that heartbeat.
+    double heartbeat_time() const { return heartbeat_time_.load(std::memory_order_relaxed); }
+
+    /// Number of intervals between updates that exceeded the watchdog budget, and the number of
+    /// ticks missed in those intervals. Can be read from any thread.
+    unsigned long late_ticks() const { return late_ticks_.load(std::memory_order_relaxed); }
+
+    unsigned long missed_ticks() const { return missed_ticks_.load(std::memory_order_relaxed); }
+
+    /// Drives the controller to ERROR on its next update. Can be called from any thread.
+    void tripWatchdog() { watchdog_tripped_.store(true, std::memory_order_release); }
+
+    /// Loop-health statistics, accumulated while the controller is active
+    const LoopStatistics& statistics() const { return statistics_; }
+
+    void getStatistics(LoopStatisticsSnapshot& snapshot) const { statistics_.getSnapshot(snapshot); }
+
+    /// Measurement pre-processing stage (dropout and spike counters)
+    const MeasurementFilter& measurement_filter() const { return measurement_filter_; }
+
+    /// Velocity and disturbance observer
+    const StateObserver& observer() const { return observer_; }
+
+    /// Reference input shaper (see 'input_shaping')
+    const InputShaper& input_shaper() const { return input_shaper_; }
+
+    /// Online system identification, or 0 if not configured
+    const SystemIdentification* identification() const { return identification_.get(); }
+
 private:
 
-    double dt_;
+    // The members are grouped by access pattern. The hot state (read and written every update) is
+    // packed at the start of the object, followed by the inline controller and the per-update stages.
+    // State shared with the watchdog thread and the cold state (configuration, error message, homing
+    // settings) are on separate cache lines, and the object itself is cache line aligned, such that
+    // controllers updated on different cores never share a cache line.
 
-    ControllerStatus status_;
+    // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+    // Hot state
 
-    ControllerEvent event_;
+    alignas(CACHE_LINE_SIZE) ControllerInput input_;
 
-    std::shared_ptr<Controller> controller_;
+    // The active controller (inline or shared)
+    Controller* core_;
+
+    InlineControllerType inline_type_;
 
-    std::string error_msg_;
+    ControllerStatus status_;
 
-    ControllerInput input_;
+    ControllerEvent event_;
 
     bool homed_;
 
-    bool homable_;
+    double output_;
 
     double error_;
 
-    double output_;
+    // Output applied during the previous sample
+    double previous_output_;
 
-    void checkTransitions(double raw_measurements);
+    // Output to continue with at the first update after activation (INVALID_DOUBLE if none)
+    double bumpless_output_;
 
-    // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
-    // Safety
+    double measurement_offset;
+
+    // Applied minus requested output of the last update (saturation and slew rate)
+    double output_clamp_;
 
     double output_saturation_;
     double max_error_;
+    double slew_rate_;
+
+    bool anti_windup_;
+
+    double dt_;
+
+    // Timestamp of the previous update (only if updated with timestamps)
+    double last_timestamp_;
+
+    void step(double raw_measurement);
+
+    void checkTransitions(double raw_measurements);
+
+    // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+    // Controller, either held inline (closed set of types) or through a shared pointer
+
+    alignas(CACHE_LINE_SIZE) typename std::aligned_storage<(sizeof(GenericController) > sizeof(SetpointController) ?
+                                   sizeof(GenericController) : sizeof(SetpointController)),
+                                  (alignof(GenericController) > alignof(SetpointController) ?
+                                   alignof(GenericController) : alignof(SetpointController))>::type inline_storage_;
+
+    std::shared_ptr<Controller> controller_;
+
+    void clearController();
+
+    inline void updateController(const ControllerInput& input, ControllerOutput& output);
+
+    // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+    // Measurement pre-processing
+
+    MeasurementFilter measurement_filter_;
+
+    // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+    // Reference shaping
+
+    InputShaper input_shaper_;
+
+    // Shapes the references of 'input' (if configured)
+    void shapeReference(ControllerInput& input);
+
+    // Restarts the shaper at the given (constant) references
+    void resetShaper(double pos, double vel, double acc);
+
+    // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+    // Observer
+
+    StateObserver observer_;
+
+    // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+    // Statistics
+
+    LoopStatistics statistics_;
+
+    // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+    // Watchdog (shared with the watchdog thread)
+
+    alignas(CACHE_LINE_SIZE) std::atomic<unsigned long> heartbeat_;
+
+    std::atomic<double> heartbeat_time_;
+
+    // Written by the real-time thread only
+    std::atomic<unsigned long> late_ticks_;
+    std::atomic<unsigned long> missed_ticks_;
+
+    std::atomic<bool> watchdog_tripped_;
+
+    // Publishes the heartbeat, and counts the interval since the previous one if it was late
+    void beat();
+
+    // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+    // Cold state
+
+    alignas(CACHE_LINE_SIZE) std::string error_msg_;
+
+    WatchdogSettings watchdog_;
+
+    std::shared_ptr<SystemIdentification> identification_;
 
     // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
     // Homing
 
-    double measurement_offset;
+    bool homable_;
 
     double homing_max_vel_;
     double homing_max_acc_;
@@ -168,6 +458,10 @@ private:
     double homing_vel;
     double homed_measurement_;
 
+    std::vector<std::string> homing_preconditions_;
+
+    HomingEndStop homing_end_stop_;
+
 };
 
 } // end namespace tue
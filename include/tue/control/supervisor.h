@@ -0,0 +1,312 @@
+#ifndef TUE_CONTROL_SUPERVISOR_H_
+#define TUE_CONTROL_SUPERVISOR_H_
+
+#include <tue/control/spsc_queue.h>
+#include <tue/control/supervised_controller.h>
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace tue
+{
+namespace control
+{
+
+// ----------------------------------------------------------------------------------------------------
+
+enum SupervisorCommandType
+{
+    COMMAND_START_HOMING = 0,
+    COMMAND_STOP_HOMING = 1,    // value: current position
+    COMMAND_ENABLE = 2,
+    COMMAND_DISABLE = 3,
+    COMMAND_SET_ERROR = 4,      // message: error message
+    COMMAND_SET_REFERENCE = 5   // value: position reference
+};
+
+/// Command from the supervisor to the real-time thread
+struct SupervisorCommand
+{
+    SupervisorCommand() : joint(0), type(COMMAND_DISABLE), value(0), message(0) {}
+
+    SupervisorCommand(unsigned int joint_, SupervisorCommandType type_, double value_ = 0, const char* message_ = 0)
+        : joint(joint_), type(type_), value(value_), message(message_) {}
+
+    unsigned int joint;
+    SupervisorCommandType type;
+    double value;
+
+    // Must outlive the command (string literal, or owned by the sequence)
+    const char* message;
+};
+
+/// State of a joint, as published by the real-time thread
+struct JointFeedback
+{
+    unsigned int joint;
+    ControllerStatus status;
+    bool homed;
+    double measurement;
+    double error;
+    double output;
+    double reference;
+
+    // Number of commands the bridge had applied when the feedback was published
+    unsigned long commands_applied;
+};
+
+// ----------------------------------------------------------------------------------------------------
+
+// Real-time side of the supervisor: the only place where supervisor commands touch the controllers.
+// Call update() from the real-time thread every tick, after the controllers have been updated. It
+// applies the queued commands (events take effect in the next controller update) and publishes the
+// joint states every 'feedback_interval' ticks, and immediately when the status of a joint changes.
+// Never blocks, and only allocates for the message of COMMAND_SET_ERROR. Feedback that does not fit
+// in the queue is dropped (and counted).
+
+class SupervisorBridge
+{
+
+public:
+
+    SupervisorBridge(const std::vector<std::shared_ptr<SupervisedController> >& controllers,
+                     unsigned int queue_size = 1024, unsigned int feedback_interval = 10);
+
+    ~SupervisorBridge();
+
+    SupervisorBridge(const SupervisorBridge&) = delete;
+
+    SupervisorBridge& operator=(const SupervisorBridge&) = delete;
+
+    /// Allocates cache line aligned, as the queue positions are on separate cache lines
+    static void* operator new(std::size_t size);
+
+    static void operator delete(void* p);
+
+    /// Real-time thread only
+    void update();
+
+    unsigned int size() const { return joints_.size(); }
+
+    /// Supervisor thread only
+    SPSCQueue<SupervisorCommand>& commands() { return commands_; }
+
+    /// Supervisor thread only
+    SPSCQueue<JointFeedback>& feedback() { return feedback_; }
+
+    /// Number of feedback messages dropped because the queue was full
+    unsigned long dropped_feedback() const { return dropped_.load(std::memory_order_relaxed); }
+
+private:
+
+    struct Joint
+    {
+        std::shared_ptr<SupervisedController> controller;
+        ControllerStatus published_status;
+
+        // Publish in the next tick, regardless of the interval
+        bool dirty;
+    };
+
+    std::vector<Joint> joints_;
+
+    unsigned int feedback_interval_;
+
+    unsigned int ticks_;
+
+    unsigned long commands_applied_;
+
+    std::atomic<unsigned long> dropped_;
+
+    SPSCQueue<SupervisorCommand> commands_;
+
+    SPSCQueue<JointFeedback> feedback_;
+
+    void publish(unsigned int i);
+
+};
+
+// ----------------------------------------------------------------------------------------------------
+
+// Supervisory sequence of a single joint (homing, enable sequence, error recovery), written as a list
+// of steps that is executed by the Supervisor. A waiting step suspends the sequence until its
+// condition holds, so a sequence never blocks a thread; the supervisor resumes it once new feedback
+// of the joint arrives. Conditions only see feedback that was published after the preceding command
+// was applied. Example:
+//
+//     Sequence s(joint);
+//     s.command(COMMAND_START_HOMING)
+//      .waitForStatus(HOMING)
+//      .waitUntil([](const JointFeedback& f) { return std::abs(f.error) > 0.01; }).timeout(5)
+//      .command(COMMAND_STOP_HOMING, 0.0)
+//      .waitForStatus(ACTIVE).timeout(1);
+
+class Sequence
+{
+
+public:
+
+    typedef std::function<bool(const JointFeedback&)> Condition;
+
+    Sequence(unsigned int joint) : joint_(joint) {}
+
+    /// Sends a command to the joint
+    Sequence& command(SupervisorCommandType type, double value = 0);
+
+    /// Drives the joint to ERROR with the given message
+    Sequence& setError(const std::string& message);
+
+    Sequence& waitForStatus(ControllerStatus status);
+
+    Sequence& waitUntil(const Condition& condition);
+
+    /// Waits for the given duration [s]
+    Sequence& wait(double duration);
+
+    /// Fails the sequence if the preceding waiting step takes longer than 'duration' [s]. If
+    /// 'set_error' is true, the joint is driven to ERROR as well.
+    Sequence& timeout(double duration, bool set_error = true);
+
+    unsigned int joint() const { return joint_; }
+
+private:
+
+    friend class Supervisor;
+
+    enum StepType
+    {
+        STEP_COMMAND,
+        STEP_WAIT_STATUS,
+        STEP_WAIT_CONDITION,
+        STEP_WAIT_TIME
+    };
+
+    struct Step
+    {
+        Step(StepType type_) : type(type_), status(UNINITIALIZED), duration(0), timeout(INVALID_DOUBLE),
+            timeout_error(false) {}
+
+        StepType type;
+
+        SupervisorCommand command;
+        std::shared_ptr<std::string> message;
+
+        ControllerStatus status;
+        Condition condition;
+        double duration;
+
+        double timeout;
+        bool timeout_error;
+    };
+
+    unsigned int joint_;
+
+    std::vector<Step> steps_;
+
+};
+
+// ----------------------------------------------------------------------------------------------------
+
+// Runs any number of sequences concurrently on a single (non real-time) thread. Talks to the
+// controllers only through the lock-free queues of a SupervisorBridge, so the real-time thread never
+// waits for the supervisor.
+
+class Supervisor
+{
+
+public:
+
+    enum SequenceState
+    {
+        RUNNING = 0,
+        SUCCEEDED = 1,
+        FAILED = 2,
+        CANCELED = 3
+    };
+
+    Supervisor(const std::shared_ptr<SupervisorBridge>& bridge);
+
+    ~Supervisor();
+
+    /// Starts a sequence and returns its id. Can be called from any thread.
+    unsigned int runSequence(const Sequence& sequence);
+
+    /// Can be called from any thread
+    void cancel(unsigned int id);
+
+    /// FAILED (with error message "Unknown sequence") for an id that runSequence did not return
+    SequenceState state(unsigned int id) const;
+
+    std::string error_message(unsigned int id) const;
+
+    /// Starts the supervisor thread, which spins every period [s]
+    void start(double period);
+
+    void stop();
+
+    /// Processes the feedback and advances the sequences at time 'now' [s] (called by the
+    /// supervisor thread)
+    void spin(double now);
+
+    /// Latest feedback of joint i (supervisor thread only)
+    const JointFeedback& feedback(unsigned int i) const { return feedback_[i]; }
+
+    /// Number of sequences that are still running. Can be called from any thread.
+    unsigned int num_running() const;
+
+private:
+
+    struct Task
+    {
+        Task(const Sequence& s) : sequence(s), step(0), step_start(INVALID_DOUBLE), min_commands(0), state(RUNNING),
+            error_pending(false) {}
+
+        Sequence sequence;
+        unsigned int step;
+        double step_start;
+        unsigned long min_commands;
+        SequenceState state;
+        std::string error_msg;
+
+        // The SET_ERROR of a timeout did not fit in the command queue yet
+        bool error_pending;
+    };
+
+    std::shared_ptr<SupervisorBridge> bridge_;
+
+    // Latest feedback per joint, and whether any feedback of the joint arrived yet
+    std::vector<JointFeedback> feedback_;
+
+    std::vector<bool> received_;
+
+    unsigned long commands_pushed_;
+
+    mutable std::mutex mutex_;
+
+    std::vector<std::shared_ptr<Task> > tasks_;
+
+    std::thread thread_;
+
+    std::atomic<bool> running_;
+
+    void run(double period);
+
+    // Executes steps of the task until it has to wait
+    void advance(Task& task, double now);
+
+    void fail(Task& task, const std::string& msg, bool set_error);
+
+    void pushError(Task& task);
+
+};
+
+} // end namespace control
+
+} // end namespace tue
+
+#endif
@@ -0,0 +1,107 @@
+#ifndef TUE_CONTROL_SYNCHRONIZED_TRAJECTORY_H_
+#define TUE_CONTROL_SYNCHRONIZED_TRAJECTORY_H_
+
+#include <memory>
+#include <vector>
+
+#include <tue/config/configuration.h>
+
+namespace tue
+{
+namespace control
+{
+
+class SupervisedController;
+
+// ----------------------------------------------------------------------------------------------------
+
+// Time-synchronized point-to-point trajectories for a group of joints. For every joint a
+// minimum-time rest-to-rest profile is computed within its velocity, acceleration and (optional)
+// jerk limits (seven segment profile, or trapezoidal without jerk limit). All profiles are then
+// time-scaled to the duration of the slowest joint, which keeps every joint within its limits and
+// makes all joints start and finish together.
+//
+// Example configuration:
+//
+//     trajectory:
+//       - joint: shoulder
+//         max_velocity: 1.0
+//         max_acceleration: 2.0
+//         max_jerk: 20           # optional
+//       - joint: elbow
+//         ...
+
+class SynchronizedTrajectory
+{
+
+public:
+
+    SynchronizedTrajectory();
+
+    ~SynchronizedTrajectory();
+
+    void configure(tue::Configuration& config, const std::vector<std::shared_ptr<SupervisedController> >& controllers, double dt);
+
+    /// Plans a synchronized motion from the current references to 'target' (size() elements).
+    /// Returns false if not all controllers accept references.
+    bool setTarget(const double* target);
+
+    /// Samples the trajectory at the next tick and sets the references of all controllers
+    void update();
+
+    /// Samples all joints at time t since the start of the motion
+    void sample(double t, double* pos, double* vel, double* acc) const;
+
+    bool done() const { return t_ >= duration_; }
+
+    /// Duration of the current motion [s]
+    double duration() const { return duration_; }
+
+    unsigned int size() const { return controllers_.size(); }
+
+private:
+
+    static const unsigned int NUM_SEGMENTS = 7;
+
+    double dt_;
+
+    std::vector<std::shared_ptr<SupervisedController> > controllers_;
+
+    // Limits
+
+    std::vector<double> max_vel_;
+    std::vector<double> max_acc_;
+    std::vector<double> max_jerk_;
+
+    // Profiles (structure of arrays). Per joint: the time scale and, per segment, the start time,
+    // start state and jerk, in the unscaled time of that joint.
+
+    std::vector<double> start_pos_;
+    std::vector<double> target_;
+    std::vector<double> scale_;
+    std::vector<double> seg_time_;
+    std::vector<double> seg_pos_;
+    std::vector<double> seg_vel_;
+    std::vector<double> seg_acc_;
+    std::vector<double> seg_jerk_;
+
+    // Sample buffers
+
+    std::vector<double> pos_;
+    std::vector<double> vel_;
+    std::vector<double> acc_;
+
+    double t_;
+
+    double duration_;
+
+    /// Computes the minimum time profile of joint i for a (signed) distance. Returns the duration.
+    double plan(unsigned int i, double distance);
+
+};
+
+} // end namespace control
+
+} // end namespace tue
+
+#endif
@@ -0,0 +1,145 @@
+#ifndef TUE_CONTROL_SYSTEM_IDENTIFICATION_H_
+#define TUE_CONTROL_SYSTEM_IDENTIFICATION_H_
+
+#include <complex>
+#include <vector>
+
+#include <tue/config/configuration.h>
+
+#include "tue/control/spectral.h"
+
+namespace tue
+{
+namespace control
+{
+
+// ----------------------------------------------------------------------------------------------------
+
+static const unsigned int MAX_IDENTIFICATION_LINES = 64;
+
+/// Frequency response functions measured by SystemIdentification
+struct FrequencyResponse
+{
+    FrequencyResponse() : size(0) {}
+
+    unsigned int size;
+
+    /// Frequency lines [Hz]
+    double frequency[MAX_IDENTIFICATION_LINES];
+
+    /// Plant: measurement / controller output
+    std::complex<double> plant[MAX_IDENTIFICATION_LINES];
+
+    /// Closed loop: measurement / excitation. This is the process sensitivity if the excitation is
+    /// injected at the output, and the complementary sensitivity if injected at the reference.
+    std::complex<double> closed_loop[MAX_IDENTIFICATION_LINES];
+
+    /// Controller output / excitation (input sensitivity if injected at the output)
+    std::complex<double> sensitivity[MAX_IDENTIFICATION_LINES];
+};
+
+// ----------------------------------------------------------------------------------------------------
+
+// Online frequency response measurement. A periodic excitation (multisine, chirp or PRBS) is
+// precomputed for one period at configuration time. While running, the excitation is injected and
+// the excitation, controller output and measurement are accumulated in recursive DFT bins at the
+// analysis lines (harmonics of the excitation period, so there is no leakage). The first period is
+// used to let transients settle. The work per tick is a table lookup plus three bin updates per line.
+//
+// Example configuration:
+//
+//     identification:
+//       excitation: multisine      # multisine, chirp or prbs
+//       injection: output          # output or reference
+//       amplitude: 0.1
+//       min_frequency: 1
+//       max_frequency: 100
+//       frequency_resolution: 0.5  # period = 1 / frequency_resolution
+//       lines: 32                  # optional, at most MAX_IDENTIFICATION_LINES
+//       periods: 10                # optional, periods to average over
+//       prbs_order: 10             # prbs only, period = (2^order - 1) * prbs_divider samples
+//       prbs_divider: 1
+
+class SystemIdentification
+{
+
+public:
+
+    enum Injection
+    {
+        OUTPUT = 0,
+        REFERENCE = 1
+    };
+
+    enum State
+    {
+        IDLE = 0,
+        SETTLING = 1,
+        MEASURING = 2,
+        DONE = 3
+    };
+
+    SystemIdentification();
+
+    ~SystemIdentification();
+
+    void configure(tue::Configuration& config, double dt);
+
+    bool is_configured() const { return !period_.empty(); }
+
+    void start();
+
+    void stop();
+
+    bool is_running() const { return state_ == SETTLING || state_ == MEASURING; }
+
+    State state() const { return state_; }
+
+    Injection injection() const { return injection_; }
+
+    /// Excitation for the current sample (0 if not running)
+    double excitation() const { return is_running() ? period_[index_] : 0; }
+
+    /// Accumulates the current sample and advances to the next one
+    void update(double excitation, double output, double measurement);
+
+    /// Measured frequency responses, valid once state() == DONE
+    const FrequencyResponse& result() const { return result_; }
+
+private:
+
+    Injection injection_;
+
+    State state_;
+
+    // Excitation (one period)
+
+    std::vector<double> period_;
+
+    unsigned int index_;
+
+    unsigned int num_periods_;
+
+    unsigned int period_count_;
+
+    // Spectra at the analysis lines
+
+    unsigned int num_lines_;
+
+    DFTBin excitation_bins_[MAX_IDENTIFICATION_LINES];
+
+    DFTBin output_bins_[MAX_IDENTIFICATION_LINES];
+
+    DFTBin measurement_bins_[MAX_IDENTIFICATION_LINES];
+
+    FrequencyResponse result_;
+
+    void computeResult();
+
+};
+
+} // end namespace control
+
+} // end namespace tue
+
+#endif
@@ -0,0 +1,346 @@
+#ifndef TUE_CONTROL_TELEMETRY_H_
+#define TUE_CONTROL_TELEMETRY_H_
+
+#include <tue/control/spsc_queue.h>
+#include <tue/control/supervised_controller.h>
+
+#include <tue/config/configuration.h>
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace tue
+{
+namespace control
+{
+
+enum TelemetrySignal
+{
+    TELEMETRY_ERROR = 0,
+    TELEMETRY_OUTPUT = 1,
+    TELEMETRY_MEASUREMENT = 2,
+    TELEMETRY_SATURATION = 3    // applied minus requested output (see SupervisedController::output_clamp)
+};
+
+static const unsigned int NUM_TELEMETRY_SIGNALS = 4;
+
+static const unsigned int MAX_TELEMETRY_JOINTS = 64;
+
+/// Aggregate of one signal over a window (all INVALID_DOUBLE if the signal had no valid samples)
+struct TelemetryAggregate
+{
+    double min;
+    double max;
+    double mean;
+    double last;
+};
+
+struct TelemetryJoint
+{
+    ControllerStatus status;
+
+    TelemetryAggregate signals[NUM_TELEMETRY_SIGNALS];
+};
+
+/// Aggregates of all joints over one window
+struct TelemetryFrame
+{
+    /// Tick at the end of the window
+    unsigned long tick;
+
+    /// Number of ticks in the window
+    unsigned int samples;
+
+    unsigned int num_joints;
+
+    TelemetryJoint joints[MAX_TELEMETRY_JOINTS];
+};
+
+// ----------------------------------------------------------------------------------------------------
+
+// Compresses telemetry frames. Integers (tick, window length, status) are encoded as the zigzag
+// varint of their difference with the previous frame; doubles as the XOR with the same value in
+// the previous frame, of which only the bits between the leading and trailing zeros are stored.
+// Slowly changing aggregates therefore take a few bits each, and unchanged ones a single bit.
+//
+// Every 'key_frame_interval' frames (and after reset()) a key frame is written, which is encoded
+// against zeros instead of the previous frame, such that a reader can start there.
+//
+// Format (bit fields are written most significant bit first):
+//
+//     frame     := length (byte varint) payload (length bytes, zero padded to a byte boundary)
+//     payload   := key:1 tick:varint samples:varint num_joints:varint joint*
+//     joint     := status:varint (min max mean last)*   (for each signal)
+//     varint    := groups of 1 continuation bit + 7 bits, least significant group first
+//     double    := '0'                                    (same as in the previous frame)
+//                | '1' leading:6 length-1:6 bits:length   (XOR with the previous frame)
+
+class TelemetryEncoder
+{
+
+public:
+
+    TelemetryEncoder(unsigned int key_frame_interval = 100);
+
+    /// Appends the encoded frame to 'data'
+    void encode(const TelemetryFrame& frame, std::vector<unsigned char>& data);
+
+    /// Makes the next frame a key frame
+    void reset() { frames_since_key_ = key_frame_interval_; }
+
+private:
+
+    unsigned int key_frame_interval_;
+
+    unsigned int frames_since_key_;
+
+    unsigned long tick_;
+
+    unsigned int samples_;
+
+    int status_[MAX_TELEMETRY_JOINTS];
+
+    uint64_t values_[MAX_TELEMETRY_JOINTS * NUM_TELEMETRY_SIGNALS * 4];
+
+    // Payload of the frame being encoded (reused, to not allocate every frame)
+    std::vector<unsigned char> payload_;
+
+};
+
+// ----------------------------------------------------------------------------------------------------
+
+class TelemetryDecoder
+{
+
+public:
+
+    TelemetryDecoder();
+
+    /// Decodes the frame at the start of 'data', and sets 'size' to the number of bytes it takes.
+    /// Returns false if the data does not hold a complete frame (size = 0), or if the frame can not
+    /// be decoded because no key frame was decoded yet (size is set, so the frame can be skipped).
+    bool decode(const unsigned char* data, unsigned int available, TelemetryFrame& frame, unsigned int& size);
+
+private:
+
+    bool synchronized_;
+
+    unsigned long tick_;
+
+    unsigned int samples_;
+
+    int status_[MAX_TELEMETRY_JOINTS];
+
+    uint64_t values_[MAX_TELEMETRY_JOINTS * NUM_TELEMETRY_SIGNALS * 4];
+
+};
+
+// ----------------------------------------------------------------------------------------------------
+
+class TelemetrySink
+{
+
+public:
+
+    virtual ~TelemetrySink() {}
+
+    /// Writes one encoded frame. Returns false if it was dropped.
+    virtual bool write(const unsigned char* data, unsigned int size) = 0;
+
+    /// True (once) if the stream was restarted, e.g. a new file was started, so the next frame must
+    /// be a key frame
+    virtual bool restarted() { return false; }
+
+};
+
+// ----------------------------------------------------------------------------------------------------
+
+// Writes the frames to 'path'. Once the file exceeds 'max_size' bytes, it is renamed to 'path.1'
+// (the older files to 'path.2' etc., up to 'path.<max_files - 1>') and a new file is started. Every
+// file starts with a key frame, so each can be decoded on its own.
+
+class RotatingFileSink : public TelemetrySink
+{
+
+public:
+
+    RotatingFileSink(const std::string& path, unsigned long max_size, unsigned int max_files);
+
+    ~RotatingFileSink();
+
+    bool write(const unsigned char* data, unsigned int size);
+
+    bool restarted();
+
+    bool is_open() const { return fd_ >= 0; }
+
+private:
+
+    std::string path_;
+
+    unsigned long max_size_;
+
+    unsigned int max_files_;
+
+    int fd_;
+
+    unsigned long size_;
+
+    bool restarted_;
+
+    void rotate();
+
+};
+
+// ----------------------------------------------------------------------------------------------------
+
+// Sends every frame as a datagram to the unix domain socket 'path'. Never blocks: frames are
+// dropped while there is no receiver, or its buffer is full.
+
+class SocketSink : public TelemetrySink
+{
+
+public:
+
+    SocketSink(const std::string& path);
+
+    ~SocketSink();
+
+    bool write(const unsigned char* data, unsigned int size);
+
+private:
+
+    std::string path_;
+
+    int fd_;
+
+};
+
+// ----------------------------------------------------------------------------------------------------
+
+// Telemetry of a set of controllers at a fraction of the bandwidth of the full traces: every tick,
+// the error, output, measurement and saturation of each joint are aggregated into their minimum,
+// maximum, mean and last value over a tumbling window, so peaks are never lost. Completed windows
+// are passed through a lock-free queue to a writer thread, which encodes them (see
+// TelemetryEncoder) and writes them to the sink. The real-time thread never blocks and never
+// allocates; windows that do not fit in the queue are dropped (and counted). Example configuration:
+//
+//     telemetry:
+//       window: 0.1               # aggregation window [s]
+//       key_frame_interval: 100   # frames
+//       sink:
+//         type: file              # file or socket
+//         path: /tmp/tue_control_telemetry
+//         max_file_size: 10000000 # bytes (file only)
+//         max_files: 10           # (file only)
+//
+// Usage:
+//
+//     telemetry.addController(c);           // for every controller, in a fixed order
+//     telemetry.configure(config, dt);      // within the 'telemetry' group
+//     telemetry.start(0.05);                // writer thread
+//
+//     real-time loop: update the controllers, then telemetry.update()
+
+class Telemetry
+{
+
+public:
+
+    Telemetry();
+
+    ~Telemetry();
+
+    void addController(const std::shared_ptr<SupervisedController>& controller);
+
+    /// Reads the window, key frame interval and sink. Call after all controllers are added.
+    void configure(tue::Configuration& config, double dt);
+
+    /// Replaces the sink (e.g. a custom one)
+    void setSink(const std::shared_ptr<TelemetrySink>& sink) { sink_ = sink; }
+
+    /// Real-time thread, once per tick after the controllers are updated
+    void update();
+
+    /// Starts the writer thread, which writes the completed windows every period [s]
+    void start(double period);
+
+    /// Stops the writer thread, and writes the remaining windows
+    void stop();
+
+    /// Encodes and writes all completed windows (writer thread)
+    void flush();
+
+    /// Number of frames and bytes written (writer thread, or after stop())
+    unsigned long frames_written() const { return frames_written_; }
+
+    unsigned long bytes_written() const { return bytes_written_; }
+
+    /// Number of windows dropped because the queue or the sink was full
+    unsigned long dropped() const { return dropped_.load(std::memory_order_relaxed); }
+
+private:
+
+    struct Accumulator
+    {
+        double min;
+        double max;
+        double sum;
+        double last;
+        unsigned int n;
+    };
+
+    std::vector<std::shared_ptr<SupervisedController> > controllers_;
+
+    unsigned int window_;
+
+    unsigned int ticks_;
+
+    unsigned long tick_;
+
+    // [joint * NUM_TELEMETRY_SIGNALS + signal]
+    std::vector<Accumulator> acc_;
+
+    // Window being completed (member, since it is too large for the stack of a real-time thread)
+    TelemetryFrame frame_;
+
+    bool configured_;
+
+    // Room for the windows of several writer periods
+    SPSCQueue<TelemetryFrame> queue_;
+
+    std::atomic<unsigned long> dropped_;
+
+    // Writer thread
+
+    std::shared_ptr<TelemetrySink> sink_;
+
+    TelemetryEncoder encoder_;
+
+    TelemetryFrame write_frame_;
+
+    std::vector<unsigned char> buffer_;
+
+    unsigned long frames_written_;
+
+    unsigned long bytes_written_;
+
+    std::thread thread_;
+
+    std::atomic<bool> running_;
+
+    void run(double period);
+
+    void clear(Accumulator& acc);
+
+};
+
+} // end namespace control
+
+} // end namespace tue
+
+#endif
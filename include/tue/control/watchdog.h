@@ -0,0 +1,97 @@
+#ifndef TUE_CONTROL_WATCHDOG_H_
+#define TUE_CONTROL_WATCHDOG_H_
+
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace tue
+{
+namespace control
+{
+
+class SupervisedController;
+
+// ----------------------------------------------------------------------------------------------------
+
+// Detects controllers that are no longer updated, or updated late, from a separate monitor thread.
+// Every update increments the (lock-free) heartbeat counter of the controller and stores its time,
+// and counts the interval since the previous update against the 'watchdog' settings of the
+// controller if it was late. The monitor thread polls the heartbeat times every period:
+//
+//     watchdog:
+//       budget: 0.0015     # a longer interval between updates counts as a late tick [s]
+//       timeout: 0.01      # without updates for this long, the watchdog trips [s]
+//       fallback: hold     # zero (default) or hold
+//       decay: 0.05        # time constant of the held output [s] (hold only)
+//
+// Once tripped, the controller reports ERROR, and the watchdog writes the fallback output into the
+// output slot of the controller (the value that is sent to the drive) until the controller is
+// updated again. The fallback only replaces the output the watchdog last read or wrote (compare
+// and swap), so it never overwrites an output that the real-time loop stored in the meantime.
+//
+// Late ticks are counted exactly; timeouts are detected with the resolution of the monitor
+// period, so the period should be well below the timeout.
+
+class Watchdog
+{
+
+public:
+
+    Watchdog();
+
+    ~Watchdog();
+
+    /// Adds a controller with a configured watchdog. The real-time loop stores the controller output
+    /// in 'output' after every update; the watchdog overwrites it with the fallback output once tripped.
+    void addController(const std::shared_ptr<SupervisedController>& controller, std::atomic<double>* output);
+
+    /// Starts the monitor thread. If priority > 0, the thread is given that SCHED_FIFO priority.
+    /// Returns false if the priority could not be set (the thread runs nevertheless).
+    bool start(double period, int priority = 0);
+
+    void stop();
+
+    /// Runs a single monitor cycle at steady clock time 'now' [s] (called by the monitor thread)
+    void check(double now);
+
+    unsigned int size() const { return entries_.size(); }
+
+    unsigned long late_ticks(unsigned int i) const;
+
+    unsigned long missed_ticks(unsigned int i) const;
+
+    bool tripped(unsigned int i) const { return entries_[i]->tripped.load(std::memory_order_relaxed); }
+
+private:
+
+    struct Entry
+    {
+        std::shared_ptr<SupervisedController> controller;
+        std::atomic<double>* output;
+
+        // Monitor thread only
+        unsigned long heartbeat;    // at the trip
+        double last_check;
+        double held_output;
+        double written_output;      // output last read or written by the monitor
+
+        std::atomic<bool> tripped;
+    };
+
+    std::vector<std::shared_ptr<Entry> > entries_;
+
+    std::thread thread_;
+
+    std::atomic<bool> running_;
+
+    void run(double period);
+
+};
+
+} // end namespace control
+
+} // end namespace tue
+
+#endif
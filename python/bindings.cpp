@@ -0,0 +1,230 @@
+#include <tue/control/controller_factory.h>
+#include <tue/control/supervised_controller.h>
+#include <tue/control/batch_simulation.h>
+
+#include <tue/control/generic_controller.h>
+#include <tue/control/setpoint_controller.h>
+#include <tue/control/gain_scheduled_controller.h>
+#include <tue/control/mpc_controller.h>
+
+#include <pybind11/pybind11.h>
+#include <pybind11/numpy.h>
+#include <pybind11/stl.h>
+
+#include <stdexcept>
+#include <string>
+
+namespace py = pybind11;
+
+using namespace tue::control;
+
+namespace
+{
+
+// Converts (without copying, if it already is one) to a C-contiguous double array
+typedef py::array_t<double, py::array::c_style | py::array::forcecast> Trace;
+
+// ----------------------------------------------------------------------------------------------------
+
+ControllerFactory* createFactory()
+{
+    ControllerFactory* factory = new ControllerFactory;
+    factory->registerControllerType<GenericController>("generic");
+    factory->registerControllerType<SetpointController>("setpoint");
+    factory->registerControllerType<GainScheduledController>("gain_scheduled");
+    factory->registerControllerType<MPCController>("mpc");
+    return factory;
+}
+
+// ----------------------------------------------------------------------------------------------------
+
+std::shared_ptr<SupervisedController> createController(const ControllerFactory& factory, const std::string& filename, double dt)
+{
+    tue::Configuration config;
+    config.loadFromYAMLFile(filename);
+
+    std::shared_ptr<SupervisedController> controller;
+    if (!config.hasError())
+        controller = factory.createController(config, dt);
+
+    if (config.hasError())
+        throw std::runtime_error(config.error());
+
+    return controller;
+}
+
+// ----------------------------------------------------------------------------------------------------
+
+std::vector<std::shared_ptr<SupervisedController> > createControllers(const ControllerFactory& factory,
+                                                                      const std::string& filename, double dt,
+                                                                      unsigned int num_threads)
+{
+    tue::Configuration config;
+    config.loadFromYAMLFile(filename);
+
+    std::vector<std::shared_ptr<SupervisedController> > controllers;
+    if (!config.hasError())
+    {
+        // Construction does not touch Python objects
+        py::gil_scoped_release release;
+        factory.createControllers(config, dt, controllers, num_threads);
+    }
+
+    if (config.hasError())
+        throw std::runtime_error(config.error());
+
+    return controllers;
+}
+
+// ----------------------------------------------------------------------------------------------------
+
+// Checks that the trace has shape (number of joints, num_ticks)
+void checkTrace(const BatchSimulation& sim, const Trace& trace, const char* name)
+{
+    if (trace.ndim() != 2 || static_cast<unsigned int>(trace.shape(0)) != sim.size())
+        throw std::invalid_argument(std::string(name) + " must have shape (number of controllers, number of ticks)");
+}
+
+// ----------------------------------------------------------------------------------------------------
+
+// BatchSimulation does not check the joint index, so a bad index from Python must be caught here
+void checkIndex(const BatchSimulation& sim, unsigned int i)
+{
+    if (i >= sim.size())
+        throw py::index_error("joint index " + std::to_string(i) + " out of range (" + std::to_string(sim.size()) + " controllers)");
+}
+
+// ----------------------------------------------------------------------------------------------------
+
+void setPlant(BatchSimulation& sim, unsigned int i, const BatchPlant& plant)
+{
+    checkIndex(sim, i);
+    sim.setPlant(i, plant);
+}
+
+// ----------------------------------------------------------------------------------------------------
+
+BatchPlant plant(const BatchSimulation& sim, unsigned int i)
+{
+    checkIndex(sim, i);
+    return sim.plant(i);
+}
+
+// ----------------------------------------------------------------------------------------------------
+
+py::tuple runOpenLoop(BatchSimulation& sim, const Trace& measurements)
+{
+    checkTrace(sim, measurements, "measurements");
+
+    unsigned int num_ticks = measurements.shape(1);
+    Trace outputs({ static_cast<py::ssize_t>(sim.size()), static_cast<py::ssize_t>(num_ticks) });
+    Trace errors({ static_cast<py::ssize_t>(sim.size()), static_cast<py::ssize_t>(num_ticks) });
+
+    const double* m = measurements.data();
+    double* o = outputs.mutable_data();
+    double* e = errors.mutable_data();
+
+    {
+        py::gil_scoped_release release;
+        sim.runOpenLoop(m, num_ticks, o, e);
+    }
+
+    return py::make_tuple(outputs, errors);
+}
+
+// ----------------------------------------------------------------------------------------------------
+
+py::tuple runClosedLoop(BatchSimulation& sim, unsigned int num_ticks, const py::object& references)
+{
+    Trace refs;
+    const double* r = 0;
+    if (!references.is_none())
+    {
+        refs = references.cast<Trace>();
+        checkTrace(sim, refs, "references");
+        if (static_cast<unsigned int>(refs.shape(1)) != num_ticks)
+            throw std::invalid_argument("references must have num_ticks columns");
+        r = refs.data();
+    }
+
+    Trace positions({ static_cast<py::ssize_t>(sim.size()), static_cast<py::ssize_t>(num_ticks) });
+    Trace outputs({ static_cast<py::ssize_t>(sim.size()), static_cast<py::ssize_t>(num_ticks) });
+
+    double* p = positions.mutable_data();
+    double* o = outputs.mutable_data();
+
+    {
+        py::gil_scoped_release release;
+        sim.runClosedLoop(r, num_ticks, p, o);
+    }
+
+    return py::make_tuple(positions, outputs);
+}
+
+} // end anonymous namespace
+
+// ----------------------------------------------------------------------------------------------------
+
+PYBIND11_MODULE(tue_control, m)
+{
+    m.doc() = "Joint controllers, and batch simulation for offline analysis";
+
+    py::enum_<ControllerStatus>(m, "ControllerStatus")
+        .value("UNINITIALIZED", UNINITIALIZED)
+        .value("HOMING", HOMING)
+        .value("ACTIVE", ACTIVE)
+        .value("IDLE", IDLE)
+        .value("ERROR", ERROR);
+
+    // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+    py::class_<SupervisedController, std::shared_ptr<SupervisedController> >(m, "SupervisedController")
+        .def("update", (void (SupervisedController::*)(double)) &SupervisedController::update, py::arg("measurement"))
+        .def("update", (void (SupervisedController::*)(double, double)) &SupervisedController::update,
+             py::arg("measurement"), py::arg("timestamp"))
+        .def("set_reference", &SupervisedController::setReference, py::arg("pos"), py::arg("vel") = 0, py::arg("acc") = 0)
+        .def("start_homing", &SupervisedController::startHoming)
+        .def("stop_homing", &SupervisedController::stopHoming, py::arg("current_pos"))
+        .def("enable", &SupervisedController::enable)
+        .def("disable", &SupervisedController::disable)
+        .def("set_error", &SupervisedController::setError, py::arg("error_msg"))
+        .def_property_readonly("name", &SupervisedController::name)
+        .def_property_readonly("status", &SupervisedController::status)
+        .def_property_readonly("error_message", &SupervisedController::error_message)
+        .def_property_readonly("output", &SupervisedController::output)
+        .def_property_readonly("output_clamp", &SupervisedController::output_clamp)
+        .def_property_readonly("error", &SupervisedController::error)
+        .def_property_readonly("measurement", &SupervisedController::measurement)
+        .def_property_readonly("is_homed", &SupervisedController::is_homed)
+        .def_property_readonly("dt", &SupervisedController::dt);
+
+    // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+    py::class_<ControllerFactory>(m, "ControllerFactory")
+        .def(py::init(&createFactory))
+        .def("create_controller", &createController, py::arg("filename"), py::arg("dt"),
+             "Creates a controller from a YAML file; raises RuntimeError on configuration errors")
+        .def("create_controllers", &createControllers, py::arg("filename"), py::arg("dt"), py::arg("num_threads") = 0,
+             "Creates the controllers in the 'controllers' array of a YAML file");
+
+    // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+    py::class_<BatchPlant>(m, "BatchPlant")
+        .def(py::init<>())
+        .def_readwrite("mass", &BatchPlant::mass)
+        .def_readwrite("damping", &BatchPlant::damping)
+        .def_readwrite("position", &BatchPlant::position)
+        .def_readwrite("velocity", &BatchPlant::velocity);
+
+    py::class_<BatchSimulation>(m, "BatchSimulation")
+        .def(py::init<>())
+        .def("add_controller", &BatchSimulation::addController, py::arg("controller"))
+        .def("set_num_threads", &BatchSimulation::setNumThreads, py::arg("num_threads"))
+        .def("set_plant", &setPlant, py::arg("i"), py::arg("plant"))
+        .def("plant", &plant, py::arg("i"))
+        .def("__len__", &BatchSimulation::size)
+        .def("run_open_loop", &runOpenLoop, py::arg("measurements"),
+             "Updates the controllers with a (controllers x ticks) measurement array; returns (outputs, errors)")
+        .def("run_closed_loop", &runClosedLoop, py::arg("num_ticks"), py::arg("references") = py::none(),
+             "Updates the controllers in closed loop with their plants; returns (positions, outputs)");
+}
@@ -0,0 +1,142 @@
+#!/usr/bin/env python3
+"""
+Checks the tue_control module against the controllers updated one by one from Python.
+
+    PYTHONPATH=<build directory> python3 python/test_bindings.py test/test_batch_simulation.yaml
+"""
+
+from __future__ import print_function
+
+import sys
+import time
+
+import numpy as np
+
+import tue_control
+
+NUM_JOINTS = 6
+NUM_TICKS = 2000
+
+
+def create(factory, filename, dt):
+    """Returns NUM_JOINTS enabled controllers"""
+    controllers = []
+    for _ in range(NUM_JOINTS):
+        c = factory.create_controller(filename, dt)
+        c.enable()
+        c.update(0)
+        controllers.append(c)
+    return controllers
+
+
+def plant(j):
+    p = tue_control.BatchPlant()
+    p.mass = 1 + 0.05 * j
+    p.damping = 2 + 0.1 * j
+    return p
+
+
+def simulation(controllers, num_threads):
+    sim = tue_control.BatchSimulation()
+    for j, c in enumerate(controllers):
+        sim.add_controller(c)
+        sim.set_plant(j, plant(j))
+    sim.set_num_threads(num_threads)
+    return sim
+
+
+def main():
+    if len(sys.argv) != 2:
+        print("Please provide config file", file=sys.stderr)
+        return 1
+
+    filename = sys.argv[1]
+    dt = 0.001
+    factory = tue_control.ControllerFactory()
+
+    t = np.arange(NUM_TICKS) * dt
+    references = np.array([(0.1 + 0.002 * j) * np.sin(2 * np.pi * (0.1 + 0.01 * j) * t) for j in range(NUM_JOINTS)])
+
+    # - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+    # Reference: closed and open loop, one controller and tick at a time
+
+    positions = np.zeros((NUM_JOINTS, NUM_TICKS))
+    outputs = np.zeros((NUM_JOINTS, NUM_TICKS))
+    for j, c in enumerate(create(factory, filename, dt)):
+        p = plant(j)
+        for k in range(NUM_TICKS):
+            c.set_reference(references[j, k])
+            c.update(p.position)
+            acc = (c.output - p.damping * p.velocity) / p.mass
+            p.velocity += dt * acc
+            p.position += dt * p.velocity
+            positions[j, k] = p.position
+            outputs[j, k] = c.output
+
+    open_outputs = np.zeros((NUM_JOINTS, NUM_TICKS))
+    open_errors = np.zeros((NUM_JOINTS, NUM_TICKS))
+    for j, c in enumerate(create(factory, filename, dt)):
+        for k in range(NUM_TICKS):
+            c.update(positions[j, k])
+            open_outputs[j, k] = c.output
+            open_errors[j, k] = c.error
+
+    # - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+    # Batch runs must match exactly, for any number of threads and memory layout of the input
+
+    ok = True
+    for num_threads in [1, 4]:
+        sim = simulation(create(factory, filename, dt), num_threads)
+        start = time.time()
+        p, o = sim.run_closed_loop(NUM_TICKS, references)
+        duration = time.time() - start
+        same = p.shape == (NUM_JOINTS, NUM_TICKS) and np.array_equal(p, positions) and np.array_equal(o, outputs)
+        ok = ok and same
+        print("Closed loop, %d threads: %.3f ms, traces %s" % (num_threads, 1000 * duration, "equal" if same else "DIFFERENT"))
+
+        # Fortran order is converted to the row-major layout of the C++ traces
+        sim = simulation(create(factory, filename, dt), num_threads)
+        o, e = sim.run_open_loop(np.asfortranarray(positions))
+        same = np.array_equal(o, open_outputs) and np.array_equal(e, open_errors)
+        ok = ok and same
+        print("Open loop,   %d threads: traces %s" % (num_threads, "equal" if same else "DIFFERENT"))
+
+    # - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+    # Errors are raised as Python exceptions
+
+    sim = simulation(create(factory, filename, dt), 1)
+    for run in [lambda: sim.run_open_loop(np.zeros((NUM_JOINTS + 1, 10))),
+               lambda: sim.run_open_loop(np.zeros(10)),
+               lambda: sim.run_closed_loop(10, np.zeros((NUM_JOINTS, 11)))]:
+        try:
+            run()
+            print("Wrong trace shape was accepted", file=sys.stderr)
+            ok = False
+        except ValueError:
+            pass
+
+    for run in [lambda: sim.set_plant(NUM_JOINTS, tue_control.BatchPlant()),
+               lambda: sim.plant(NUM_JOINTS)]:
+        try:
+            run()
+            print("Joint index out of range was accepted", file=sys.stderr)
+            ok = False
+        except IndexError:
+            pass
+
+    try:
+        factory.create_controller(filename + ".does_not_exist", dt)
+        print("Missing configuration file was accepted", file=sys.stderr)
+        ok = False
+    except RuntimeError:
+        pass
+
+    if not ok:
+        print("Batch simulation does not match the controllers updated one by one", file=sys.stderr)
+        return 1
+
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
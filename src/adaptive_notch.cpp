@@ -0,0 +1,174 @@
+#include "tue/control/adaptive_notch.h"
+
+namespace tue
+{
+namespace control
+{
+
+// ----------------------------------------------------------------------------------------------------
+
+AdaptiveNotch::AdaptiveNotch() : dt_(0), dz_(0), dp_(0), frequency_(0), num_bins_(0), forgetting_(1),
+    update_interval_(1), count_(0), min_peak_ratio_(0), adaptation_(1)
+{
+    coefficients_ = unityFilter();
+}
+
+// ----------------------------------------------------------------------------------------------------
+
+AdaptiveNotch::~AdaptiveNotch()
+{
+}
+
+// ----------------------------------------------------------------------------------------------------
+
+void AdaptiveNotch::configure(tue::Configuration& config, double dt)
+{
+    dt_ = dt;
+    num_bins_ = 0;
+
+    // Only the errors of these parameters count (the configuration may have unrelated errors already)
+    double f_min, f_max;
+    bool valid = config.value("frequency", frequency_) & config.value("min_frequency", f_min)
+            & config.value("max_frequency", f_max) & config.value("dz", dz_) & config.value("dp", dp_);
+
+    int num_bins = 16;
+    int update_interval = 100;
+    forgetting_ = 0.999;
+    min_peak_ratio_ = 4;
+    adaptation_ = 0.3;
+
+    config.value("bins", num_bins, tue::OPTIONAL);
+    config.value("forgetting", forgetting_, tue::OPTIONAL);
+    config.value("update_interval", update_interval, tue::OPTIONAL);
+    config.value("min_peak_ratio", min_peak_ratio_, tue::OPTIONAL);
+    config.value("adaptation", adaptation_, tue::OPTIONAL);
+
+    if (!valid)
+        return;
+
+    if (f_min <= 0 || f_max <= f_min || f_max >= 0.5 / dt)
+    {
+        config.addError("adaptive_notch: 0 < min_frequency < max_frequency < Nyquist frequency");
+        valid = false;
+    }
+
+    if (dz_ < 0 || dp_ <= 0)
+    {
+        config.addError("adaptive_notch: dz < 0 || dp <= 0");
+        valid = false;
+    }
+
+    if (num_bins < 3 || num_bins > static_cast<int>(MAX_BINS))
+    {
+        config.addError("adaptive_notch: bins must be in [3, MAX_BINS]");
+        valid = false;
+    }
+
+    if (forgetting_ <= 0 || forgetting_ >= 1 || update_interval < 1 || adaptation_ <= 0 || adaptation_ > 1)
+    {
+        config.addError("adaptive_notch: forgetting must be in (0, 1), update_interval >= 1, adaptation in (0, 1]");
+        valid = false;
+    }
+
+    if (!valid)
+        return;
+
+    num_bins_ = num_bins;
+    update_interval_ = update_interval;
+    count_ = 0;
+
+    for(unsigned int i = 0; i < num_bins_; ++i)
+    {
+        bins_[i].setFrequency(f_min + i * (f_max - f_min) / (num_bins_ - 1), dt);
+        bins_[i].reset();
+    }
+
+    coefficients_ = skewedNotch(frequency_, dz_, frequency_, dp_, dt_);
+    state_ = FilterState();
+}
+
+// ----------------------------------------------------------------------------------------------------
+
+double AdaptiveNotch::update(double x, double error)
+{
+    for(unsigned int i = 0; i < num_bins_; ++i)
+        bins_[i].update(error, forgetting_);
+
+    if (++count_ >= update_interval_)
+    {
+        count_ = 0;
+        retune();
+    }
+
+    return updateFilter(coefficients_, state_, x);
+}
+
+// ----------------------------------------------------------------------------------------------------
+
+void AdaptiveNotch::saveState(double* state) const
+{
+    state[0] = frequency_;
+    state[1] = state_.z1;
+    state[2] = state_.z2;
+}
+
+// ----------------------------------------------------------------------------------------------------
+
+void AdaptiveNotch::restoreState(const double* state)
+{
+    frequency_ = state[0];
+    coefficients_ = skewedNotch(frequency_, dz_, frequency_, dp_, dt_);
+    state_.z1 = state[1];
+    state_.z2 = state[2];
+}
+
+// ----------------------------------------------------------------------------------------------------
+
+void AdaptiveNotch::retune()
+{
+    // Find the peak bin
+    unsigned int i_max = 0;
+    double p_max = 0;
+    double p_sum = 0;
+    for(unsigned int i = 0; i < num_bins_; ++i)
+    {
+        double p = bins_[i].power();
+        p_sum += p;
+        if (p > p_max)
+        {
+            p_max = p;
+            i_max = i;
+        }
+    }
+
+    if (p_max == 0 || p_max < min_peak_ratio_ * p_sum / num_bins_)
+        return;
+
+    // Refine the peak by parabolic interpolation of the magnitudes of the neighbouring bins
+    double f_peak = bins_[i_max].frequency;
+    if (i_max > 0 && i_max + 1 < num_bins_)
+    {
+        double m0 = std::sqrt(bins_[i_max - 1].power());
+        double m1 = std::sqrt(p_max);
+        double m2 = std::sqrt(bins_[i_max + 1].power());
+
+        double denom = m0 - 2 * m1 + m2;
+        if (denom < 0)
+        {
+            double delta = 0.5 * (m0 - m2) / denom;
+            f_peak += delta * (bins_[1].frequency - bins_[0].frequency);
+        }
+    }
+
+    frequency_ += adaptation_ * (f_peak - frequency_);
+
+    // Retune in place; the filter state is kept
+    coefficients_ = skewedNotch(frequency_, dz_, frequency_, dp_, dt_);
+}
+
+// ----------------------------------------------------------------------------------------------------
+
+} // end namespace control
+
+} // end namespace tue
+
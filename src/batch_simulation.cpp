@@ -0,0 +1,133 @@
+#include "tue/control/batch_simulation.h"
+
+#include "tue/control/supervised_controller.h"
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+
+namespace tue
+{
+namespace control
+{
+
+// ----------------------------------------------------------------------------------------------------
+
+BatchSimulation::BatchSimulation() : num_threads_(0)
+{
+}
+
+// ----------------------------------------------------------------------------------------------------
+
+BatchSimulation::~BatchSimulation()
+{
+}
+
+// ----------------------------------------------------------------------------------------------------
+
+void BatchSimulation::addController(const std::shared_ptr<SupervisedController>& controller)
+{
+    controllers_.push_back(controller);
+    plants_.push_back(BatchPlant());
+}
+
+// ----------------------------------------------------------------------------------------------------
+
+void BatchSimulation::runOpenLoop(const double* measurements, unsigned int num_ticks, double* outputs, double* errors)
+{
+    run(measurements, 0, num_ticks, 0, outputs, errors, false);
+}
+
+// ----------------------------------------------------------------------------------------------------
+
+void BatchSimulation::runClosedLoop(const double* references, unsigned int num_ticks, double* positions, double* outputs)
+{
+    run(0, references, num_ticks, positions, outputs, 0, true);
+}
+
+// ----------------------------------------------------------------------------------------------------
+
+void BatchSimulation::run(const double* measurements, const double* references, unsigned int num_ticks,
+                          double* positions, double* outputs, double* errors, bool closed_loop)
+{
+    if (controllers_.empty())
+        return;
+
+    unsigned int num_threads = num_threads_;
+    if (num_threads == 0)
+        num_threads = std::max(1u, std::thread::hardware_concurrency());
+
+    num_threads = std::min<unsigned int>(num_threads, controllers_.size());
+
+    // Every worker takes the next unprocessed joint and runs all its ticks
+    std::atomic<unsigned int> next(0);
+
+    struct Worker
+    {
+        static void run(BatchSimulation* sim, std::atomic<unsigned int>* next, const double* measurements,
+                        const double* references, unsigned int num_ticks, double* positions, double* outputs,
+                        double* errors, bool closed_loop)
+        {
+            for(unsigned int j = (*next)++; j < sim->controllers_.size(); j = (*next)++)
+                sim->runJoint(j, measurements, references, num_ticks, positions, outputs, errors, closed_loop);
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for(unsigned int i = 1; i < num_threads; ++i)
+        threads.push_back(std::thread(Worker::run, this, &next, measurements, references, num_ticks,
+                                      positions, outputs, errors, closed_loop));
+
+    // This thread works along
+    Worker::run(this, &next, measurements, references, num_ticks, positions, outputs, errors, closed_loop);
+
+    for(std::vector<std::thread>::iterator it = threads.begin(); it != threads.end(); ++it)
+        it->join();
+}
+
+// ----------------------------------------------------------------------------------------------------
+
+void BatchSimulation::runJoint(unsigned int j, const double* measurements, const double* references,
+                               unsigned int num_ticks, double* positions, double* outputs, double* errors,
+                               bool closed_loop)
+{
+    SupervisedController& c = *controllers_[j];
+    BatchPlant& plant = plants_[j];
+
+    double dt = c.dt();
+
+    for(unsigned int t = 0; t < num_ticks; ++t)
+    {
+        unsigned long k = static_cast<unsigned long>(j) * num_ticks + t;
+
+        if (!closed_loop)
+        {
+            c.update(measurements[k]);
+            outputs[k] = c.output();
+            if (errors)
+                errors[k] = c.error();
+            continue;
+        }
+
+        if (references && c.accepts_references())
+            c.setReference(references[k]);
+
+        c.update(plant.position);
+
+        double output = c.output();
+        double force = is_set(output) ? output : 0;
+
+        double acc = (force - plant.damping * plant.velocity) / plant.mass;
+        plant.velocity += dt * acc;
+        plant.position += dt * plant.velocity;
+
+        positions[k] = plant.position;
+        outputs[k] = output;
+    }
+}
+
+// ----------------------------------------------------------------------------------------------------
+
+} // end namespace control
+
+} // end namespace tue
@@ -0,0 +1,200 @@
+#include "tue/control/checkpointer.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace tue
+{
+namespace control
+{
+
+// ----------------------------------------------------------------------------------------------------
+
+Checkpointer::Checkpointer() : buffer_(0), interval_(1), ticks_(0)
+{
+}
+
+// ----------------------------------------------------------------------------------------------------
+
+Checkpointer::~Checkpointer()
+{
+    close();
+}
+
+// ----------------------------------------------------------------------------------------------------
+
+void Checkpointer::addController(const std::shared_ptr<SupervisedController>& controller)
+{
+    controllers_.push_back(controller);
+}
+
+// ----------------------------------------------------------------------------------------------------
+
+bool Checkpointer::open(const std::string& name, unsigned int interval)
+{
+    close();
+
+    if (controllers_.size() > MAX_CHECKPOINT_CONTROLLERS)
+    {
+        error_msg_ = "Too many controllers (more than MAX_CHECKPOINT_CONTROLLERS)";
+        return false;
+    }
+
+    interval_ = interval > 0 ? interval : 1;
+    ticks_ = 0;
+
+    int fd = shm_open(("/" + name).c_str(), O_RDWR | O_CREAT, 0600);
+    if (fd < 0)
+    {
+        error_msg_ = "Could not open shared memory '" + name + "'";
+        return false;
+    }
+
+    // A new segment is zero-filled, i.e., contains no checkpoint (sequence 0)
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (st.st_size != sizeof(CheckpointBuffer) && ftruncate(fd, sizeof(CheckpointBuffer)) != 0))
+    {
+        ::close(fd);
+        error_msg_ = "Could not size shared memory '" + name + "'";
+        return false;
+    }
+
+    void* p = mmap(0, sizeof(CheckpointBuffer), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+
+    if (p == MAP_FAILED)
+    {
+        error_msg_ = "Could not map shared memory '" + name + "'";
+        return false;
+    }
+
+    buffer_ = static_cast<CheckpointBuffer*>(p);
+
+    return true;
+}
+
+// ----------------------------------------------------------------------------------------------------
+
+void Checkpointer::close()
+{
+    if (buffer_)
+    {
+        munmap(buffer_, sizeof(CheckpointBuffer));
+        buffer_ = 0;
+    }
+}
+
+// ----------------------------------------------------------------------------------------------------
+
+void Checkpointer::write()
+{
+    if (!buffer_)
+        return;
+
+    // Only this writer changes the sequence, so it is even here, unless a previous writer died while
+    // writing a set. That set is then written again, into the same slot.
+    unsigned long sequence = buffer_->sequence.load(std::memory_order_relaxed) & ~1UL;
+    unsigned int index = (sequence / 2 + 1) & 1;
+
+    // Mark the slot as being written before any of it is changed
+    buffer_->sequence.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    ControllerCheckpoint* slot = buffer_->slots[index];
+    for(unsigned int i = 0; i < controllers_.size(); ++i)
+    {
+        // A controller of which the state does not fit is not checkpointed, so restore will fail
+        if (!controllers_[i]->saveCheckpoint(slot[i]))
+            slot[i].name[0] = '\0';
+    }
+
+    buffer_->num_controllers[index] = controllers_.size();
+
+    // Publish
+    buffer_->sequence.store(sequence + 2, std::memory_order_release);
+}
+
+// ----------------------------------------------------------------------------------------------------
+
+bool Checkpointer::restore()
+{
+    if (!buffer_)
+    {
+        error_msg_ = "Not opened";
+        return false;
+    }
+
+    std::vector<ControllerCheckpoint> checkpoints(controllers_.size());
+
+    // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+    // Copy the latest checkpoint set. The writer may fill the other slot in the meantime, but if it
+    // started the set after that (which overwrites this slot), the copy may be torn: retry.
+
+    bool consistent = false;
+    unsigned int num_controllers = 0;
+    for(unsigned int attempt = 0; attempt < 100 && !consistent; ++attempt)
+    {
+        unsigned long sequence = buffer_->sequence.load(std::memory_order_acquire);
+        unsigned long set = sequence / 2;
+        if (set == 0)
+        {
+            error_msg_ = "No checkpoint available";
+            return false;
+        }
+
+        unsigned int index = set & 1;
+        num_controllers = buffer_->num_controllers[index];
+
+        const ControllerCheckpoint* slot = buffer_->slots[index];
+        for(unsigned int i = 0; i < controllers_.size(); ++i)
+            checkpoints[i] = slot[i];
+
+        // The copy must be complete before the sequence is checked again
+        std::atomic_thread_fence(std::memory_order_acquire);
+        consistent = (buffer_->sequence.load(std::memory_order_relaxed) <= 2 * set + 2);
+    }
+
+    if (!consistent)
+    {
+        error_msg_ = "Could not read a consistent checkpoint";
+        return false;
+    }
+
+    if (num_controllers != controllers_.size())
+    {
+        error_msg_ = "Checkpoint contains a different number of controllers";
+        return false;
+    }
+
+    // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+    // Restore (all or nothing)
+
+    for(unsigned int i = 0; i < controllers_.size(); ++i)
+    {
+        if (!controllers_[i]->matchesCheckpoint(checkpoints[i]))
+        {
+            error_msg_ = "Checkpoint does not match controller '" + controllers_[i]->name() + "'";
+            return false;
+        }
+    }
+
+    for(unsigned int i = 0; i < controllers_.size(); ++i)
+        controllers_[i]->restoreCheckpoint(checkpoints[i]);
+
+    return true;
+}
+
+// ----------------------------------------------------------------------------------------------------
+
+unsigned long Checkpointer::sequence() const
+{
+    return buffer_ ? buffer_->sequence.load(std::memory_order_acquire) / 2 : 0;
+}
+
+// ----------------------------------------------------------------------------------------------------
+
+} // end namespace control
+
+} // end namespace tue
@@ -2,6 +2,10 @@
 
 #include "tue/control/controller.h"
 #include "tue/control/supervised_controller.h"
+#include "tue/control/smith_predictor.h"
+
+#include <atomic>
+#include <thread>
 
 namespace tue
 {
@@ -38,31 +42,139 @@ std::shared_ptr<SupervisedController> ControllerFactory::createController(tue::C
     // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
     // Create controller core from given type
 
-    std::map<std::string, t_controller_creator>::const_iterator it = controller_types_.find(type);
+    std::map<std::string, ControllerType>::const_iterator it = controller_types_.find(type);
     if (it == controller_types_.end())
     {
         config.addError("Unknown controller type: '" + type + "'");
         return supervised_controller;
     }
 
-    std::shared_ptr<Controller> c = it->second();
+    bool delay_compensation = config.readGroup("delay_compensation");
+    if (delay_compensation)
+        config.endGroup();
+
+    supervised_controller.reset(new SupervisedController);
+
+    // Closed set types are stored inline, unless they are wrapped
+    std::shared_ptr<Controller> c;
+    Controller* core = 0;
+
+    if (it->second.inline_type != INLINE_NONE && !delay_compensation)
+        core = supervised_controller->emplaceController(it->second.inline_type);
+    else
+    {
+        c = it->second.create();
+        core = c.get();
+    }
 
     // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
     // Configure controller core
 
-    c->configure(config, dt);
-    c->setName(name);
+    core->configure(config, dt);
+    core->setName(name);
+
+    // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+    // Optionally wrap controller core in delay compensation
+
+    if (delay_compensation && config.readGroup("delay_compensation"))
+    {
+        std::shared_ptr<SmithPredictor> smith_predictor = std::make_shared<SmithPredictor>();
+        smith_predictor->setController(c);
+        smith_predictor->configure(config, dt);
+        smith_predictor->setName(name);
+        config.endGroup();
+
+        c = smith_predictor;
+    }
 
     // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
     // Wrap controller in supervised controller, and configure it
 
-    supervised_controller.reset(new SupervisedController);
-    supervised_controller->setController(c);
+    if (c)
+        supervised_controller->setController(c);
+
     supervised_controller->configure(config, dt);
 
     return supervised_controller;
 }
 
+// ----------------------------------------------------------------------------------------------------
+
+bool ControllerFactory::createControllers(tue::Configuration& config, double dt,
+                                          std::vector<std::shared_ptr<SupervisedController> >& controllers,
+                                          unsigned int num_threads) const
+{
+    // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+    // Collect the configuration of every controller (serial; reading the array moves the reader)
+
+    std::vector<tue::Configuration> configs;
+
+    if (config.readArray("controllers", tue::REQUIRED))
+    {
+        while(config.nextArrayItem())
+            configs.push_back(config.limitScope());
+
+        config.endArray();
+    }
+
+    controllers.assign(configs.size(), std::shared_ptr<SupervisedController>());
+
+    if (configs.empty())
+        return !config.hasError();
+
+    // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+    // Validate and construct in parallel. Every worker takes the next unprocessed controller; each
+    // controller has its own (scoped) configuration and result slot, so no locking is needed.
+
+    if (num_threads == 0)
+        num_threads = std::max(1u, std::thread::hardware_concurrency());
+
+    num_threads = std::min<unsigned int>(num_threads, configs.size());
+
+    std::atomic<unsigned int> next(0);
+
+    struct Worker
+    {
+        static void run(const ControllerFactory* factory, std::vector<tue::Configuration>* configs, double dt,
+                        std::vector<std::shared_ptr<SupervisedController> >* controllers, std::atomic<unsigned int>* next)
+        {
+            for(unsigned int i = (*next)++; i < configs->size(); i = (*next)++)
+                (*controllers)[i] = factory->createController((*configs)[i], dt);
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for(unsigned int i = 1; i < num_threads; ++i)
+        threads.push_back(std::thread(Worker::run, this, &configs, dt, &controllers, &next));
+
+    // This thread works along
+    Worker::run(this, &configs, dt, &controllers, &next);
+
+    for(std::vector<std::thread>::iterator it = threads.begin(); it != threads.end(); ++it)
+        it->join();
+
+    // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+    // Aggregate errors, in configuration order
+
+    bool ok = true;
+    for(unsigned int i = 0; i < configs.size(); ++i)
+    {
+        if (configs[i].hasError())
+        {
+            config.addError(configs[i].error());
+            controllers[i].reset();
+            ok = false;
+        }
+        else if (!controllers[i])
+        {
+            config.addError("Controller without name or type");
+            ok = false;
+        }
+    }
+
+    return ok;
+}
+
 } // end namespace tue
 
 } // end namespace control
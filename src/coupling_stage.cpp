@@ -0,0 +1,177 @@
+#include "tue/control/coupling_stage.h"
+
+#include "tue/control/supervised_controller.h"
+
+#include <sstream>
+
+namespace tue
+{
+namespace control
+{
+
+// ----------------------------------------------------------------------------------------------------
+
+CouplingStage::CouplingStage() : size_(0), mat_vec_(0)
+{
+}
+
+// ----------------------------------------------------------------------------------------------------
+
+CouplingStage::~CouplingStage()
+{
+}
+
+// ----------------------------------------------------------------------------------------------------
+
+void CouplingStage::configure(tue::Configuration& config, const std::vector<std::shared_ptr<SupervisedController> >& controllers)
+{
+    controllers_.clear();
+    size_ = 0;
+    mat_vec_ = 0;
+
+    std::vector<std::string> measurement_rows, output_rows;
+
+    // Only the errors of the coupling count (the configuration may have unrelated errors already)
+    bool valid = true;
+
+    if (config.readArray("coupling", tue::REQUIRED))
+    {
+        while(config.nextArrayItem())
+        {
+            std::string joint;
+            if (!config.value("joint", joint))
+            {
+                valid = false;
+                continue;
+            }
+
+            std::shared_ptr<SupervisedController> c;
+            for(std::vector<std::shared_ptr<SupervisedController> >::const_iterator it = controllers.begin(); it != controllers.end(); ++it)
+            {
+                if (*it && (*it)->name() == joint)
+                {
+                    c = *it;
+                    break;
+                }
+            }
+
+            if (!c)
+            {
+                config.addError("Unknown joint: '" + joint + "'");
+                valid = false;
+                continue;
+            }
+
+            std::string measurement_row, output_row;
+            config.value("measurement", measurement_row);
+            config.value("output", output_row, tue::OPTIONAL);
+
+            controllers_.push_back(c);
+            measurement_rows.push_back(measurement_row);
+            output_rows.push_back(output_row);
+        }
+
+        config.endArray();
+    }
+
+    unsigned int n = controllers_.size();
+    if (n == 0 || n > MAX_MATRIX_SIZE)
+    {
+        std::stringstream s;
+        s << "Coupling must contain between 1 and " << MAX_MATRIX_SIZE << " joints";
+        config.addError(s.str());
+        return;
+    }
+
+    // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+    // Parse the transformation matrices
+
+    for(unsigned int i = 0; i < n; ++i)
+    {
+        if (!parseRow(measurement_rows[i], n, measurement_transform_ + i * n))
+        {
+            config.addError("Joint '" + controllers_[i]->name() + "': measurement row must contain one value per joint");
+            valid = false;
+        }
+
+        if (output_rows[i].empty())
+        {
+            for(unsigned int j = 0; j < n; ++j)
+                output_transform_[i * n + j] = (i == j ? 1 : 0);
+        }
+        else if (!parseRow(output_rows[i], n, output_transform_ + i * n))
+        {
+            config.addError("Joint '" + controllers_[i]->name() + "': output row must contain one value per joint");
+            valid = false;
+        }
+    }
+
+    if (!valid)
+    {
+        controllers_.clear();
+        return;
+    }
+
+    for(unsigned int i = 0; i < n; ++i)
+    {
+        joint_measurements_[i] = INVALID_DOUBLE;
+        joint_outputs_[i] = 0;
+    }
+
+    size_ = n;
+    mat_vec_ = matVecKernel(n);
+}
+
+// ----------------------------------------------------------------------------------------------------
+
+void CouplingStage::update(const double* motor_measurements, double* motor_outputs)
+{
+    if (size_ == 0)
+        return;
+
+    // Motor space -> joint space
+    transform(measurement_transform_, motor_measurements, joint_measurements_);
+
+    for(unsigned int i = 0; i < size_; ++i)
+    {
+        SupervisedController& c = *controllers_[i];
+        c.update(joint_measurements_[i]);
+        joint_outputs_[i] = c.output();
+    }
+
+    // Joint space -> motor space
+    transform(output_transform_, joint_outputs_, motor_outputs);
+}
+
+// ----------------------------------------------------------------------------------------------------
+
+void CouplingStage::transform(const double* A, const double* x, double* y) const
+{
+    bool all_set = true;
+    for(unsigned int j = 0; j < size_; ++j)
+        all_set &= is_set(x[j]);
+
+    if (all_set)
+    {
+        mat_vec_(A, x, y);
+        return;
+    }
+
+    // Skip the zero coefficients, since 0 * INVALID_DOUBLE would invalidate every row
+    for(unsigned int i = 0; i < size_; ++i)
+    {
+        const double* row = A + i * size_;
+        double sum = 0;
+        for(unsigned int j = 0; j < size_; ++j)
+            if (row[j] != 0)
+                sum += row[j] * x[j];
+        y[i] = sum;
+    }
+}
+
+// ----------------------------------------------------------------------------------------------------
+
+} // end namespace control
+
+} // end namespace tue
+
@@ -0,0 +1,210 @@
+#include "tue/control/discrete_filter.h"
+
+#include <cmath>
+
+namespace tue
+{
+namespace control
+{
+
+// ----------------------------------------------------------------------------------------------------
+
+FilterCoefficients unityFilter()
+{
+    FilterCoefficients c;
+    c.b0 = 1;
+    c.b1 = c.b2 = c.a1 = c.a2 = 0;
+    return c;
+}
+
+// ----------------------------------------------------------------------------------------------------
+
+FilterCoefficients discretize(double n2, double n1, double n0, double d2, double d1, double d0, double dt)
+{
+    double K = 2 / dt;
+    double K2 = K * K;
+
+    double a0 = d2 * K2 + d1 * K + d0;
+
+    FilterCoefficients c;
+    c.b0 = (n2 * K2 + n1 * K + n0) / a0;
+    c.b1 = (2 * n0 - 2 * n2 * K2) / a0;
+    c.b2 = (n2 * K2 - n1 * K + n0) / a0;
+    c.a1 = (2 * d0 - 2 * d2 * K2) / a0;
+    c.a2 = (d2 * K2 - d1 * K + d0) / a0;
+    return c;
+}
+
+// ----------------------------------------------------------------------------------------------------
+
+FilterCoefficients weakIntegrator(double fz, double dt)
+{
+    double wz = 2 * M_PI * fz;
+    return discretize(0, 1, wz, 0, 1, 0, dt);
+}
+
+// ----------------------------------------------------------------------------------------------------
+
+FilterCoefficients leadLag(double fz, double fp, double dt)
+{
+    double wz = 2 * M_PI * fz;
+    double wp = 2 * M_PI * fp;
+    return discretize(0, 1 / wz, 1, 0, 1 / wp, 1, dt);
+}
+
+// ----------------------------------------------------------------------------------------------------
+
+FilterCoefficients skewedNotch(double fz, double dz, double fp, double dp, double dt)
+{
+    double wz = 2 * M_PI * fz;
+    double wp = 2 * M_PI * fp;
+    return discretize(1 / (wz * wz), 2 * dz / wz, 1, 1 / (wp * wp), 2 * dp / wp, 1, dt);
+}
+
+// ----------------------------------------------------------------------------------------------------
+
+FilterCoefficients secondOrderLowPass(double fp, double dp, double dt)
+{
+    double wp = 2 * M_PI * fp;
+    return discretize(0, 0, wp * wp, 1, 2 * dp * wp, wp * wp, dt);
+}
+
+// ----------------------------------------------------------------------------------------------------
+
+void configureFilterChain(tue::Configuration& config, FilterChainParameters& p)
+{
+    p = FilterChainParameters();
+
+    if (config.readGroup("weak_integrator"))
+    {
+        double fz;
+        config.value("fz", fz);
+
+        if (fz < 0)
+            config.addError("fz < 0");
+
+        p.stage[WEAK_INTEGRATOR].active = true;
+        p.stage[WEAK_INTEGRATOR].p[0] = fz;
+
+        config.endGroup();
+    }
+
+    if (config.readGroup("lead_lag"))
+    {
+        double fz, fp;
+        config.value("fz", fz);
+        config.value("fp", fp);
+
+        if (fz < 0 || fp < 0)
+            config.addError("fz < 0 || fp < 0");
+
+        p.stage[LEAD_LAG].active = true;
+        p.stage[LEAD_LAG].p[0] = fz;
+        p.stage[LEAD_LAG].p[1] = fp;
+
+        config.endGroup();
+    }
+
+    if (config.readGroup("skewed_notch"))
+    {
+        double fz, dz, fp, dp;
+        config.value("fz", fz);
+        config.value("dz", dz);
+        config.value("fp", fp);
+        config.value("dp", dp);
+
+        if (fz < 0 || dz < 0 || fp < 0 || dp < 0)
+            config.addError("fz < 0 || dz < 0 || fp < 0 || dp < 0");
+
+        p.stage[SKEWED_NOTCH].active = true;
+        p.stage[SKEWED_NOTCH].p[0] = fz;
+        p.stage[SKEWED_NOTCH].p[1] = dz;
+        p.stage[SKEWED_NOTCH].p[2] = fp;
+        p.stage[SKEWED_NOTCH].p[3] = dp;
+
+        config.endGroup();
+    }
+
+    if (config.readGroup("second_order_low_pass"))
+    {
+        double fp, dp;
+        config.value("fp", fp);
+        config.value("dp", dp);
+
+        if (fp < 0 || dp < 0)
+            config.addError("fp < 0 || dp < 0");
+
+        p.stage[SECOND_ORDER_LOW_PASS].active = true;
+        p.stage[SECOND_ORDER_LOW_PASS].p[0] = fp;
+        p.stage[SECOND_ORDER_LOW_PASS].p[1] = dp;
+
+        config.endGroup();
+    }
+}
+
+// ----------------------------------------------------------------------------------------------------
+
+void discretizeFilterChain(const FilterChainParameters& p, double dt, FilterChainCoefficients& c)
+{
+    for(unsigned int i = 0; i < NUM_FILTER_STAGES; ++i)
+        c.stage[i] = unityFilter();
+
+    const FilterStageParameters* s = p.stage;
+
+    if (s[WEAK_INTEGRATOR].active)
+        c.stage[WEAK_INTEGRATOR] = weakIntegrator(s[WEAK_INTEGRATOR].p[0], dt);
+
+    if (s[LEAD_LAG].active)
+        c.stage[LEAD_LAG] = leadLag(s[LEAD_LAG].p[0], s[LEAD_LAG].p[1], dt);
+
+    if (s[SKEWED_NOTCH].active)
+        c.stage[SKEWED_NOTCH] = skewedNotch(s[SKEWED_NOTCH].p[0], s[SKEWED_NOTCH].p[1], s[SKEWED_NOTCH].p[2], s[SKEWED_NOTCH].p[3], dt);
+
+    if (s[SECOND_ORDER_LOW_PASS].active)
+        c.stage[SECOND_ORDER_LOW_PASS] = secondOrderLowPass(s[SECOND_ORDER_LOW_PASS].p[0], s[SECOND_ORDER_LOW_PASS].p[1], dt);
+}
+
+// ----------------------------------------------------------------------------------------------------
+
+void configureFilterChain(tue::Configuration& config, double dt, FilterChainCoefficients& c)
+{
+    FilterChainParameters p;
+    configureFilterChain(config, p);
+    discretizeFilterChain(p, dt, c);
+}
+
+// ----------------------------------------------------------------------------------------------------
+
+void SampleTimeTable::configure(tue::Configuration& config)
+{
+    *this = SampleTimeTable();
+
+    if (!config.readGroup("dt_table"))
+        return;
+
+    double min, max;
+    int n;
+    config.value("min", min);
+    config.value("max", max);
+    config.value("size", n);
+
+    if (min <= 0 || max <= min)
+        config.addError("dt_table: min <= 0 || max <= min");
+    else if (n < 2)
+        config.addError("dt_table: size < 2");
+    else
+    {
+        dt_min = min;
+        dt_step = (max - min) / (n - 1);
+        size = n;
+    }
+
+    config.endGroup();
+}
+
+// ----------------------------------------------------------------------------------------------------
+
+} // end namespace control
+
+} // end namespace tue
+
@@ -0,0 +1,52 @@
+#include "tue/control/feedforward.h"
+
+namespace tue
+{
+namespace control
+{
+
+// ----------------------------------------------------------------------------------------------------
+
+void Feedforward::configure(tue::Configuration& config)
+{
+    config.value("gravity", gravity);
+    config.value("static", static_friction);
+    config.value("dynamic", dynamic_friction);
+    config.value("acceleration", acceleration);
+
+    if (!config.value("direction", direction, tue::OPTIONAL))
+        direction = 1;
+
+    // Compensation of the estimated disturbance (already in output units)
+    disturbance = 0;
+    config.value("disturbance", disturbance, tue::OPTIONAL);
+}
+
+// ----------------------------------------------------------------------------------------------------
+
+double Feedforward::compute(const ControllerInput& input) const
+{
+    double ff = gravity;
+    if (is_set(input.vel_reference))
+    {
+        double vel_sign = input.vel_reference < 0 ? -1 : (input.vel_reference > 0 ? 1 : 0);
+        ff += static_friction * vel_sign + dynamic_friction * input.vel_reference;
+    }
+
+    if (is_set(input.acc_reference))
+        ff += acceleration * input.acc_reference;
+
+    double out = direction * ff;
+
+    if (disturbance != 0 && is_set(input.disturbance_estimate))
+        out -= disturbance * input.disturbance_estimate;
+
+    return out;
+}
+
+// ----------------------------------------------------------------------------------------------------
+
+} // end namespace control
+
+} // end namespace tue
+
@@ -0,0 +1,192 @@
+#include "tue/control/gain_scheduled_controller.h"
+
+namespace tue
+{
+
+namespace control
+{
+
+GainScheduledController::GainScheduledController() : scheduling_variable_(POSITION), num_points_(0)
+{
+}
+
+GainScheduledController::~GainScheduledController()
+{
+}
+
+void GainScheduledController::configure(tue::Configuration& config, double dt)
+{
+    num_points_ = 0;
+    state_ = FilterChainState();
+
+    //! Get the scheduling variable
+    std::string scheduling_variable;
+    config.value("scheduling_variable", scheduling_variable);
+
+    if (scheduling_variable == "position")
+        scheduling_variable_ = POSITION;
+    else if (scheduling_variable == "velocity")
+        scheduling_variable_ = VELOCITY;
+    else if (scheduling_variable == "external")
+        scheduling_variable_ = EXTERNAL;
+    else
+        config.addError("Unknown scheduling variable: '" + scheduling_variable + "'");
+
+    //! Get the operating points and discretize their filters
+    FilterChainParameters parameters[MAX_OPERATING_POINTS];
+    if (config.readArray("operating_points", tue::REQUIRED))
+    {
+        while(config.nextArrayItem())
+        {
+            if (num_points_ == MAX_OPERATING_POINTS)
+            {
+                config.addError("Too many operating points");
+                break;
+            }
+
+            unsigned int i = num_points_;
+
+            config.value("value", values_[i]);
+            config.value("gain", gains_[i]);
+
+            if (i > 0 && values_[i] <= values_[i - 1])
+                config.addError("Operating points must be sorted on increasing value");
+
+            // Without filters, all stages are unity filters
+            if (config.readGroup("filters"))
+            {
+                configureFilterChain(config, parameters[i]);
+                config.endGroup();
+            }
+
+            discretizeFilterChain(parameters[i], dt, coefficients_[i]);
+
+            ++num_points_;
+        }
+
+        config.endArray();
+    }
+
+    if (num_points_ == 0)
+        config.addError("No operating points");
+    else
+        current_ = coefficients_[0];
+
+    //! Get the (optional) discretizations of all operating points for a range of sample times
+    dt_table_.configure(config);
+    table_.resize(dt_table_.size * num_points_);
+    for(unsigned int k = 0; k < dt_table_.size; ++k)
+        for(unsigned int i = 0; i < num_points_; ++i)
+            discretizeFilterChain(parameters[i], dt_table_.dt(k), table_[k * num_points_ + i]);
+
+    if (config.readGroup("feedforward"))
+    {
+        feedforward_.configure(config);
+        config.endGroup(); // end feedforward
+    }
+}
+
+void GainScheduledController::update(const ControllerInput& input, ControllerOutput& output)
+{
+    if (!is_set(input.pos_reference) || !is_set(input.measurement) || num_points_ == 0)
+        return;
+
+    // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+    //! 1) Determine the scheduling variable
+
+    double s;
+    if (scheduling_variable_ == POSITION)
+        s = input.measurement;
+    else if (scheduling_variable_ == VELOCITY)
+        s = is_set(input.vel_estimate) ? input.vel_estimate : input.vel_reference;
+    else
+        s = input.scheduling_variable;
+
+    // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+    //! 2) Interpolate the gain and filter coefficients
+
+    // Discretizations closest to the actual elapsed time
+    const FilterChainCoefficients* coefficients = coefficients_;
+    if (!table_.empty() && is_set(input.dt))
+        coefficients = &table_[dt_table_.index(input.dt) * num_points_];
+
+    double gain;
+    if (!is_set(s) || num_points_ == 1 || s <= values_[0])
+    {
+        gain = gains_[0];
+        current_ = coefficients[0];
+    }
+    else if (s >= values_[num_points_ - 1])
+    {
+        gain = gains_[num_points_ - 1];
+        current_ = coefficients[num_points_ - 1];
+    }
+    else
+    {
+        unsigned int i = 1;
+        while(s > values_[i])
+            ++i;
+
+        double f = (s - values_[i - 1]) / (values_[i] - values_[i - 1]);
+
+        gain = gains_[i - 1] + f * (gains_[i] - gains_[i - 1]);
+        for(unsigned int j = 0; j < NUM_FILTER_STAGES; ++j)
+            interpolate(coefficients[i - 1].stage[j], coefficients[i].stage[j], f, current_.stage[j]);
+    }
+
+    // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+    //! 3) Calculate the error, apply gain and filters
+
+    double error = input.pos_reference - input.measurement;
+
+    integrator_before_ = state_.stage[WEAK_INTEGRATOR];
+    double out = updateFilterChain(current_, state_, gain * error);
+
+    // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+    //! 4) Apply feed forward
+
+    out += feedforward_.compute(input);
+
+    // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+    // Set output
+
+    output.value = out;
+    output.error = error;
+
+    return;
+}
+
+void GainScheduledController::applyOutputLimit(double requested, double applied)
+{
+    limitIntegration(integrator_before_, state_.stage[WEAK_INTEGRATOR], requested - applied);
+}
+
+unsigned int GainScheduledController::stateSize() const
+{
+    return FILTER_CHAIN_STATE_SIZE;
+}
+
+void GainScheduledController::saveState(double* state) const
+{
+    saveFilterChainState(state_, state);
+}
+
+void GainScheduledController::restoreState(const double* state)
+{
+    restoreFilterChainState(state, state_);
+}
+
+void GainScheduledController::reset()
+{
+    state_ = FilterChainState();
+}
+
+void GainScheduledController::reset(double initial_output, const ControllerInput& input)
+{
+    // Uses the coefficients of the last update. The feedforward is added again by update.
+    presetFilterChain(current_, state_, initial_output - feedforward_.compute(input));
+}
+
+}
+
+}
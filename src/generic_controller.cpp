@@ -6,8 +6,7 @@ namespace tue
 namespace control
 {
 
-GenericController::GenericController() : gain_(0), filters_(Filters()),
-    ffw_gravity_(0), ffw_static_(0), ffw_dynamic_(0), ffw_acceleration_(0), ffw_direction_(0)
+GenericController::GenericController() : gain_(0), damping_(0)
 {
 
 }
@@ -24,66 +23,23 @@ void GenericController::configure(tue::Configuration& config, double dt)
     //! Get the gain
     config.value("gain", gain_);
 
+    //! Get the (optional) damping on the estimated velocity
+    damping_ = 0;
+    config.value("damping", damping_, tue::OPTIONAL);
+
     //! Get the filters
+    FilterChainParameters filter_parameters;
     if (config.readGroup("filters"))
     {
-        if (config.readGroup("weak_integrator"))
-        {
-            double fz;
-            config.value("fz", fz);
-
-            if (fz < 0)
-                config.addError("fz < 0");
-
-            if (!config.hasError())
-                filters_.weak_integrator = new DFILTERS::DWeakIntegrator(fz, dt);
-
-            config.endGroup();
-        }
-
-        if (config.readGroup("lead_lag"))
-        {
-            double fz, fp;
-            config.value("fz", fz);
-            config.value("fp", fp);
-
-            if (fz < 0 || fp < 0)
-                config.addError("fz < 0 || fp < 0");
-
-            if (!config.hasError())
-                filters_.lead_lag = new DFILTERS::DLeadLag(fz, fp, dt);
-
-            config.endGroup();
-        }
-
-        if (config.readGroup("skewed_notch"))
-        {
-            double fz, dz, fp, dp;
-            config.value("fz", fz);
-            config.value("dz", dz);
-            config.value("fp", fp);
-            config.value("dp", dp);
+        configureFilterChain(config, filter_parameters);
 
-            if (fz < 0 || dz < 0 || fp < 0 || dp < 0)
-                config.addError("fz < 0 || dz < 0 || fp < 0 || dp < 0");
-
-            if (!config.hasError())
-                filters_.skewed_notch = new DFILTERS::DSkewedNotch(fz, dz,fp, dp, dt);
-
-            config.endGroup();
-        }
-
-        if (config.readGroup("second_order_low_pass"))
+        if (config.readGroup("adaptive_notch"))
         {
-            double fp, dp;
-            config.value("fp", fp);
-            config.value("dp", dp);
-
-            if (fp < 0 || dp < 0)
-                config.addError("fp < 0 || dp < 0");
+            filters_.adaptive_notch.reset(new AdaptiveNotch);
+            filters_.adaptive_notch->configure(config, dt);
 
-            if (!config.hasError())
-                filters_.second_order_low_pass = new DFILTERS::DSecondOrderLowpass(fp, dp, dt);
+            if (!filters_.adaptive_notch->is_configured())
+                filters_.adaptive_notch.reset();
 
             config.endGroup();
         }
@@ -92,16 +48,18 @@ void GenericController::configure(tue::Configuration& config, double dt)
         config.endGroup();
     }
 
-    if (config.readGroup("feedforward"))
-    {
-        config.value("gravity", ffw_gravity_);
-        config.value("static", ffw_static_);
-        config.value("dynamic", ffw_dynamic_);
-        config.value("acceleration", ffw_acceleration_);
+    discretizeFilterChain(filter_parameters, dt, filters_.nominal);
+    filters_.state = FilterChainState();
 
-        if (!config.value("direction", ffw_direction_, tue::OPTIONAL))
-            ffw_direction_ = 1;
+    //! Get the (optional) discretizations for a range of sample times
+    filters_.dt_table.configure(config);
+    filters_.table.resize(filters_.dt_table.size);
+    for(unsigned int i = 0; i < filters_.dt_table.size; ++i)
+        discretizeFilterChain(filter_parameters, filters_.dt_table.dt(i), filters_.table[i]);
 
+    if (config.readGroup("feedforward"))
+    {
+        feedforward_.configure(config);
         config.endGroup(); // end feedforward
     }
 }
@@ -124,48 +82,36 @@ void GenericController::update(const ControllerInput& input, ControllerOutput& o
     // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
     //! 3) Check what filters are configured and apply these
 
-    // Apply weak_integrator
-    if (filters_.weak_integrator)
-    {
-        filters_.weak_integrator->update( out );
-        out = filters_.weak_integrator->getOutput();
-    }
+    // Discretization closest to the actual elapsed time
+    const FilterChainCoefficients& c = filters_.coefficients(input.dt);
+    FilterChainState& s = filters_.state;
 
-    // Apply lead_lag
-    if (filters_.lead_lag)
-    {
-        filters_.lead_lag->update( out );
-        out = filters_.lead_lag->getOutput();
-    }
+    // Apply weak_integrator, lead_lag and skewed_notch (unity if not configured)
+    filters_.integrator_before = s.stage[WEAK_INTEGRATOR];
+    out = updateFilter(c.stage[WEAK_INTEGRATOR], s.stage[WEAK_INTEGRATOR], out);
+    out = updateFilter(c.stage[LEAD_LAG], s.stage[LEAD_LAG], out);
+    out = updateFilter(c.stage[SKEWED_NOTCH], s.stage[SKEWED_NOTCH], out);
 
-    // Apply skewed_notch
-    if (filters_.skewed_notch)
-    {
-        filters_.lead_lag->update( out );
-        out = filters_.lead_lag->getOutput();
-    }
+    // Apply adaptive_notch (tracks the resonance in the error)
+    if (filters_.adaptive_notch)
+        out = filters_.adaptive_notch->update(out, error);
 
     // Apply second_order_low_pass
-    if (filters_.second_order_low_pass)
-    {
-        filters_.second_order_low_pass->update( out );
-        out = filters_.second_order_low_pass->getOutput();
-    }
+    out = updateFilter(c.stage[SECOND_ORDER_LOW_PASS], s.stage[SECOND_ORDER_LOW_PASS], out);
 
     // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
     //! 4) Apply feed forward
 
-    double ff = ffw_gravity_;
-    if (is_set(input.vel_reference))
-    {
-        double vel_sign = input.vel_reference < 0 ? -1 : (input.vel_reference > 0 ? 1 : 0);
-        ff += ffw_static_ * vel_sign + ffw_dynamic_ * input.vel_reference;
-    }
+    out += feedforward_.compute(input);
 
-    if (is_set(input.acc_reference))
-        ff += ffw_acceleration_ * input.acc_reference;
+    // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+    //! 5) Apply damping on the estimated velocity
 
-    out += ffw_direction_ * ff;
+    if (damping_ != 0 && is_set(input.vel_estimate))
+    {
+        double vel_reference = is_set(input.vel_reference) ? input.vel_reference : 0;
+        out += damping_ * (vel_reference - input.vel_estimate);
+    }
 
     // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
     // Set output
@@ -176,6 +122,61 @@ void GenericController::update(const ControllerInput& input, ControllerOutput& o
     return;
 }
 
+void GenericController::applyOutputLimit(double requested, double applied)
+{
+    limitIntegration(filters_.integrator_before, filters_.state.stage[WEAK_INTEGRATOR], requested - applied);
+}
+
+unsigned int GenericController::stateSize() const
+{
+    return FILTER_CHAIN_STATE_SIZE + (filters_.adaptive_notch ? AdaptiveNotch::STATE_SIZE : 0);
+}
+
+void GenericController::saveState(double* state) const
+{
+    saveFilterChainState(filters_.state, state);
+    if (filters_.adaptive_notch)
+        filters_.adaptive_notch->saveState(state + FILTER_CHAIN_STATE_SIZE);
+}
+
+void GenericController::restoreState(const double* state)
+{
+    restoreFilterChainState(state, filters_.state);
+    if (filters_.adaptive_notch)
+        filters_.adaptive_notch->restoreState(state + FILTER_CHAIN_STATE_SIZE);
+}
+
+void GenericController::reset()
+{
+    filters_.state = FilterChainState();
+    if (filters_.adaptive_notch)
+        filters_.adaptive_notch->reset();
+}
+
+void GenericController::reset(double initial_output, const ControllerInput& input)
+{
+    // The feedforward and damping are added again by update, so only the rest comes from the filters
+    double y = initial_output - feedforward_.compute(input);
+    if (damping_ != 0 && is_set(input.vel_estimate))
+    {
+        double vel_reference = is_set(input.vel_reference) ? input.vel_reference : 0;
+        y -= damping_ * (vel_reference - input.vel_estimate);
+    }
+
+    // Preset the stages from the output back to the input (same order as in update)
+    const FilterChainCoefficients& c = filters_.coefficients(input.dt);
+    FilterChainState& s = filters_.state;
+
+    y = presetFilter(c.stage[SECOND_ORDER_LOW_PASS], s.stage[SECOND_ORDER_LOW_PASS], y);
+
+    if (filters_.adaptive_notch)
+        filters_.adaptive_notch->reset(y);
+
+    y = presetFilter(c.stage[SKEWED_NOTCH], s.stage[SKEWED_NOTCH], y);
+    y = presetFilter(c.stage[LEAD_LAG], s.stage[LEAD_LAG], y);
+    presetFilter(c.stage[WEAK_INTEGRATOR], s.stage[WEAK_INTEGRATOR], y);
+}
+
 }
 
 }
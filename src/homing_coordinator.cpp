@@ -0,0 +1,244 @@
+#include "tue/control/homing_coordinator.h"
+
+#include "tue/control/supervised_controller.h"
+
+namespace tue
+{
+namespace control
+{
+
+// ----------------------------------------------------------------------------------------------------
+
+HomingCoordinator::HomingCoordinator() : num_homed_(0), running_(false), failed_(false)
+{
+}
+
+// ----------------------------------------------------------------------------------------------------
+
+HomingCoordinator::~HomingCoordinator()
+{
+}
+
+// ----------------------------------------------------------------------------------------------------
+
+void HomingCoordinator::addController(const std::shared_ptr<SupervisedController>& controller)
+{
+    Joint joint;
+    joint.controller = controller;
+    joint.state = WAITING;
+    joint.effort = INVALID_DOUBLE;
+    joint.detections = 0;
+    joint.ticks = 0;
+    joint.max_ticks = 0;
+    joints_.push_back(joint);
+}
+
+// ----------------------------------------------------------------------------------------------------
+
+bool HomingCoordinator::initialize(double dt)
+{
+    error_msg_.clear();
+
+    // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+    // Resolve preconditions and check end stop configuration
+
+    for(std::vector<Joint>::iterator it = joints_.begin(); it != joints_.end(); ++it)
+    {
+        Joint& joint = *it;
+        const SupervisedController& c = *joint.controller;
+
+        joint.preconditions.clear();
+
+        const std::vector<std::string>& names = c.homing_preconditions();
+        for(std::vector<std::string>::const_iterator it_name = names.begin(); it_name != names.end(); ++it_name)
+        {
+            unsigned int j = 0;
+            while(j < joints_.size() && joints_[j].controller->name() != *it_name)
+                ++j;
+
+            if (j == joints_.size())
+            {
+                error_msg_ = c.name() + ": unknown homing precondition '" + *it_name + "'";
+                return false;
+            }
+
+            joint.preconditions.push_back(j);
+        }
+
+        if (c.is_homable() && !is_set(c.homing_end_stop().position))
+        {
+            error_msg_ = c.name() + ": no homing end stop configured";
+            return false;
+        }
+
+        const double timeout = c.homing_end_stop().timeout;
+        joint.max_ticks = is_set(timeout) ? static_cast<unsigned int>(timeout / dt + 0.5) : 0;
+    }
+
+    // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+    // Check for cyclic preconditions (all joints must be reachable in topological order)
+
+    std::vector<bool> resolved(joints_.size(), false);
+    unsigned int num_resolved = 0;
+    bool progress = true;
+    while(progress)
+    {
+        progress = false;
+        for(unsigned int i = 0; i < joints_.size(); ++i)
+        {
+            if (resolved[i])
+                continue;
+
+            bool ready = true;
+            for(std::vector<unsigned int>::const_iterator it = joints_[i].preconditions.begin(); it != joints_[i].preconditions.end(); ++it)
+                ready = ready && resolved[*it];
+
+            if (ready)
+            {
+                resolved[i] = true;
+                ++num_resolved;
+                progress = true;
+            }
+        }
+    }
+
+    if (num_resolved != joints_.size())
+    {
+        error_msg_ = "Cyclic homing preconditions";
+        return false;
+    }
+
+    return true;
+}
+
+// ----------------------------------------------------------------------------------------------------
+
+void HomingCoordinator::start()
+{
+    num_homed_ = 0;
+    failed_ = false;
+    running_ = true;
+
+    for(std::vector<Joint>::iterator it = joints_.begin(); it != joints_.end(); ++it)
+    {
+        it->state = WAITING;
+        it->detections = 0;
+        it->ticks = 0;
+    }
+
+    update();
+}
+
+// ----------------------------------------------------------------------------------------------------
+
+void HomingCoordinator::fail(Joint& joint, const std::string& msg)
+{
+    joint.state = FAILED;
+    joint.controller->setError(msg);
+    error_msg_ = joint.controller->name() + ": " + msg;
+    failed_ = true;
+
+    // Nothing supervises the other joints anymore (no end stop detection, no timeout), so they must
+    // not keep moving towards their end stops
+    for(std::vector<Joint>::iterator it = joints_.begin(); it != joints_.end(); ++it)
+    {
+        if (it->state == IN_PROGRESS)
+        {
+            it->state = FAILED;
+            it->controller->setError("Homing aborted: " + joint.controller->name() + " failed");
+        }
+    }
+}
+
+// ----------------------------------------------------------------------------------------------------
+
+void HomingCoordinator::update()
+{
+    if (!running_)
+        return;
+
+    for(std::vector<Joint>::iterator it = joints_.begin(); it != joints_.end(); ++it)
+    {
+        Joint& joint = *it;
+        SupervisedController& c = *joint.controller;
+
+        switch (joint.state)
+        {
+
+        case WAITING:
+        {
+            if (!c.is_homable() || c.is_homed())
+            {
+                joint.state = HOMED;
+                ++num_homed_;
+                break;
+            }
+
+            bool ready = true;
+            for(std::vector<unsigned int>::const_iterator it_pre = joint.preconditions.begin(); it_pre != joint.preconditions.end(); ++it_pre)
+                ready = ready && joints_[*it_pre].state == HOMED;
+
+            if (ready)
+            {
+                c.startHoming();
+                joint.state = IN_PROGRESS;
+            }
+            break;
+        }
+
+        case IN_PROGRESS:
+        {
+            if (c.status() == ERROR)
+            {
+                fail(joint, "Error while homing: " + c.error_message());
+                break;
+            }
+
+            if (c.is_homed())
+            {
+                joint.state = HOMED;
+                ++num_homed_;
+                break;
+            }
+
+            // The controller picks up the start homing event in its next update
+            if (c.status() != HOMING)
+                break;
+
+            ++joint.ticks;
+            if (joint.max_ticks > 0 && joint.ticks > joint.max_ticks)
+            {
+                fail(joint, "Homing timeout");
+                break;
+            }
+
+            // End stop detection
+            const HomingEndStop& end_stop = c.homing_end_stop();
+            double effort = is_set(joint.effort) ? joint.effort : c.output();
+
+            bool detected = (is_set(end_stop.error) && is_set(c.error()) && std::abs(c.error()) > end_stop.error)
+                         || (is_set(end_stop.effort) && is_set(effort) && std::abs(effort) > end_stop.effort);
+
+            joint.detections = detected ? joint.detections + 1 : 0;
+
+            if (joint.detections >= end_stop.samples)
+                c.stopHoming(end_stop.position);
+
+            break;
+        }
+
+        default:
+            break;
+        }
+    }
+
+    if (done() || failed_)
+        running_ = false;
+}
+
+// ----------------------------------------------------------------------------------------------------
+
+} // end namespace control
+
+} // end namespace tue
+
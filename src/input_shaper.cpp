@@ -0,0 +1,200 @@
+#include "tue/control/input_shaper.h"
+
+#include "tue/control/generic.h"
+
+#include <algorithm>
+
+namespace tue
+{
+namespace control
+{
+
+// ----------------------------------------------------------------------------------------------------
+
+bool computeShaperImpulses(InputShaperType type, double frequency, double damping, double tolerance,
+                           ShaperImpulses& impulses)
+{
+    if (!(frequency > 0) || !(damping >= 0 && damping < 1))
+        return false;
+
+    // Damped period, and the decay of the mode over half a period
+    double T = 1 / (frequency * std::sqrt(1 - damping * damping));
+    double K = std::exp(-damping * M_PI / std::sqrt(1 - damping * damping));
+
+    double a[ShaperImpulses::MAX_IMPULSES];
+
+    if (type == SHAPER_ZV)
+    {
+        impulses.size = 2;
+        a[0] = 1;
+        a[1] = K;
+    }
+    else if (type == SHAPER_ZVD)
+    {
+        impulses.size = 3;
+        a[0] = 1;
+        a[1] = 2 * K;
+        a[2] = K * K;
+    }
+    else if (type == SHAPER_EI)
+    {
+        if (!(tolerance > 0 && tolerance < 1))
+            return false;
+
+        // Amplitudes of the undamped EI shaper, with the damping compensated as in ZVD
+        impulses.size = 3;
+        a[0] = (1 + tolerance) / 4;
+        a[1] = K * (1 - tolerance) / 2;
+        a[2] = K * K * (1 + tolerance) / 4;
+    }
+    else
+        return false;
+
+    double sum = 0;
+    for(unsigned int i = 0; i < impulses.size; ++i)
+        sum += a[i];
+
+    for(unsigned int i = 0; i < impulses.size; ++i)
+    {
+        impulses.amplitude[i] = a[i] / sum;
+        impulses.time[i] = i * T / 2;
+    }
+
+    return true;
+}
+
+// ----------------------------------------------------------------------------------------------------
+
+InputShaper::InputShaper() : configured_(false), num_channels_(0), duration_(0), num_taps_(0), size_(0), index_(0)
+{
+}
+
+// ----------------------------------------------------------------------------------------------------
+
+InputShaper::~InputShaper()
+{
+}
+
+// ----------------------------------------------------------------------------------------------------
+
+void InputShaper::configure(tue::Configuration& config, double dt, unsigned int num_channels)
+{
+    configured_ = false;
+
+    std::string type;
+    double frequency = 0, damping = 0, tolerance = 0.05;
+
+    config.value("type", type);
+    config.value("frequency", frequency);
+    config.value("damping", damping, tue::OPTIONAL);
+    config.value("tolerance", tolerance, tue::OPTIONAL);
+
+    InputShaperType t;
+    if (type == "zv")
+        t = SHAPER_ZV;
+    else if (type == "zvd")
+        t = SHAPER_ZVD;
+    else if (type == "ei")
+        t = SHAPER_EI;
+    else
+    {
+        config.addError("Unknown input shaper type: '" + type + "'");
+        return;
+    }
+
+    ShaperImpulses impulses;
+    if (!computeShaperImpulses(t, frequency, damping, tolerance, impulses))
+    {
+        config.addError("Input shaper: frequency must be > 0, damping in [0, 1) and tolerance in (0, 1)");
+        return;
+    }
+
+    configure(std::vector<ShaperImpulses>(num_channels, impulses), dt);
+}
+
+// ----------------------------------------------------------------------------------------------------
+
+void InputShaper::configure(const std::vector<ShaperImpulses>& impulses, double dt)
+{
+    num_channels_ = impulses.size();
+
+    num_taps_ = 0;
+    for(unsigned int c = 0; c < num_channels_; ++c)
+        num_taps_ = std::max(num_taps_, 2 * impulses[c].size);
+
+    // Unused taps have zero weight
+    tap_delay_.assign(num_taps_ * num_channels_, 0);
+    tap_weight_.assign(num_taps_ * num_channels_, 0);
+
+    duration_ = 0;
+    unsigned int max_delay = 0;
+
+    for(unsigned int c = 0; c < num_channels_; ++c)
+    {
+        const ShaperImpulses& s = impulses[c];
+        for(unsigned int i = 0; i < s.size; ++i)
+        {
+            // Linear interpolation between the samples k and k + 1 before
+            double d = s.time[i] / dt;
+            unsigned int k = static_cast<unsigned int>(d);
+            double f = d - k;
+
+            tap_delay_[(2 * i) * num_channels_ + c] = k;
+            tap_weight_[(2 * i) * num_channels_ + c] = s.amplitude[i] * (1 - f);
+            tap_delay_[(2 * i + 1) * num_channels_ + c] = k + 1;
+            tap_weight_[(2 * i + 1) * num_channels_ + c] = s.amplitude[i] * f;
+
+            max_delay = std::max(max_delay, k + 1);
+            duration_ = std::max(duration_, s.time[i]);
+        }
+    }
+
+    size_ = max_delay + 1;
+    index_ = 0;
+    history_.assign(size_ * num_channels_, 0);
+
+    configured_ = (num_channels_ > 0);
+}
+
+// ----------------------------------------------------------------------------------------------------
+
+void InputShaper::update(const double* in, double* out)
+{
+    index_ = (index_ + 1) % size_;
+
+    double* current = &history_[index_ * num_channels_];
+    for(unsigned int c = 0; c < num_channels_; ++c)
+    {
+        current[c] = in[c];
+        out[c] = 0;
+    }
+
+    for(unsigned int t = 0; t < num_taps_; ++t)
+    {
+        const unsigned int* delay = &tap_delay_[t * num_channels_];
+        const double* weight = &tap_weight_[t * num_channels_];
+
+        for(unsigned int c = 0; c < num_channels_; ++c)
+        {
+            unsigned int slot = index_ + size_ - delay[c];
+            if (slot >= size_)
+                slot -= size_;
+            out[c] += weight[c] * history_[slot * num_channels_ + c];
+        }
+    }
+}
+
+// ----------------------------------------------------------------------------------------------------
+
+void InputShaper::reset(const double* values)
+{
+    for(unsigned int i = 0; i < size_; ++i)
+        for(unsigned int c = 0; c < num_channels_; ++c)
+            history_[i * num_channels_ + c] = values[c];
+}
+
+// ----------------------------------------------------------------------------------------------------
+
+} // end namespace control
+
+} // end namespace tue
@@ -0,0 +1,171 @@
+#include "tue/control/loop_statistics.h"
+
+#include <cmath>
+
+namespace tue
+{
+namespace control
+{
+
+// ----------------------------------------------------------------------------------------------------
+
+LoopStatistics::LoopStatistics() : dt_(0), num_windows_(0), error_sign_(0), deadband_(0),
+    oscillation_frequency_(0), oscillation_error_rms_(0)
+{
+}
+
+// ----------------------------------------------------------------------------------------------------
+
+LoopStatistics::~LoopStatistics()
+{
+}
+
+// ----------------------------------------------------------------------------------------------------
+
+void LoopStatistics::configure(tue::Configuration& config, double dt)
+{
+    dt_ = dt;
+    num_windows_ = 0;
+
+    if (config.readArray("windows", tue::REQUIRED))
+    {
+        while(config.nextArrayItem())
+        {
+            double duration;
+            if (!config.value("duration", duration))
+                continue;
+
+            if (num_windows_ == MAX_STATISTICS_WINDOWS)
+            {
+                config.addError("Too many statistics windows");
+                continue;
+            }
+
+            int size = static_cast<int>(duration / dt + 0.5);
+            if (size < 1)
+            {
+                config.addError("Statistics window duration must be at least one sample");
+                continue;
+            }
+
+            acc_[num_windows_].size = size;
+            ++num_windows_;
+        }
+
+        config.endArray();
+    }
+
+    deadband_ = 0;
+    oscillation_frequency_ = INFINITY;
+    oscillation_error_rms_ = 0;
+
+    if (config.readGroup("oscillation"))
+    {
+        config.value("deadband", deadband_, tue::OPTIONAL);
+        config.value("frequency", oscillation_frequency_);
+        config.value("error_rms", oscillation_error_rms_, tue::OPTIONAL);
+        config.endGroup();
+    }
+
+    reset();
+}
+
+// ----------------------------------------------------------------------------------------------------
+
+void LoopStatistics::clear(Accumulator& acc)
+{
+    acc.n = 0;
+    acc.n_saturated = 0;
+    acc.n_crossings = 0;
+    acc.sum_error_sq = 0;
+    acc.sum_output_sq = 0;
+    acc.error_peak = 0;
+}
+
+// ----------------------------------------------------------------------------------------------------
+
+void LoopStatistics::reset()
+{
+    error_sign_ = 0;
+    for(unsigned int i = 0; i < num_windows_; ++i)
+    {
+        clear(acc_[i]);
+        completed_[i] = LoopStatisticsWindow();
+        completed_[i].duration = acc_[i].size * dt_;
+    }
+}
+
+// ----------------------------------------------------------------------------------------------------
+
+void LoopStatistics::restart()
+{
+    error_sign_ = 0;
+    for(unsigned int i = 0; i < num_windows_; ++i)
+        clear(acc_[i]);
+}
+
+// ----------------------------------------------------------------------------------------------------
+
+void LoopStatistics::update(double error, double output, bool saturated)
+{
+    // Zero crossing detection with hysteresis: the sign only flips once the error leaves the deadband
+    unsigned int crossing = 0;
+    if (error > deadband_)
+    {
+        crossing = (error_sign_ < 0);
+        error_sign_ = 1;
+    }
+    else if (error < -deadband_)
+    {
+        crossing = (error_sign_ > 0);
+        error_sign_ = -1;
+    }
+
+    double abs_error = std::abs(error);
+
+    for(unsigned int i = 0; i < num_windows_; ++i)
+    {
+        Accumulator& acc = acc_[i];
+
+        ++acc.n;
+        acc.n_saturated += saturated;
+        acc.n_crossings += crossing;
+        acc.sum_error_sq += error * error;
+        acc.sum_output_sq += output * output;
+        if (abs_error > acc.error_peak)
+            acc.error_peak = abs_error;
+
+        if (acc.n < acc.size)
+            continue;
+
+        // Window complete: compute the statistics and start a new window
+
+        LoopStatisticsWindow& w = completed_[i];
+        w.duration = acc.size * dt_;
+        w.samples = acc.n;
+        w.error_rms = std::sqrt(acc.sum_error_sq / acc.n);
+        w.error_peak = acc.error_peak;
+        w.output_rms = std::sqrt(acc.sum_output_sq / acc.n);
+        w.saturation_duty_cycle = static_cast<double>(acc.n_saturated) / acc.n;
+        w.oscillation_frequency = 0.5 * acc.n_crossings / w.duration;
+        w.oscillating = (w.oscillation_frequency >= oscillation_frequency_ && w.error_rms >= oscillation_error_rms_);
+
+        clear(acc);
+    }
+}
+
+// ----------------------------------------------------------------------------------------------------
+
+void LoopStatistics::getSnapshot(LoopStatisticsSnapshot& snapshot) const
+{
+    snapshot.num_windows = num_windows_;
+    for(unsigned int i = 0; i < num_windows_; ++i)
+        snapshot.windows[i] = completed_[i];
+}
+
+// ----------------------------------------------------------------------------------------------------
+
+} // end namespace control
+
+} // end namespace tue
+
@@ -0,0 +1,166 @@
+#include "tue/control/measurement_filter.h"
+
+#include "tue/control/generic.h"
+
+namespace tue
+{
+namespace control
+{
+
+// ----------------------------------------------------------------------------------------------------
+
+MeasurementFilter::MeasurementFilter() : configured_(false), dt_(0), max_jump_(INVALID_DOUBLE),
+    max_velocity_(INVALID_DOUBLE), max_dropouts_(0), velocity_filter_(1), num_dropouts_(0),
+    num_rejected_(0), num_rate_limited_(0)
+{
+    reset();
+}
+
+// ----------------------------------------------------------------------------------------------------
+
+MeasurementFilter::~MeasurementFilter()
+{
+}
+
+// ----------------------------------------------------------------------------------------------------
+
+void MeasurementFilter::configure(tue::Configuration& config, double dt)
+{
+    dt_ = dt;
+
+    max_jump_ = INVALID_DOUBLE;
+    max_velocity_ = INVALID_DOUBLE;
+    velocity_filter_ = 1;
+
+    config.value("max_jump", max_jump_, tue::OPTIONAL);
+    config.value("max_velocity", max_velocity_, tue::OPTIONAL);
+    config.value("velocity_filter", velocity_filter_, tue::OPTIONAL);
+
+    int max_dropouts = 0;
+    config.value("max_dropouts", max_dropouts, tue::OPTIONAL);
+
+    // Only the errors of these parameters count (the configuration may have unrelated errors already)
+    configured_ = true;
+
+    if (max_dropouts < 0)
+    {
+        config.addError("max_dropouts < 0");
+        configured_ = false;
+    }
+
+    if ((is_set(max_jump_) && max_jump_ <= 0) || (is_set(max_velocity_) && max_velocity_ <= 0))
+    {
+        config.addError("max_jump <= 0 || max_velocity <= 0");
+        configured_ = false;
+    }
+
+    if (velocity_filter_ <= 0 || velocity_filter_ > 1)
+    {
+        config.addError("velocity_filter must be in (0, 1]");
+        configured_ = false;
+    }
+
+    max_dropouts_ = max_dropouts;
+
+    reset();
+}
+
+// ----------------------------------------------------------------------------------------------------
+
+void MeasurementFilter::reset()
+{
+    position_ = INVALID_DOUBLE;
+    velocity_ = 0;
+    failed_ = false;
+    consecutive_dropouts_ = 0;
+}
+
+// ----------------------------------------------------------------------------------------------------
+
+double MeasurementFilter::update(double raw_measurement, double dt)
+{
+    failed_ = false;
+
+    if (!is_set(dt))
+        dt = dt_;
+
+    // First valid sample: nothing to predict from yet
+    if (!is_set(position_))
+    {
+        if (!is_set(raw_measurement))
+        {
+            ++num_dropouts_;
+            return INVALID_DOUBLE;
+        }
+
+        position_ = raw_measurement;
+        velocity_ = 0;
+        return position_;
+    }
+
+    double prediction = position_ + dt * velocity_;
+
+    // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+    // Missing or rejected sample: extrapolate
+
+    bool valid = is_set(raw_measurement);
+    if (!valid)
+        ++num_dropouts_;
+    else if (is_set(max_jump_) && std::abs(raw_measurement - prediction) > max_jump_)
+    {
+        ++num_rejected_;
+        valid = false;
+    }
+
+    if (!valid)
+    {
+        if (consecutive_dropouts_ >= max_dropouts_)
+        {
+            // Forget the extrapolated position: the joint may move while it is in error, so the
+            // next valid sample must be accepted as is for the joint to be able to recover
+            reset();
+            failed_ = true;
+            return INVALID_DOUBLE;
+        }
+
+        ++consecutive_dropouts_;
+        position_ = prediction;
+        return position_;
+    }
+
+    consecutive_dropouts_ = 0;
+
+    // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+    // Rate limiting
+
+    double delta = raw_measurement - position_;
+    if (is_set(max_velocity_))
+    {
+        double max_delta = max_velocity_ * dt;
+        if (delta > max_delta)
+        {
+            delta = max_delta;
+            ++num_rate_limited_;
+        }
+        else if (delta < -max_delta)
+        {
+            delta = -max_delta;
+            ++num_rate_limited_;
+        }
+    }
+
+    // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+    // Update the constant velocity model
+
+    velocity_ += velocity_filter_ * (delta / dt - velocity_);
+    position_ += delta;
+
+    return position_;
+}
+
+// ----------------------------------------------------------------------------------------------------
+
+} // end namespace control
+
+} // end namespace tue
+
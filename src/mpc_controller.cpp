@@ -0,0 +1,532 @@
+#include "tue/control/mpc_controller.h"
+#include "tue/control/small_matrix.h"
+
+#include <chrono>
+#include <cmath>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace tue
+{
+
+namespace control
+{
+
+namespace
+{
+
+static const unsigned int M = MPCController::MAX_STATES + 1;
+
+// Computes the steady-state Kalman gain for the augmented model (dimension m) by iterating the
+// Riccati equation until the gain converges
+void steadyStateKalmanGain(const double A[][M], const double* C, unsigned int m, const double* q, double r, double* L)
+{
+    double P[M][M], AP[M][M], Pp[M][M];
+    for(unsigned int i = 0; i < m; ++i)
+    {
+        L[i] = 0;
+        for(unsigned int j = 0; j < m; ++j)
+            P[i][j] = (i == j ? q[i] : 0);
+    }
+
+    for(int it = 0; it < 100000; ++it)
+    {
+        // Prediction: Pp = A P A' + Q
+        for(unsigned int i = 0; i < m; ++i)
+            for(unsigned int j = 0; j < m; ++j)
+            {
+                AP[i][j] = 0;
+                for(unsigned int k = 0; k < m; ++k)
+                    AP[i][j] += A[i][k] * P[k][j];
+            }
+
+        for(unsigned int i = 0; i < m; ++i)
+            for(unsigned int j = 0; j < m; ++j)
+            {
+                Pp[i][j] = (i == j ? q[i] : 0);
+                for(unsigned int k = 0; k < m; ++k)
+                    Pp[i][j] += AP[i][k] * A[j][k];
+            }
+
+        // Gain: L = Pp C' / (C Pp C' + r)
+        double PC[M];
+        double s = r;
+        for(unsigned int i = 0; i < m; ++i)
+        {
+            PC[i] = 0;
+            for(unsigned int k = 0; k < m; ++k)
+                PC[i] += Pp[i][k] * C[k];
+            s += C[i] * PC[i];
+        }
+
+        double diff = 0;
+        for(unsigned int i = 0; i < m; ++i)
+        {
+            double l = PC[i] / s;
+            diff += std::abs(l - L[i]);
+            L[i] = l;
+        }
+
+        // Correction: P = Pp - L C Pp  (Pp symmetric, so C Pp = PC')
+        for(unsigned int i = 0; i < m; ++i)
+            for(unsigned int j = 0; j < m; ++j)
+                P[i][j] = Pp[i][j] - L[i] * PC[j];
+
+        if (diff < 1e-15)
+            break;
+    }
+}
+
+}
+
+MPCController::MPCController() : dt_(0), n_(0), horizon_(0), iterations_(20), input_limit_(INVALID_DOUBLE),
+    step_(0), u_prev_(0), initialized_(false), preset_output_(0), max_solve_time_(0)
+{
+}
+
+MPCController::~MPCController()
+{
+}
+
+void MPCController::configure(tue::Configuration& config, double dt)
+{
+    dt_ = dt;
+    initialized_ = false;
+    preset_output_ = 0;
+    max_solve_time_ = 0;
+    u_prev_ = 0;
+
+    // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+    //! 1) Get the model
+
+    std::string A_str, B_row, C_row;
+
+    if (config.readGroup("model", tue::REQUIRED))
+    {
+        config.value("A", A_str);
+        config.value("B", B_row);
+        config.value("C", C_row);
+
+        config.endGroup();
+    }
+
+    if (config.hasError())
+        return;
+
+    // Rows of A are separated by ';'
+    std::vector<std::string> A_rows;
+    std::istringstream A_ss(A_str);
+    std::string A_row;
+    while(std::getline(A_ss, A_row, ';'))
+        A_rows.push_back(A_row);
+
+    n_ = A_rows.size();
+    if (n_ == 0 || n_ > MAX_STATES)
+    {
+        std::stringstream s;
+        s << "MPC: the model must have between 1 and " << MAX_STATES << " states";
+        config.addError(s.str());
+        return;
+    }
+
+    unsigned int m = n_ + 1;
+
+    // Augmented model: the disturbance enters like the input, and is constant
+    for(unsigned int i = 0; i < m; ++i)
+        for(unsigned int j = 0; j < m; ++j)
+            A_[i][j] = 0;
+
+    double row[MAX_STATES];
+    for(unsigned int i = 0; i < n_; ++i)
+    {
+        if (!parseRow(A_rows[i], n_, row))
+            config.addError("MPC: every row of A must contain one value per state");
+        for(unsigned int j = 0; j < n_; ++j)
+            A_[i][j] = row[j];
+    }
+
+    if (!parseRow(B_row, n_, B_))
+        config.addError("MPC: B must contain one value per state");
+
+    if (!parseRow(C_row, n_, C_))
+        config.addError("MPC: C must contain one value per state");
+    else
+    {
+        double CC = 0;
+        for(unsigned int i = 0; i < n_; ++i)
+            CC += C_[i] * C_[i];
+        if (CC == 0)
+            config.addError("MPC: C == 0");
+    }
+
+    if (config.hasError())
+        return;
+
+    for(unsigned int i = 0; i < n_; ++i)
+        A_[i][n_] = B_[i];
+    A_[n_][n_] = 1;
+    B_[n_] = 0;
+    C_[n_] = 0;
+
+    // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+    //! 2) Get the horizon, weights and constraints
+
+    int horizon = 0;
+    config.value("horizon", horizon);
+    if (horizon < 1 || horizon > static_cast<int>(MAX_HORIZON))
+    {
+        std::stringstream s;
+        s << "MPC: horizon must be between 1 and " << MAX_HORIZON;
+        config.addError(s.str());
+    }
+    else
+        horizon_ = horizon;
+
+    double w_position = 0, w_input = 0, w_input_rate = 0;
+    if (config.readGroup("weights", tue::REQUIRED))
+    {
+        config.value("position", w_position);
+        config.value("input", w_input);
+        config.value("input_rate", w_input_rate, tue::OPTIONAL);
+
+        if (w_position <= 0 || w_input < 0 || w_input_rate < 0)
+            config.addError("MPC: weights: position <= 0 || input < 0 || input_rate < 0");
+
+        config.endGroup();
+    }
+
+    input_limit_ = INVALID_DOUBLE;
+    config.value("input_limit", input_limit_, tue::OPTIONAL);
+    if (is_set(input_limit_) && input_limit_ <= 0)
+        config.addError("MPC: input_limit <= 0");
+
+    int iterations = 20;
+    config.value("iterations", iterations, tue::OPTIONAL);
+    if (iterations < 1)
+        config.addError("MPC: iterations < 1");
+    else
+        iterations_ = iterations;
+
+    double q[M];
+    double r = 1e-10;
+    for(unsigned int i = 0; i < n_; ++i)
+        q[i] = 1e-8;
+    q[n_] = 1e-2;
+
+    if (config.readGroup("estimator"))
+    {
+        config.value("process_noise", q[0], tue::OPTIONAL);
+        config.value("disturbance_noise", q[n_], tue::OPTIONAL);
+        config.value("measurement_noise", r, tue::OPTIONAL);
+
+        if (q[0] < 0 || q[n_] <= 0 || r <= 0)
+            config.addError("MPC: estimator: process_noise < 0 || disturbance_noise <= 0 || measurement_noise <= 0");
+
+        for(unsigned int i = 1; i < n_; ++i)
+            q[i] = q[0];
+
+        config.endGroup();
+    }
+
+    if (config.hasError())
+        return;
+
+    // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+    //! 3) Condensed problem
+
+    unsigned int N = horizon_;
+
+    // Phi[k] = C A^(k+1), the response of y[k+1] to the initial state, and
+    // gamma[k] = C A^k B, the response of y[k+1+j] to u[j]
+    double Phi[MAX_HORIZON][M];
+    double gamma[MAX_HORIZON];
+
+    double CA[M];
+    for(unsigned int j = 0; j < m; ++j)
+        CA[j] = C_[j];
+
+    for(unsigned int k = 0; k < N; ++k)
+    {
+        // gamma[k] = (C A^k) B
+        gamma[k] = 0;
+        for(unsigned int j = 0; j < m; ++j)
+            gamma[k] += CA[j] * B_[j];
+
+        // CA = C A^(k+1)
+        double next[M];
+        for(unsigned int j = 0; j < m; ++j)
+        {
+            next[j] = 0;
+            for(unsigned int i = 0; i < m; ++i)
+                next[j] += CA[i] * A_[i][j];
+        }
+
+        for(unsigned int j = 0; j < m; ++j)
+            CA[j] = Phi[k][j] = next[j];
+    }
+
+    // Gamma[k][j] = gamma[k - j] for j <= k: y[k+1] depends on u[0..k]
+    double Gamma[MAX_HORIZON][MAX_HORIZON];
+    for(unsigned int k = 0; k < N; ++k)
+        for(unsigned int j = 0; j < N; ++j)
+            Gamma[k][j] = (j <= k ? gamma[k - j] : 0);
+
+    // H = position * Gamma' Gamma + input * I + input_rate * D' D (D the first difference operator)
+    for(unsigned int i = 0; i < N; ++i)
+        for(unsigned int j = 0; j < N; ++j)
+        {
+            double sum = 0;
+            for(unsigned int k = 0; k < N; ++k)
+                sum += Gamma[k][i] * Gamma[k][j];
+
+            double DD = 0;
+            if (i == j)
+                DD = (i + 1 < N ? 2 : 1);
+            else if (i + 1 == j || j + 1 == i)
+                DD = -1;
+
+            H_[i][j] = w_position * sum + (i == j ? w_input : 0) + w_input_rate * DD;
+        }
+
+    // Linear term: position * Gamma' (Phi x - r) - input_rate * u_prev * e0
+    for(unsigned int i = 0; i < N; ++i)
+    {
+        for(unsigned int j = 0; j < m; ++j)
+        {
+            double sum = 0;
+            for(unsigned int k = 0; k < N; ++k)
+                sum += Gamma[k][i] * Phi[k][j];
+            F_[i][j] = w_position * sum;
+        }
+
+        for(unsigned int k = 0; k < N; ++k)
+            G_[i][k] = -w_position * Gamma[k][i];
+
+        h_[i] = (i == 0 ? -w_input_rate : 0);
+    }
+
+    // Step size: 1 / largest eigenvalue of H (power iteration)
+    double v[MAX_HORIZON], Hv[MAX_HORIZON];
+    for(unsigned int i = 0; i < N; ++i)
+        v[i] = 1;
+
+    double lambda = 0;
+    for(int it = 0; it < 1000; ++it)
+    {
+        double norm = 0;
+        for(unsigned int i = 0; i < N; ++i)
+        {
+            Hv[i] = 0;
+            for(unsigned int j = 0; j < N; ++j)
+                Hv[i] += H_[i][j] * v[j];
+            norm += Hv[i] * Hv[i];
+        }
+
+        norm = std::sqrt(norm);
+        if (norm == 0)
+            break;
+
+        for(unsigned int i = 0; i < N; ++i)
+            v[i] = Hv[i] / norm;
+
+        if (std::abs(norm - lambda) < 1e-12 * norm)
+        {
+            lambda = norm;
+            break;
+        }
+
+        lambda = norm;
+    }
+
+    if (lambda <= 0)
+    {
+        config.addError("MPC: the model output does not depend on the input");
+        return;
+    }
+
+    step_ = 1 / lambda;
+
+    // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+    //! 4) Estimator
+
+    steadyStateKalmanGain(A_, C_, m, q, r, L_);
+
+    for(unsigned int i = 0; i < N; ++i)
+        u_[i] = 0;
+}
+
+void MPCController::update(const ControllerInput& input, ControllerOutput& output)
+{
+    if (!is_set(input.pos_reference) || !is_set(input.measurement))
+        return;
+
+    std::chrono::steady_clock::time_point t_start = std::chrono::steady_clock::now();
+
+    unsigned int m = n_ + 1;
+    unsigned int N = horizon_;
+
+    // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+    //! 1) Estimate the state and disturbance
+
+    if (!initialized_)
+    {
+        // Least-norm state that matches the measurement. The disturbance is preset such that the
+        // preset output (see reset) is the input that holds the plant at rest.
+        double CC = 0;
+        for(unsigned int i = 0; i < n_; ++i)
+            CC += C_[i] * C_[i];
+
+        for(unsigned int i = 0; i < m; ++i)
+            x_[i] = C_[i] * input.measurement / CC;
+
+        x_[n_] = -preset_output_;
+        u_prev_ = preset_output_;
+        preset_output_ = 0;
+        initialized_ = true;
+    }
+    else
+    {
+        double x_pred[M];
+        double y_pred = 0;
+        for(unsigned int i = 0; i < m; ++i)
+        {
+            x_pred[i] = B_[i] * u_prev_;
+            for(unsigned int j = 0; j < m; ++j)
+                x_pred[i] += A_[i][j] * x_[j];
+            y_pred += C_[i] * x_pred[i];
+        }
+
+        double innovation = input.measurement - y_pred;
+        for(unsigned int i = 0; i < m; ++i)
+            x_[i] = x_pred[i] + L_[i] * innovation;
+    }
+
+    // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+    //! 2) Reference over the horizon, extrapolated from the position, velocity and acceleration
+
+    double vel = is_set(input.vel_reference) ? input.vel_reference : 0;
+    double acc = is_set(input.acc_reference) ? input.acc_reference : 0;
+
+    double r[MAX_HORIZON];
+    for(unsigned int k = 0; k < N; ++k)
+    {
+        double t = (k + 1) * dt_;
+        r[k] = input.pos_reference + vel * t + 0.5 * acc * t * t;
+    }
+
+    // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+    //! 3) Linear term of the QP
+
+    double c[MAX_HORIZON];
+    for(unsigned int i = 0; i < N; ++i)
+    {
+        double sum = h_[i] * u_prev_;
+        for(unsigned int j = 0; j < m; ++j)
+            sum += F_[i][j] * x_[j];
+        for(unsigned int k = 0; k < N; ++k)
+            sum += G_[i][k] * r[k];
+        c[i] = sum;
+    }
+
+    // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+    //! 4) Accelerated projected gradient, warm-started with the shifted previous solution
+
+    double limit = is_set(input_limit_) ? input_limit_ : INFINITY;
+
+    double u_old[MAX_HORIZON], y[MAX_HORIZON];
+    for(unsigned int i = 0; i < N; ++i)
+        u_old[i] = y[i] = u_[i + 1 < N ? i + 1 : i];
+
+    double t = 1;
+    for(unsigned int it = 0; it < iterations_; ++it)
+    {
+        double t_new = 0.5 * (1 + std::sqrt(1 + 4 * t * t));
+        double beta = (t - 1) / t_new;
+
+        for(unsigned int i = 0; i < N; ++i)
+        {
+            double grad = c[i];
+            for(unsigned int j = 0; j < N; ++j)
+                grad += H_[i][j] * y[j];
+
+            double u = y[i] - step_ * grad;
+            u_[i] = u < -limit ? -limit : (u > limit ? limit : u);
+        }
+
+        for(unsigned int i = 0; i < N; ++i)
+        {
+            y[i] = u_[i] + beta * (u_[i] - u_old[i]);
+            u_old[i] = u_[i];
+        }
+
+        t = t_new;
+    }
+
+    // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+    // Set output
+
+    u_prev_ = u_[0];
+
+    output.value = u_[0];
+    output.error = input.pos_reference - input.measurement;
+
+    double solve_time = std::chrono::duration<double>(std::chrono::steady_clock::now() - t_start).count();
+    if (solve_time > max_solve_time_)
+        max_solve_time_ = solve_time;
+}
+
+unsigned int MPCController::operations() const
+{
+    unsigned int m = n_ + 1;
+    return m * m + horizon_ * (m + horizon_) + iterations_ * horizon_ * horizon_;
+}
+
+void MPCController::applyOutputLimit(double /*requested*/, double applied)
+{
+    // The estimator predicts with the input that was actually applied
+    u_prev_ = applied;
+}
+
+unsigned int MPCController::stateSize() const
+{
+    return (n_ + 1) + horizon_ + 1;
+}
+
+void MPCController::saveState(double* state) const
+{
+    for(unsigned int i = 0; i < n_ + 1; ++i)
+        state[i] = x_[i];
+    for(unsigned int i = 0; i < horizon_; ++i)
+        state[n_ + 1 + i] = u_[i];
+    state[n_ + 1 + horizon_] = u_prev_;
+}
+
+void MPCController::restoreState(const double* state)
+{
+    for(unsigned int i = 0; i < n_ + 1; ++i)
+        x_[i] = state[i];
+    for(unsigned int i = 0; i < horizon_; ++i)
+        u_[i] = state[n_ + 1 + i];
+    u_prev_ = state[n_ + 1 + horizon_];
+    initialized_ = true;
+}
+
+void MPCController::reset()
+{
+    reset(0, ControllerInput());
+}
+
+void MPCController::reset(double initial_output, const ControllerInput& /*input*/)
+{
+    // The state is re-initialized from the next measurement. The disturbance estimate is preset
+    // such that the initial output holds the plant in steady state.
+    initialized_ = false;
+    preset_output_ = initial_output;
+    for(unsigned int i = 0; i < horizon_; ++i)
+        u_[i] = initial_output;
+}
+
+}
+
+}
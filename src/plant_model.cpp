@@ -0,0 +1,212 @@
+#include "tue/control/plant_model.h"
+
+#include <cmath>
+
+namespace tue
+{
+namespace control
+{
+
+// ----------------------------------------------------------------------------------------------------
+
+PlantModel::PlantModel()
+{
+    setParameters(PlantParameters());
+}
+
+// ----------------------------------------------------------------------------------------------------
+
+PlantModel::PlantModel(const PlantParameters& params)
+{
+    setParameters(params);
+}
+
+// ----------------------------------------------------------------------------------------------------
+
+PlantModel::~PlantModel()
+{
+}
+
+// ----------------------------------------------------------------------------------------------------
+
+void PlantModel::configure(tue::Configuration& config)
+{
+    PlantParameters params;
+
+    std::string type;
+    config.value("type", type);
+
+    if (type == "mass")
+        params.type = PLANT_MASS;
+    else if (type == "mass_spring_damper")
+        params.type = PLANT_MASS_SPRING_DAMPER;
+    else if (type == "two_mass")
+        params.type = PLANT_TWO_MASS;
+    else
+        config.addError("Unknown plant type: '" + type + "'");
+
+    config.value("mass", params.mass);
+
+    if (params.type != PLANT_MASS)
+    {
+        config.value("stiffness", params.stiffness);
+        config.value("damping", params.damping, tue::OPTIONAL);
+    }
+
+    if (params.type == PLANT_TWO_MASS)
+    {
+        config.value("load_mass", params.load_mass);
+
+        std::string sensor = "motor";
+        config.value("sensor", sensor, tue::OPTIONAL);
+
+        if (sensor == "load")
+            params.measure_load = true;
+        else if (sensor != "motor")
+            config.addError("Unknown sensor: '" + sensor + "'");
+    }
+
+    if (config.readGroup("friction"))
+    {
+        config.value("coulomb", params.coulomb, tue::OPTIONAL);
+        config.value("viscous", params.viscous, tue::OPTIONAL);
+        config.endGroup();
+    }
+
+    config.value("backlash", params.backlash, tue::OPTIONAL);
+    config.value("resolution", params.resolution, tue::OPTIONAL);
+
+    int delay = 0;
+    config.value("delay", delay, tue::OPTIONAL);
+
+    if (!(params.mass > 0) || (params.type == PLANT_TWO_MASS && !(params.load_mass > 0)))
+        config.addError("mass <= 0 || load_mass <= 0");
+
+    if (params.stiffness < 0 || params.damping < 0 || params.coulomb < 0 || params.viscous < 0)
+        config.addError("stiffness, damping and friction must be >= 0");
+
+    if (params.backlash < 0 || params.resolution < 0 || delay < 0)
+        config.addError("backlash < 0 || resolution < 0 || delay < 0");
+
+    if (config.hasError())
+        return;
+
+    params.delay = delay;
+    setParameters(params);
+}
+
+// ----------------------------------------------------------------------------------------------------
+
+void PlantModel::setParameters(const PlantParameters& params)
+{
+    params_ = params;
+    history_.resize(params_.delay + 1);
+    reset(0);
+}
+
+// ----------------------------------------------------------------------------------------------------
+
+void PlantModel::reset(double position)
+{
+    pos_ = position;
+    vel_ = 0;
+    load_pos_ = position;
+    load_vel_ = 0;
+    sensor_pos_ = position;
+
+    index_ = 0;
+    double y = sense();
+    for(unsigned int i = 0; i < history_.size(); ++i)
+        history_[i] = y;
+}
+
+// ----------------------------------------------------------------------------------------------------
+
+void PlantModel::update(double f, double dt)
+{
+    const PlantParameters& p = params_;
+
+    if (p.type == PLANT_TWO_MASS)
+    {
+        // Coupling force, which only acts once the play between motor and load is taken up
+        double deflection = pos_ - load_pos_;
+        double half_play = p.backlash / 2;
+
+        double f_coupling = 0;
+        if (deflection > half_play)
+            f_coupling = p.stiffness * (deflection - half_play) + p.damping * (vel_ - load_vel_);
+        else if (deflection < -half_play)
+            f_coupling = p.stiffness * (deflection + half_play) + p.damping * (vel_ - load_vel_);
+
+        vel_ = integrateVelocity(vel_, f - f_coupling, p.mass, dt);
+        load_vel_ += dt * (f_coupling / p.load_mass);
+
+        pos_ += dt * vel_;
+        load_pos_ += dt * load_vel_;
+    }
+    else
+    {
+        // Without a spring (mass), stiffness and damping are 0
+        vel_ = integrateVelocity(vel_, f - p.stiffness * pos_ - p.damping * vel_, p.mass, dt);
+        pos_ += dt * vel_;
+
+        // The sensor only follows once the play is taken up
+        double half_play = p.backlash / 2;
+        if (pos_ - sensor_pos_ > half_play)
+            sensor_pos_ = pos_ - half_play;
+        else if (pos_ - sensor_pos_ < -half_play)
+            sensor_pos_ = pos_ + half_play;
+    }
+
+    index_ = (index_ + 1) % history_.size();
+    history_[index_] = sense();
+}
+
+// ----------------------------------------------------------------------------------------------------
+
+double PlantModel::integrateVelocity(double v, double f, double m, double dt) const
+{
+    f -= params_.viscous * v;
+
+    double fc = params_.coulomb;
+    if (fc == 0)
+        return v + dt * (f / m);
+
+    // Stiction: at rest, the mass only starts moving if the other forces exceed the friction
+    if (v == 0)
+    {
+        if (std::abs(f) <= fc)
+            return 0;
+        return dt * (f - (f > 0 ? fc : -fc)) / m;
+    }
+
+    double v_new = v + dt * (f - (v > 0 ? fc : -fc)) / m;
+
+    // Friction stops the mass within this step, but does not reverse it
+    if ((v > 0) != (v_new > 0))
+        return 0;
+
+    return v_new;
+}
+
+// ----------------------------------------------------------------------------------------------------
+
+double PlantModel::sense() const
+{
+    double y;
+    if (params_.type == PLANT_TWO_MASS)
+        y = position();
+    else
+        y = sensor_pos_;
+
+    if (params_.resolution > 0)
+        y = std::floor(y / params_.resolution) * params_.resolution;
+
+    return y;
+}
+
+// ----------------------------------------------------------------------------------------------------
+
+} // end namespace control
+
+} // end namespace tue
@@ -0,0 +1,167 @@
+#include "tue/control/plant_server.h"
+
+#include <algorithm>
+#include <chrono>
+#include <pthread.h>
+
+namespace tue
+{
+namespace control
+{
+
+// ----------------------------------------------------------------------------------------------------
+
+PlantServer::PlantServer() : cycles_(0), running_(false)
+{
+}
+
+// ----------------------------------------------------------------------------------------------------
+
+PlantServer::~PlantServer()
+{
+    stop();
+}
+
+// ----------------------------------------------------------------------------------------------------
+
+void PlantServer::addPlant(const std::shared_ptr<PlantModel>& plant)
+{
+    plants_.push_back(plant);
+}
+
+// ----------------------------------------------------------------------------------------------------
+
+bool PlantServer::open(const std::string& name)
+{
+    if (!image_.create(name, plants_.size()))
+        return false;
+
+    outputs_.cycle = 0;
+    std::fill(outputs_.values, outputs_.values + MAX_PROCESS_IMAGE_JOINTS, 0.0);
+
+    cycles_.store(0, std::memory_order_release);
+    statistics_ = PlantServerStatistics();
+
+    writeInputs();
+
+    return true;
+}
+
+// ----------------------------------------------------------------------------------------------------
+
+void PlantServer::close()
+{
+    stop();
+    image_.unlink();
+    image_.close();
+}
+
+// ----------------------------------------------------------------------------------------------------
+
+bool PlantServer::start(double period, int priority)
+{
+    stop();
+
+    running_ = true;
+    thread_ = std::thread(&PlantServer::run, this, period);
+
+    if (priority <= 0)
+        return true;
+
+    sched_param param;
+    param.sched_priority = priority;
+    return pthread_setschedparam(thread_.native_handle(), SCHED_FIFO, &param) == 0;
+}
+
+// ----------------------------------------------------------------------------------------------------
+
+void PlantServer::stop()
+{
+    running_ = false;
+    if (thread_.joinable())
+        thread_.join();
+}
+
+// ----------------------------------------------------------------------------------------------------
+
+void PlantServer::run(double period)
+{
+    typedef std::chrono::steady_clock Clock;
+
+    Clock::duration step = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(period));
+    Clock::time_point t_next = Clock::now();
+
+    while(running_)
+    {
+        Clock::time_point t = Clock::now();
+        statistics_.wakeup_latency_max = std::max(statistics_.wakeup_latency_max,
+                                                  std::chrono::duration<double>(t - t_next).count());
+
+        cycle(period);
+
+        t_next += step;
+        if (t_next < t)
+            t_next = t + step; // Overrun: do not try to catch up
+
+        std::this_thread::sleep_until(t_next);
+    }
+}
+
+// ----------------------------------------------------------------------------------------------------
+
+void PlantServer::cycle(double dt)
+{
+    unsigned long bus_cycle = cycles_.load(std::memory_order_relaxed) + 1;
+
+    // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+    // Take the outputs, if the controller side answered since the previous cycle
+
+    ProcessData outputs;
+    if (image_.readOutputs(outputs) && outputs.cycle > outputs_.cycle && outputs.cycle <= bus_cycle)
+    {
+        if (bus_cycle - outputs.cycle < HISTORY_SIZE)
+        {
+            double response_time = outputs.timestamp - input_times_[outputs.cycle % HISTORY_SIZE];
+
+            PlantServerStatistics& s = statistics_;
+            s.response_time_mean = (s.response_time_mean * s.responses + response_time) / (s.responses + 1);
+            s.response_time_max = std::max(s.response_time_max, response_time);
+            ++s.responses;
+        }
+
+        outputs_ = outputs;
+    }
+    else
+        ++statistics_.missed;
+
+    // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+    // Step the plants, and publish the measurements of the next cycle
+
+    for(unsigned int i = 0; i < plants_.size(); ++i)
+        plants_[i]->update(outputs_.values[i], dt);
+
+    ++statistics_.cycles;
+    cycles_.store(bus_cycle, std::memory_order_release);
+
+    writeInputs();
+}
+
+// ----------------------------------------------------------------------------------------------------
+
+void PlantServer::writeInputs()
+{
+    // Bus cycle of these inputs (the initial measurements are cycle 1)
+    unsigned long cycle = cycles_.load(std::memory_order_relaxed) + 1;
+
+    for(unsigned int i = 0; i < plants_.size(); ++i)
+        measurements_[i] = plants_[i]->measurement();
+
+    input_times_[cycle % HISTORY_SIZE] = ProcessImage::now();
+    image_.writeInputs(cycle, measurements_);
+}
+
+// ----------------------------------------------------------------------------------------------------
+
+} // end namespace control
+
+} // end namespace tue
@@ -0,0 +1,233 @@
+#include "tue/control/process_image.h"
+
+#include <algorithm>
+#include <chrono>
+#include <thread>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace tue
+{
+namespace control
+{
+
+// ----------------------------------------------------------------------------------------------------
+
+ProcessImage::ProcessImage() : buffer_(0)
+{
+}
+
+// ----------------------------------------------------------------------------------------------------
+
+ProcessImage::~ProcessImage()
+{
+    close();
+}
+
+// ----------------------------------------------------------------------------------------------------
+
+bool ProcessImage::create(const std::string& name, unsigned int num_joints)
+{
+    close();
+
+    if (num_joints > MAX_PROCESS_IMAGE_JOINTS)
+    {
+        error_msg_ = "Too many joints (more than MAX_PROCESS_IMAGE_JOINTS)";
+        return false;
+    }
+
+    if (!map(name, true))
+        return false;
+
+    // Nothing written yet
+    buffer_->input_sequence.store(0, std::memory_order_relaxed);
+    buffer_->output_sequence.store(0, std::memory_order_relaxed);
+    buffer_->num_joints = num_joints;
+    std::atomic_thread_fence(std::memory_order_release);
+
+    return true;
+}
+
+// ----------------------------------------------------------------------------------------------------
+
+bool ProcessImage::open(const std::string& name)
+{
+    close();
+
+    if (!map(name, false))
+        return false;
+
+    if (buffer_->num_joints > MAX_PROCESS_IMAGE_JOINTS)
+    {
+        close();
+        error_msg_ = "Shared memory '" + name + "' is not a valid process image";
+        return false;
+    }
+
+    return true;
+}
+
+// ----------------------------------------------------------------------------------------------------
+
+bool ProcessImage::map(const std::string& name, bool create)
+{
+    int fd = shm_open(("/" + name).c_str(), create ? O_RDWR | O_CREAT : O_RDWR, 0600);
+    if (fd < 0)
+    {
+        error_msg_ = "Could not open shared memory '" + name + "'";
+        return false;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (st.st_size != sizeof(ProcessImageBuffer)
+                                && (!create || ftruncate(fd, sizeof(ProcessImageBuffer)) != 0)))
+    {
+        ::close(fd);
+        error_msg_ = "Could not size shared memory '" + name + "'";
+        return false;
+    }
+
+    void* p = mmap(0, sizeof(ProcessImageBuffer), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+
+    if (p == MAP_FAILED)
+    {
+        error_msg_ = "Could not map shared memory '" + name + "'";
+        return false;
+    }
+
+    buffer_ = static_cast<ProcessImageBuffer*>(p);
+    name_ = name;
+
+    return true;
+}
+
+// ----------------------------------------------------------------------------------------------------
+
+void ProcessImage::close()
+{
+    if (buffer_)
+    {
+        munmap(buffer_, sizeof(ProcessImageBuffer));
+        buffer_ = 0;
+    }
+}
+
+// ----------------------------------------------------------------------------------------------------
+
+void ProcessImage::unlink()
+{
+    if (!name_.empty())
+        shm_unlink(("/" + name_).c_str());
+}
+
+// ----------------------------------------------------------------------------------------------------
+
+void ProcessImage::writeInputs(unsigned long cycle, const double* measurements)
+{
+    if (buffer_)
+        write(buffer_->input_sequence, buffer_->inputs, cycle, measurements);
+}
+
+// ----------------------------------------------------------------------------------------------------
+
+bool ProcessImage::readOutputs(ProcessData& outputs) const
+{
+    return buffer_ && read(buffer_->output_sequence, buffer_->outputs, outputs);
+}
+
+// ----------------------------------------------------------------------------------------------------
+
+bool ProcessImage::readInputs(ProcessData& inputs) const
+{
+    return buffer_ && read(buffer_->input_sequence, buffer_->inputs, inputs);
+}
+
+// ----------------------------------------------------------------------------------------------------
+
+bool ProcessImage::waitForInputs(unsigned long last_cycle, ProcessData& inputs, double timeout) const
+{
+    double t_end = now() + timeout;
+
+    while(true)
+    {
+        if (readInputs(inputs) && inputs.cycle > last_cycle)
+            return true;
+
+        if (now() > t_end)
+            return false;
+
+        std::this_thread::sleep_for(std::chrono::microseconds(10));
+    }
+}
+
+// ----------------------------------------------------------------------------------------------------
+
+void ProcessImage::writeOutputs(unsigned long cycle, const double* outputs)
+{
+    if (buffer_)
+        write(buffer_->output_sequence, buffer_->outputs, cycle, outputs);
+}
+
+// ----------------------------------------------------------------------------------------------------
+
+double ProcessImage::now()
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// ----------------------------------------------------------------------------------------------------
+
+void ProcessImage::write(std::atomic<unsigned long>& sequence, ProcessData& data, unsigned long cycle,
+                         const double* values)
+{
+    // Only this side writes the sequence, so it is even here, unless a previous writer (e.g. a
+    // controller process that was restarted) died while writing
+    unsigned long s = sequence.load(std::memory_order_relaxed) & ~1UL;
+
+    // Mark the data as being written before touching it
+    sequence.store(s + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    data.cycle = cycle;
+    data.timestamp = now();
+    std::copy(values, values + buffer_->num_joints, data.values);
+
+    sequence.store(s + 2, std::memory_order_release);
+}
+
+// ----------------------------------------------------------------------------------------------------
+
+bool ProcessImage::read(const std::atomic<unsigned long>& sequence, const ProcessData& data, ProcessData& copy) const
+{
+    for(unsigned int attempt = 0; attempt < 100; ++attempt)
+    {
+        unsigned long s = sequence.load(std::memory_order_acquire);
+        if (s == 0)
+            return false;
+
+        if ((s & 1) == 0)
+        {
+            copy.cycle = data.cycle;
+            copy.timestamp = data.timestamp;
+            std::copy(data.values, data.values + buffer_->num_joints, copy.values);
+
+            // The copy must be complete before the sequence is checked again
+            std::atomic_thread_fence(std::memory_order_acquire);
+
+            if (sequence.load(std::memory_order_relaxed) == s)
+                return true;
+        }
+    }
+
+    return false;
+}
+
+// ----------------------------------------------------------------------------------------------------
+
+} // end namespace control
+
+} // end namespace tue
@@ -0,0 +1,162 @@
+#include "tue/control/smith_predictor.h"
+
+namespace tue
+{
+
+namespace control
+{
+
+SmithPredictor::SmithPredictor() : dt_(0), delay_(0), mass_(1), damping_(0), model_pos_(0), model_vel_(0),
+    model_pos_before_(0), model_vel_before_(0), model_dt_(0), history_index_(0)
+{
+    for(unsigned int i = 0; i < MAX_DELAY; ++i)
+        history_[i] = 0;
+}
+
+SmithPredictor::~SmithPredictor()
+{
+}
+
+void SmithPredictor::configure(tue::Configuration& config, double dt)
+{
+    if (!controller_)
+    {
+        config.addError("Delay compensation: no controller to wrap");
+        return;
+    }
+
+    dt_ = dt;
+
+    //! Get the delay
+    int delay;
+    if (config.value("delay", delay))
+    {
+        if (delay < 0 || delay >= static_cast<int>(MAX_DELAY))
+            config.addError("Delay compensation: delay must be in [0, MAX_DELAY)");
+        else
+            delay_ = delay;
+    }
+
+    //! Get the plant model
+    if (config.readGroup("model", tue::REQUIRED))
+    {
+        config.value("mass", mass_);
+        config.value("damping", damping_, tue::OPTIONAL);
+
+        if (mass_ == 0)
+            config.addError("Delay compensation: mass == 0");
+
+        config.endGroup();
+    }
+
+    //! Reset the model
+    model_pos_ = 0;
+    model_vel_ = 0;
+    history_index_ = 0;
+    for(unsigned int i = 0; i < MAX_DELAY; ++i)
+        history_[i] = 0;
+}
+
+void SmithPredictor::update(const ControllerInput& input, ControllerOutput& output)
+{
+    // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+    //! 1) Store the current model position and look up the delayed one
+
+    history_index_ = (history_index_ + 1) % MAX_DELAY;
+    history_[history_index_] = model_pos_;
+
+    double delayed_model_pos = history_[(history_index_ + MAX_DELAY - delay_) % MAX_DELAY];
+
+    // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+    //! 2) Update the wrapped controller with the predicted measurement
+
+    ControllerInput predicted_input = input;
+    if (is_set(input.measurement))
+        predicted_input.measurement = input.measurement + model_pos_ - delayed_model_pos;
+
+    controller_->update(predicted_input, output);
+
+    // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+    //! 3) Drive the plant model with the controller output
+
+    model_dt_ = is_set(input.dt) ? input.dt : dt_;
+    model_pos_before_ = model_pos_;
+    model_vel_before_ = model_vel_;
+
+    if (is_set(output.value))
+        updateModel(output.value);
+
+    // The error is reported with respect to the actual (delayed) measurement
+    if (is_set(input.pos_reference) && is_set(input.measurement))
+        output.error = input.pos_reference - input.measurement;
+
+    return;
+}
+
+void SmithPredictor::updateModel(double u)
+{
+    double acc = (u - damping_ * model_vel_) / mass_;
+    model_vel_ += model_dt_ * acc;
+    model_pos_ += model_dt_ * model_vel_;
+}
+
+void SmithPredictor::applyOutputLimit(double requested, double applied)
+{
+    // Redo the last model step with the output that was actually applied, such that the prediction
+    // does not diverge from the plant while saturated
+    model_pos_ = model_pos_before_;
+    model_vel_ = model_vel_before_;
+    updateModel(applied);
+
+    controller_->applyOutputLimit(requested, applied);
+}
+
+unsigned int SmithPredictor::stateSize() const
+{
+    return 2 + delay_ + controller_->stateSize();
+}
+
+void SmithPredictor::saveState(double* state) const
+{
+    state[0] = model_pos_;
+    state[1] = model_vel_;
+
+    // The last 'delay' model positions, newest first
+    for(unsigned int k = 0; k < delay_; ++k)
+        state[2 + k] = history_[(history_index_ + MAX_DELAY - k) % MAX_DELAY];
+
+    controller_->saveState(state + 2 + delay_);
+}
+
+void SmithPredictor::restoreState(const double* state)
+{
+    model_pos_ = state[0];
+    model_vel_ = state[1];
+
+    history_index_ = 0;
+    for(unsigned int k = 0; k < delay_; ++k)
+        history_[(MAX_DELAY - k) % MAX_DELAY] = state[2 + k];
+
+    controller_->restoreState(state + 2 + delay_);
+}
+
+void SmithPredictor::reset()
+{
+    reset(0, ControllerInput());
+}
+
+void SmithPredictor::reset(double initial_output, const ControllerInput& input)
+{
+    // The model restarts at rest; the prediction correction (model - delayed model) is zero
+    model_pos_ = 0;
+    model_vel_ = 0;
+    history_index_ = 0;
+    for(unsigned int i = 0; i < MAX_DELAY; ++i)
+        history_[i] = 0;
+
+    controller_->reset(initial_output, input);
+}
+
+}
+
+}
@@ -0,0 +1,126 @@
+#include "tue/control/snapshot_publisher.h"
+
+#include <algorithm>
+
+namespace tue
+{
+namespace control
+{
+
+// ----------------------------------------------------------------------------------------------------
+
+SnapshotPublisher::SnapshotPublisher() : num_slots_(0), published_(0)
+{
+}
+
+// ----------------------------------------------------------------------------------------------------
+
+SnapshotPublisher::~SnapshotPublisher()
+{
+}
+
+// ----------------------------------------------------------------------------------------------------
+
+void SnapshotPublisher::addController(const std::shared_ptr<SupervisedController>& controller)
+{
+    controllers_.push_back(controller);
+}
+
+// ----------------------------------------------------------------------------------------------------
+
+void SnapshotPublisher::initialize(unsigned int num_slots)
+{
+    num_slots_ = std::max(2u, num_slots);
+
+    std::vector<std::atomic<unsigned long> > sequences(num_slots_);
+    sequences_.swap(sequences);
+    for(unsigned int i = 0; i < num_slots_; ++i)
+        sequences_[i].store(0, std::memory_order_relaxed);
+
+    slot_ticks_.assign(num_slots_, 0);
+    slots_.resize(num_slots_ * controllers_.size());
+
+    published_.store(0, std::memory_order_release);
+}
+
+// ----------------------------------------------------------------------------------------------------
+
+void SnapshotPublisher::publish()
+{
+    if (num_slots_ == 0)
+        return;
+
+    // Only the writer changes these, so relaxed loads suffice
+    unsigned long tick = published_.load(std::memory_order_relaxed) + 1;
+    unsigned int slot = tick % num_slots_;
+
+    std::atomic<unsigned long>& sequence = sequences_[slot];
+    unsigned long s = sequence.load(std::memory_order_relaxed);
+
+    // Mark the slot as being written before touching its data
+    sequence.store(s + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    slot_ticks_[slot] = tick;
+
+    JointSnapshot* joints = &slots_[slot * controllers_.size()];
+    for(unsigned int i = 0; i < controllers_.size(); ++i)
+    {
+        const SupervisedController& c = *controllers_[i];
+        JointSnapshot& j = joints[i];
+
+        j.status = c.status();
+        j.homed = c.is_homed();
+        j.measurement = c.measurement();
+        j.pos_reference = c.reference_position();
+        j.vel_reference = c.reference_velocity();
+        j.acc_reference = c.reference_acceleration();
+        j.output = c.output();
+        j.error = c.error();
+        j.output_clamp = c.output_clamp();
+    }
+
+    sequence.store(s + 2, std::memory_order_release);
+    published_.store(tick, std::memory_order_release);
+}
+
+// ----------------------------------------------------------------------------------------------------
+
+bool SnapshotPublisher::read(std::vector<JointSnapshot>& joints, unsigned long& tick, unsigned int& retries) const
+{
+    joints.resize(controllers_.size());
+    retries = 0;
+
+    while(true)
+    {
+        unsigned long latest = published_.load(std::memory_order_acquire);
+        if (latest == 0)
+            return false;
+
+        unsigned int slot = latest % num_slots_;
+
+        const std::atomic<unsigned long>& sequence = sequences_[slot];
+        unsigned long s = sequence.load(std::memory_order_acquire);
+
+        if ((s & 1) == 0)
+        {
+            tick = slot_ticks_[slot];
+            std::copy(slots_.begin() + slot * controllers_.size(), slots_.begin() + (slot + 1) * controllers_.size(),
+                      joints.begin());
+
+            // The copy must be complete before the sequence is checked again
+            std::atomic_thread_fence(std::memory_order_acquire);
+
+            if (sequence.load(std::memory_order_relaxed) == s && tick == latest)
+                return true;
+        }
+
+        ++retries;
+    }
+}
+
+// ----------------------------------------------------------------------------------------------------
+
+} // end namespace control
+
+} // end namespace tue
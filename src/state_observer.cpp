@@ -0,0 +1,223 @@
+#include "tue/control/state_observer.h"
+
+#include "tue/control/generic.h"
+
+namespace tue
+{
+namespace control
+{
+
+namespace
+{
+
+// Computes the steady-state Kalman gains by iterating the Riccati equation until the gains converge
+void steadyStateKalmanGains(const ObserverCoefficients& c, const double q[3], double r, double k[3])
+{
+    // State transition matrix for state (pos, vel, dist)
+    const double A[3][3] = { { 1, c.dt, c.b_pos },
+                             { 0,    1, c.b_vel },
+                             { 0,    0,     1 } };
+
+    double P[3][3] = { { q[0], 0, 0 }, { 0, q[1], 0 }, { 0, 0, q[2] } };
+
+    k[0] = k[1] = k[2] = 0;
+
+    for(int it = 0; it < 100000; ++it)
+    {
+        // Prediction: Pp = A P A' + Q
+        double AP[3][3], Pp[3][3];
+        for(int i = 0; i < 3; ++i)
+            for(int j = 0; j < 3; ++j)
+                AP[i][j] = A[i][0] * P[0][j] + A[i][1] * P[1][j] + A[i][2] * P[2][j];
+
+        for(int i = 0; i < 3; ++i)
+            for(int j = 0; j < 3; ++j)
+                Pp[i][j] = AP[i][0] * A[j][0] + AP[i][1] * A[j][1] + AP[i][2] * A[j][2] + (i == j ? q[i] : 0);
+
+        // Gain (position is measured): K = Pp C' / (C Pp C' + R)
+        double s = Pp[0][0] + r;
+        double k_new[3] = { Pp[0][0] / s, Pp[1][0] / s, Pp[2][0] / s };
+
+        // Correction: P = (I - K C) Pp
+        for(int i = 0; i < 3; ++i)
+            for(int j = 0; j < 3; ++j)
+                P[i][j] = Pp[i][j] - k_new[i] * Pp[0][j];
+
+        double diff = std::abs(k_new[0] - k[0]) + std::abs(k_new[1] - k[1]) + std::abs(k_new[2] - k[2]);
+        k[0] = k_new[0]; k[1] = k_new[1]; k[2] = k_new[2];
+
+        if (diff < 1e-15)
+            break;
+    }
+}
+
+}
+
+// ----------------------------------------------------------------------------------------------------
+
+StateObserver::StateObserver() : configured_(false), initialized_(false), pos_(INVALID_DOUBLE),
+    vel_(INVALID_DOUBLE), dist_(INVALID_DOUBLE)
+{
+}
+
+// ----------------------------------------------------------------------------------------------------
+
+StateObserver::~StateObserver()
+{
+}
+
+// ----------------------------------------------------------------------------------------------------
+
+void StateObserver::configure(tue::Configuration& config, double dt)
+{
+    configured_ = false;
+    initialized_ = false;
+
+    coefficients_ = ObserverCoefficients();
+    coefficients_.dt = dt;
+
+    // Only the errors of the observer parameters count (the configuration may have unrelated errors
+    // already)
+    std::string type;
+    bool valid = config.value("type", type);
+
+    double mass = INVALID_DOUBLE;
+    if (!config.value("mass", mass, (type == "kalman" ? tue::REQUIRED : tue::OPTIONAL)) && type == "kalman")
+        valid = false;
+
+    if (is_set(mass))
+    {
+        if (mass == 0)
+        {
+            config.addError("Observer: mass == 0");
+            return;
+        }
+
+        coefficients_.b_pos = dt * dt / (2 * mass);
+        coefficients_.b_vel = dt / mass;
+    }
+
+    if (type == "alpha_beta")
+    {
+        double alpha = 0, beta = 0, gamma = 0;
+        valid &= config.value("alpha", alpha);
+        valid &= config.value("beta", beta);
+        config.value("gamma", gamma, tue::OPTIONAL);
+
+        if (alpha <= 0 || alpha > 1 || beta <= 0 || gamma < 0)
+        {
+            config.addError("Observer: alpha must be in (0, 1], beta > 0, gamma >= 0");
+            valid = false;
+        }
+
+        if (gamma > 0 && !is_set(mass))
+        {
+            config.addError("Observer: gamma (disturbance estimation) requires a mass");
+            valid = false;
+        }
+
+        coefficients_.k_pos = alpha;
+        coefficients_.k_vel = beta / dt;
+        if (gamma > 0)
+            coefficients_.k_dist = 2 * gamma * mass / (dt * dt);
+    }
+    else if (type == "kalman")
+    {
+        double q[3] = { 0, 0, 0 };
+        double r = 0;
+
+        if (config.readGroup("process_noise", tue::REQUIRED))
+        {
+            config.value("position", q[0], tue::OPTIONAL);
+            config.value("velocity", q[1], tue::OPTIONAL);
+            config.value("disturbance", q[2], tue::OPTIONAL);
+            config.endGroup();
+        }
+        else
+            valid = false;
+
+        valid &= config.value("measurement_noise", r);
+
+        if (q[0] < 0 || q[1] < 0 || q[2] < 0 || r <= 0)
+        {
+            config.addError("Observer: process noise must be >= 0 and measurement noise > 0");
+            valid = false;
+        }
+
+        if (!valid)
+            return;
+
+        double k[3];
+        steadyStateKalmanGains(coefficients_, q, r, k);
+
+        coefficients_.k_pos = k[0];
+        coefficients_.k_vel = k[1];
+        coefficients_.k_dist = k[2];
+    }
+    else
+    {
+        config.addError("Observer: unknown type '" + type + "'");
+        valid = false;
+    }
+
+    configured_ = valid;
+}
+
+// ----------------------------------------------------------------------------------------------------
+
+void StateObserver::reset(double position)
+{
+    pos_ = position;
+    vel_ = 0;
+    dist_ = 0;
+    initialized_ = is_set(position);
+}
+
+// ----------------------------------------------------------------------------------------------------
+
+void StateObserver::setState(double position, double velocity, double disturbance)
+{
+    pos_ = position;
+    vel_ = velocity;
+    dist_ = disturbance;
+    initialized_ = is_set(position);
+}
+
+// ----------------------------------------------------------------------------------------------------
+
+void StateObserver::update(double measurement, double input, double dt)
+{
+    if (!is_set(measurement))
+        return;
+
+    if (!initialized_)
+    {
+        reset(measurement);
+        return;
+    }
+
+    if (!is_set(input))
+        input = 0;
+
+    if (!is_set(dt) || dt == coefficients_.dt)
+    {
+        updateObserver(coefficients_, measurement, input, pos_, vel_, dist_);
+        return;
+    }
+
+    // Input to position / velocity scale with dt^2 and dt
+    ObserverCoefficients c = coefficients_;
+    double r = dt / coefficients_.dt;
+    c.dt = dt;
+    c.b_pos *= r * r;
+    c.b_vel *= r;
+
+    updateObserver(c, measurement, input, pos_, vel_, dist_);
+}
+
+// ----------------------------------------------------------------------------------------------------
+
+} // end namespace control
+
+} // end namespace tue
+
@@ -1,6 +1,12 @@
 #include "tue/control/supervised_controller.h"
 
 #include <tue/control/controller.h>
+#include <tue/control/system_identification.h>
+
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <new>
 
 namespace tue
 {
@@ -9,8 +15,12 @@ namespace control
 
 // ----------------------------------------------------------------------------------------------------
 
-SupervisedController::SupervisedController() : event_(NONE), measurement_offset(0),
-    error_(INVALID_DOUBLE), output_(INVALID_DOUBLE), output_saturation_(INVALID_DOUBLE), max_error_(INVALID_DOUBLE)
+SupervisedController::SupervisedController() : core_(0), inline_type_(INLINE_NONE), event_(NONE),
+    output_(INVALID_DOUBLE), error_(INVALID_DOUBLE), previous_output_(INVALID_DOUBLE), bumpless_output_(INVALID_DOUBLE),
+    measurement_offset(0),
+    output_clamp_(0), output_saturation_(INVALID_DOUBLE), max_error_(INVALID_DOUBLE), slew_rate_(INVALID_DOUBLE),
+    anti_windup_(true), last_timestamp_(INVALID_DOUBLE),
+    heartbeat_(0), heartbeat_time_(INVALID_DOUBLE), late_ticks_(0), missed_ticks_(0), watchdog_tripped_(false)
 {
     input_.measurement = INVALID_DOUBLE;
 }
@@ -19,6 +29,85 @@ SupervisedController::SupervisedController() : event_(NONE), measurement_offset(
 
 SupervisedController::~SupervisedController()
 {
+    clearController();
+}
+
+// ----------------------------------------------------------------------------------------------------
+
+void* SupervisedController::operator new(std::size_t size)
+{
+    void* p = 0;
+    if (posix_memalign(&p, alignof(SupervisedController), size) != 0)
+        throw std::bad_alloc();
+    return p;
+}
+
+// ----------------------------------------------------------------------------------------------------
+
+void SupervisedController::operator delete(void* p)
+{
+    free(p);
+}
+
+// ----------------------------------------------------------------------------------------------------
+
+void SupervisedController::clearController()
+{
+    if (inline_type_ != INLINE_NONE)
+        core_->~Controller();
+
+    controller_.reset();
+    inline_type_ = INLINE_NONE;
+    core_ = 0;
+}
+
+// ----------------------------------------------------------------------------------------------------
+
+void SupervisedController::setController(const std::shared_ptr<Controller>& controller)
+{
+    clearController();
+    controller_ = controller;
+    core_ = controller_.get();
+}
+
+// ----------------------------------------------------------------------------------------------------
+
+Controller* SupervisedController::emplaceController(InlineControllerType type)
+{
+    clearController();
+
+    switch (type)
+    {
+    case INLINE_GENERIC:
+        core_ = new (&inline_storage_) GenericController;
+        break;
+    case INLINE_SETPOINT:
+        core_ = new (&inline_storage_) SetpointController;
+        break;
+    default:
+        return 0;
+    }
+
+    inline_type_ = type;
+    return core_;
+}
+
+// ----------------------------------------------------------------------------------------------------
+
+void SupervisedController::updateController(const ControllerInput& input, ControllerOutput& output)
+{
+    // Qualified calls: no virtual dispatch for the closed set of types
+    switch (inline_type_)
+    {
+    case INLINE_GENERIC:
+        static_cast<GenericController*>(core_)->GenericController::update(input, output);
+        break;
+    case INLINE_SETPOINT:
+        static_cast<SetpointController*>(core_)->SetpointController::update(input, output);
+        break;
+    default:
+        core_->update(input, output);
+    }
 }
 
 // ----------------------------------------------------------------------------------------------------
@@ -32,9 +121,96 @@ void SupervisedController::configure(tue::Configuration& config, double dt)
     {
         config.value("output_saturation", output_saturation_, tue::OPTIONAL);
         config.value("max_error", max_error_, tue::OPTIONAL);
+        config.value("slew_rate", slew_rate_, tue::OPTIONAL);
+
+        std::string anti_windup = "conditional";
+        config.value("anti_windup", anti_windup, tue::OPTIONAL);
+        if (anti_windup == "conditional")
+            anti_windup_ = true;
+        else if (anti_windup == "none")
+            anti_windup_ = false;
+        else
+            config.addError("Unknown anti_windup: '" + anti_windup + "'");
         config.endGroup(); // End safety
     }
 
+    // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+    // Configure watchdog
+
+    watchdog_ = WatchdogSettings();
+    if (config.readGroup("watchdog"))
+    {
+        config.value("budget", watchdog_.budget);
+        config.value("timeout", watchdog_.timeout);
+
+        std::string fallback = "zero";
+        config.value("fallback", fallback, tue::OPTIONAL);
+        if (fallback == "zero")
+            watchdog_.fallback = FALLBACK_ZERO;
+        else if (fallback == "hold")
+        {
+            watchdog_.fallback = FALLBACK_HOLD;
+            config.value("decay", watchdog_.decay);
+            if (watchdog_.decay <= 0)
+                config.addError("watchdog: decay <= 0");
+        }
+        else
+            config.addError("watchdog: unknown fallback '" + fallback + "' (choose zero or hold)");
+
+        if (watchdog_.budget <= 0 || watchdog_.timeout < watchdog_.budget)
+            config.addError("watchdog: budget <= 0 || timeout < budget");
+
+        config.endGroup();
+    }
+
+    // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+    // Configure measurement pre-processing
+
+    if (config.readGroup("measurement"))
+    {
+        measurement_filter_.configure(config, dt);
+        config.endGroup();
+    }
+
+    // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+    // Configure input shaping (position, velocity and acceleration reference)
+
+    if (config.readGroup("input_shaping"))
+    {
+        input_shaper_.configure(config, dt, 3);
+        config.endGroup();
+    }
+
+    // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+    // Configure observer
+
+    if (config.readGroup("observer"))
+    {
+        observer_.configure(config, dt);
+        config.endGroup();
+    }
+
+    // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+    // Configure identification
+
+    if (config.readGroup("identification"))
+    {
+        identification_.reset(new SystemIdentification);
+        identification_->configure(config, dt);
+        config.endGroup();
+    }
+    else
+        identification_.reset();
+
+    // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+    // Configure statistics
+
+    if (config.readGroup("statistics"))
+    {
+        statistics_.configure(config, dt);
+        config.endGroup();
+    }
+
     // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
     // Configure homing
 
@@ -43,6 +219,40 @@ void SupervisedController::configure(tue::Configuration& config, double dt)
         config.value("velocity", homing_max_vel_);
         config.value("acceleration", homing_max_acc_);
         homing_max_acc_ = std::abs(homing_max_acc_);
+
+        homing_preconditions_.clear();
+        if (config.readArray("preconditions"))
+        {
+            while(config.nextArrayItem())
+            {
+                std::string homed;
+                if (config.value("homed", homed))
+                    homing_preconditions_.push_back(homed);
+            }
+            config.endArray();
+        }
+
+        homing_end_stop_ = HomingEndStop();
+        if (config.readGroup("end_stop"))
+        {
+            config.value("position", homing_end_stop_.position);
+            config.value("error", homing_end_stop_.error, tue::OPTIONAL);
+            config.value("effort", homing_end_stop_.effort, tue::OPTIONAL);
+            config.value("timeout", homing_end_stop_.timeout, tue::OPTIONAL);
+
+            int samples = 1;
+            config.value("samples", samples, tue::OPTIONAL);
+            if (samples < 1)
+                config.addError("end_stop: samples < 1");
+            else
+                homing_end_stop_.samples = samples;
+
+            if (!is_set(homing_end_stop_.error) && !is_set(homing_end_stop_.effort))
+                config.addError("end_stop: specify error and/or effort threshold");
+
+            config.endGroup();
+        }
+
         config.endGroup();
 
         homed_ = false;
@@ -74,6 +284,10 @@ void SupervisedController::checkTransitions(double raw_measurement)
 
         homed_ = true;
 
+        // The measurement jumps with the new offset
+        if (observer_.is_configured())
+            observer_.reset(input_.measurement);
+
         // automatically switch to active after homing
         status_ = IDLE;
         event_ = ENABLE;
@@ -84,6 +298,11 @@ void SupervisedController::checkTransitions(double raw_measurement)
         status_ = HOMING;
         homing_pos = raw_measurement;
         homing_vel = 0;
+
+        resetShaper(homing_pos, 0, 0);
+
+        if (core_)
+            core_->reset();
     }
     else if (event_ == ENABLE && status_ != ACTIVE && homed_ == true)
     {
@@ -93,6 +312,13 @@ void SupervisedController::checkTransitions(double raw_measurement)
         input_.vel_reference = 0;
         input_.acc_reference = 0;
 
+        resetShaper(input_.pos_reference, 0, 0);
+
+        // Bumpless start: continue from the output applied during the previous sample (e.g. the
+        // homing output), without reallocating the controller. The controller is preset at the
+        // first update, since its feedforward depends on the input of that update.
+        bumpless_output_ = is_set(previous_output_) ? previous_output_ : 0;
+
         std::cout << "Controller activated: reset ref to " << input_.pos_reference << std::endl;
 
     }
@@ -107,8 +333,18 @@ void SupervisedController::checkTransitions(double raw_measurement)
 
     if (old_status == ACTIVE && status_ != ACTIVE)
     {
-        // Just switched to not being active.
-        // TODO: reset controllers
+        // Just switched to not being active: clear the controller state in place, such that no
+        // stale integrator state is used when the controller is re-activated
+        if (core_)
+            core_->reset();
+
+        bumpless_output_ = INVALID_DOUBLE;
+
+        // Start new statistics windows at re-activation. The windows completed while active remain
+        // available for diagnosis.
+        statistics_.restart();
+
+        stopIdentification();
     }
 
     event_ = NONE;
@@ -118,9 +354,83 @@ void SupervisedController::checkTransitions(double raw_measurement)
 
 void SupervisedController::update(double raw_measurement)
 {
+    // Nominal sample time
+    input_.dt = INVALID_DOUBLE;
+    step(raw_measurement);
+}
+
+// ----------------------------------------------------------------------------------------------------
+
+void SupervisedController::update(double raw_measurement, double timestamp)
+{
+    // Actual elapsed time. Falls back to the nominal sample time for the first sample, or if the
+    // timestamp did not increase
+    if (is_set(last_timestamp_) && timestamp > last_timestamp_)
+        input_.dt = timestamp - last_timestamp_;
+    else
+        input_.dt = INVALID_DOUBLE;
+
+    last_timestamp_ = timestamp;
+
+    step(raw_measurement);
+}
+
+// ----------------------------------------------------------------------------------------------------
+
+void SupervisedController::beat()
+{
+    // The time of every update is measured here (instead of by the watchdog thread, which only
+    // sees the latest heartbeat), such that every late tick is counted
+    if (watchdog_.is_configured())
+    {
+        double now = std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+
+        double last = heartbeat_time_.load(std::memory_order_relaxed);
+        if (is_set(last) && now - last > watchdog_.budget)
+        {
+            late_ticks_.store(late_ticks_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+
+            long missed = static_cast<long>((now - last) / dt_ + 0.5) - 1;
+            if (missed > 0)
+                missed_ticks_.store(missed_ticks_.load(std::memory_order_relaxed) + missed, std::memory_order_relaxed);
+        }
+
+        heartbeat_time_.store(now, std::memory_order_relaxed);
+    }
+
+    heartbeat_.fetch_add(1, std::memory_order_release);
+}
+
+// ----------------------------------------------------------------------------------------------------
+
+void SupervisedController::step(double raw_measurement)
+{
+    beat();
+
+    if (watchdog_tripped_.exchange(false, std::memory_order_acq_rel))
+        setError("Watchdog: update deadline missed");
+
+    // Output applied during the previous sample (input for the observer)
+    previous_output_ = output_;
+
     output_ = 0;
 
-    if (!is_set(raw_measurement)) // TODO
+    // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+    // Pre-process measurement (spike rejection, rate limiting, dropout extrapolation)
+
+    if (measurement_filter_.is_configured())
+    {
+        raw_measurement = measurement_filter_.update(raw_measurement, input_.dt);
+        if (measurement_filter_.failed())
+        {
+            setError("Measurement dropout budget exceeded");
+            checkTransitions(raw_measurement);
+            return;
+        }
+    }
+
+    // No valid measurement (and none could be extrapolated)
+    if (!is_set(raw_measurement))
         return;
 
     if (status_ == UNINITIALIZED)
@@ -132,6 +442,16 @@ void SupervisedController::update(double raw_measurement)
 
     checkTransitions(raw_measurement);
 
+    // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+    // Update observer
+
+    if (observer_.is_configured())
+    {
+        observer_.update(input_.measurement, previous_output_, input_.dt);
+        input_.vel_estimate = observer_.velocity();
+        input_.disturbance_estimate = observer_.disturbance();
+    }
+
     // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
     // Update controller
 
@@ -139,7 +459,10 @@ void SupervisedController::update(double raw_measurement)
     output.value = 0;
     output.error = INVALID_DOUBLE;
 
-    switch (status())
+    bool identifying = (status_ == ACTIVE && identification_ && identification_->is_running());
+    double excitation = identifying ? identification_->excitation() : 0;
+
+    switch (status_)
     {
 
     case HOMING:
@@ -156,7 +479,33 @@ void SupervisedController::update(double raw_measurement)
         if (!is_set(raw_measurement))
             setError("While active: no or bad measurement received");
         else
-            controller_->update(input_, output);
+        {
+            bool inject_reference = identifying && identification_->injection() == SystemIdentification::REFERENCE;
+
+            // Shaped and / or excited reference (copy only if needed)
+            const ControllerInput* controller_input = &input_;
+            ControllerInput modified_input;
+            if (input_shaper_.is_configured() || inject_reference)
+            {
+                modified_input = input_;
+                shapeReference(modified_input);
+                if (inject_reference)
+                    modified_input.pos_reference += excitation;
+                controller_input = &modified_input;
+            }
+
+            if (is_set(bumpless_output_))
+            {
+                if (core_)
+                    core_->reset(bumpless_output_, *controller_input);
+                bumpless_output_ = INVALID_DOUBLE;
+            }
+
+            updateController(*controller_input, output);
+
+            if (identifying && !inject_reference)
+                output.value += excitation;
+        }
         break;
     }
 
@@ -172,6 +521,8 @@ void SupervisedController::update(double raw_measurement)
     // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
     // Check safety
 
+    output_clamp_ = 0;
+
     if (!is_set(output_))
     {
         setError("Invalid output");
@@ -180,14 +531,39 @@ void SupervisedController::update(double raw_measurement)
     {
         setError("Max error reached");
     }
-    else if (is_set(output_saturation_))   // Output saturation
+    else
     {
-        if (output_ < -output_saturation_)
-            output_ = -output_saturation_;
-        else if (output_ > output_saturation_)
-            output_ = output_saturation_;
+        double requested = output_;
+
+        // Output saturation
+        if (is_set(output_saturation_))
+            output_ = std::min(std::max(output_, -output_saturation_), output_saturation_);
+
+        // Slew rate, with respect to the output applied during the previous sample
+        if (is_set(slew_rate_) && is_set(previous_output_))
+        {
+            double max_step = slew_rate_ * (is_set(input_.dt) ? input_.dt : dt_);
+            output_ = std::min(std::max(output_, previous_output_ - max_step), previous_output_ + max_step);
+        }
+
+        output_clamp_ = output_ - requested;
+
+        // Feed the limit back into the controller (anti-windup)
+        if (output_clamp_ != 0 && anti_windup_ && core_ && (status_ == ACTIVE || status_ == HOMING))
+            core_->applyOutputLimit(requested, output_);
     }
 
+    bool saturated = (output_clamp_ != 0);
+
+    // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+    // Update statistics
+
+    if (status_ == ACTIVE && is_set(error_))
+        statistics_.update(error_, output_, saturated);
+
+    if (identifying)
+        identification_->update(excitation, output_, input_.measurement);
+
     // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
     // We may have an SET_ERROR event, so re-check transitions
 
@@ -200,6 +576,12 @@ void SupervisedController::updateHoming(double measurement, ControllerOutput& ou
 {
     ControllerInput homing_input;
     homing_input.measurement = measurement;
+    homing_input.vel_estimate = input_.vel_estimate;
+    homing_input.disturbance_estimate = input_.disturbance_estimate;
+    homing_input.scheduling_variable = input_.scheduling_variable;
+    homing_input.dt = input_.dt;
+
+    double dt = is_set(input_.dt) ? input_.dt : dt_;
 
     // Determine homing direction based on max_vel sign
     double dir = homing_max_vel_ < 0 ? -1 : 1;
@@ -211,27 +593,163 @@ void SupervisedController::updateHoming(double measurement, ControllerOutput& ou
     homing_input.acc_reference = dir * homing_max_acc_;
 
     // Increase (or decrease if acc < 0) velocity based on acceleration
-    homing_vel += dt_ * homing_input.acc_reference;
+    homing_vel += dt * homing_input.acc_reference;
 
     // Clip velocity between -vel_max and +vel_max
     homing_vel = std::min(std::max(homing_vel, -abs_vel_max), abs_vel_max);
 
     // Increase (or decrease if vel < 0) position based on velocity
-    homing_pos += dt_ * homing_vel;
+    homing_pos += dt * homing_vel;
 
     // Set as set-point for controller
     homing_input.pos_reference = homing_pos;
     homing_input.vel_reference = homing_vel;
 
+    shapeReference(homing_input);
+
     // Update controller
-    controller_->update(homing_input, output);
+    updateController(homing_input, output);
+}
+
+// ----------------------------------------------------------------------------------------------------
+
+void SupervisedController::shapeReference(ControllerInput& input)
+{
+    if (!input_shaper_.is_configured())
+        return;
+
+    double r[3] = { input.pos_reference, input.vel_reference, input.acc_reference };
+    input_shaper_.update(r, r);
+
+    input.pos_reference = r[0];
+    input.vel_reference = r[1];
+    input.acc_reference = r[2];
+}
+
+// ----------------------------------------------------------------------------------------------------
+
+void SupervisedController::resetShaper(double pos, double vel, double acc)
+{
+    if (!input_shaper_.is_configured())
+        return;
+
+    double r[3] = { pos, vel, acc };
+    input_shaper_.reset(r);
+}
+
+// ----------------------------------------------------------------------------------------------------
+
+void SupervisedController::startIdentification()
+{
+    if (identification_ && status_ == ACTIVE)
+        identification_->start();
+}
+
+// ----------------------------------------------------------------------------------------------------
+
+void SupervisedController::stopIdentification()
+{
+    if (identification_)
+        identification_->stop();
+}
+
+// ----------------------------------------------------------------------------------------------------
+
+bool SupervisedController::saveCheckpoint(ControllerCheckpoint& checkpoint) const
+{
+    unsigned int state_size = core_->stateSize();
+    if (state_size > MAX_CHECKPOINT_STATE)
+        return false;
+
+    std::strncpy(checkpoint.name, name().c_str(), MAX_CHECKPOINT_NAME - 1);
+    checkpoint.name[MAX_CHECKPOINT_NAME - 1] = '\0';
+
+    checkpoint.status = status_;
+    checkpoint.homed = homed_;
+    checkpoint.measurement_offset = measurement_offset;
+    checkpoint.homing_pos = homing_pos;
+    checkpoint.homing_vel = homing_vel;
+
+    checkpoint.pos_reference = input_.pos_reference;
+    checkpoint.vel_reference = input_.vel_reference;
+    checkpoint.acc_reference = input_.acc_reference;
+    checkpoint.output = output_;
+    checkpoint.previous_output = previous_output_;
+
+    checkpoint.measurement_filter[0] = measurement_filter_.position();
+    checkpoint.measurement_filter[1] = measurement_filter_.velocity();
+    checkpoint.measurement_filter[2] = measurement_filter_.consecutive_dropouts();
+
+    checkpoint.observer[0] = observer_.position();
+    checkpoint.observer[1] = observer_.velocity();
+    checkpoint.observer[2] = observer_.disturbance();
+
+    checkpoint.state_size = state_size;
+    core_->saveState(checkpoint.state);
+
+    return true;
+}
+
+// ----------------------------------------------------------------------------------------------------
+
+bool SupervisedController::matchesCheckpoint(const ControllerCheckpoint& checkpoint) const
+{
+    return name().compare(0, MAX_CHECKPOINT_NAME - 1, checkpoint.name) == 0
+            && checkpoint.state_size == core_->stateSize();
+}
+
+// ----------------------------------------------------------------------------------------------------
+
+bool SupervisedController::restoreCheckpoint(const ControllerCheckpoint& checkpoint)
+{
+    if (!matchesCheckpoint(checkpoint))
+        return false;
+
+    status_ = static_cast<ControllerStatus>(checkpoint.status);
+    event_ = NONE;
+    homed_ = checkpoint.homed != 0;
+    measurement_offset = checkpoint.measurement_offset;
+    homing_pos = checkpoint.homing_pos;
+    homing_vel = checkpoint.homing_vel;
+
+    input_.pos_reference = checkpoint.pos_reference;
+    input_.vel_reference = checkpoint.vel_reference;
+    input_.acc_reference = checkpoint.acc_reference;
+    output_ = checkpoint.output;
+    previous_output_ = checkpoint.previous_output;
+
+    // The controller state is restored as is, so there is nothing to preset
+    bumpless_output_ = INVALID_DOUBLE;
+
+    // The filter continues to predict from where the previous process was
+    if (measurement_filter_.is_configured())
+        measurement_filter_.setState(checkpoint.measurement_filter[0], checkpoint.measurement_filter[1],
+                                     static_cast<unsigned int>(checkpoint.measurement_filter[2]));
+
+    if (observer_.is_configured())
+        observer_.setState(checkpoint.observer[0], checkpoint.observer[1], checkpoint.observer[2]);
+
+    if (status_ == HOMING)
+        resetShaper(homing_pos, homing_vel, 0);
+    else
+        resetShaper(input_.pos_reference, input_.vel_reference, input_.acc_reference);
+
+    core_->restoreState(checkpoint.state);
+
+    // Timestamps of the previous process are meaningless
+    last_timestamp_ = INVALID_DOUBLE;
+
+    if (status_ == ERROR)
+        error_msg_ = "Restored in ERROR from checkpoint";
+
+    return true;
 }
 
 // ----------------------------------------------------------------------------------------------------
 
 const std::string& SupervisedController::name() const
 {
-    return controller_->name();
+    return core_->name();
 }
 
 // ----------------------------------------------------------------------------------------------------
@@ -0,0 +1,445 @@
+#include "tue/control/supervisor.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <new>
+#include <sstream>
+
+namespace tue
+{
+namespace control
+{
+
+// ----------------------------------------------------------------------------------------------------
+
+SupervisorBridge::SupervisorBridge(const std::vector<std::shared_ptr<SupervisedController> >& controllers,
+                                   unsigned int queue_size, unsigned int feedback_interval)
+    : feedback_interval_(std::max(1u, feedback_interval)), ticks_(0), commands_applied_(0), dropped_(0),
+      commands_(queue_size), feedback_(queue_size)
+{
+    for(std::vector<std::shared_ptr<SupervisedController> >::const_iterator it = controllers.begin(); it != controllers.end(); ++it)
+    {
+        Joint joint;
+        joint.controller = *it;
+        joint.published_status = UNINITIALIZED;
+        joint.dirty = true;
+        joints_.push_back(joint);
+    }
+}
+
+// ----------------------------------------------------------------------------------------------------
+
+SupervisorBridge::~SupervisorBridge()
+{
+}
+
+// ----------------------------------------------------------------------------------------------------
+
+void* SupervisorBridge::operator new(std::size_t size)
+{
+    void* p = 0;
+    if (posix_memalign(&p, alignof(SupervisorBridge), size) != 0)
+        throw std::bad_alloc();
+    return p;
+}
+
+// ----------------------------------------------------------------------------------------------------
+
+void SupervisorBridge::operator delete(void* p)
+{
+    free(p);
+}
+
+// ----------------------------------------------------------------------------------------------------
+
+void SupervisorBridge::update()
+{
+    // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+    // Publish the state after this tick's update. This happens before the commands are applied, so
+    // feedback with commands_applied = n always reflects an update after the first n commands.
+
+    bool periodic = (++ticks_ >= feedback_interval_);
+    if (periodic)
+        ticks_ = 0;
+
+    for(unsigned int i = 0; i < joints_.size(); ++i)
+    {
+        Joint& joint = joints_[i];
+        if (periodic || joint.dirty || joint.controller->status() != joint.published_status)
+            publish(i);
+    }
+
+    // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+    // Apply the commands (take effect in the next controller update)
+
+    SupervisorCommand cmd;
+    while(commands_.pop(cmd))
+    {
+        ++commands_applied_;
+
+        if (cmd.joint >= joints_.size())
+            continue;
+
+        Joint& joint = joints_[cmd.joint];
+        SupervisedController& c = *joint.controller;
+
+        switch (cmd.type)
+        {
+        case COMMAND_START_HOMING:
+            c.startHoming();
+            break;
+        case COMMAND_STOP_HOMING:
+            c.stopHoming(cmd.value);
+            break;
+        case COMMAND_ENABLE:
+            c.enable();
+            break;
+        case COMMAND_DISABLE:
+            c.disable();
+            break;
+        case COMMAND_SET_ERROR:
+            c.setError(cmd.message ? cmd.message : "Supervisor");
+            break;
+        case COMMAND_SET_REFERENCE:
+            if (c.accepts_references())
+                c.setReference(cmd.value);
+            break;
+        }
+
+        // Publish the effect of the command after the next update
+        joint.dirty = true;
+    }
+}
+
+// ----------------------------------------------------------------------------------------------------
+
+void SupervisorBridge::publish(unsigned int i)
+{
+    Joint& joint = joints_[i];
+    const SupervisedController& c = *joint.controller;
+
+    JointFeedback f;
+    f.joint = i;
+    f.status = c.status();
+    f.homed = c.is_homed();
+    f.measurement = c.measurement();
+    f.error = c.error();
+    f.output = c.output();
+    f.reference = c.reference_position();
+    f.commands_applied = commands_applied_;
+
+    if (feedback_.push(f))
+    {
+        joint.published_status = f.status;
+        joint.dirty = false;
+    }
+    else
+        dropped_.fetch_add(1, std::memory_order_relaxed);
+}
+
+// ----------------------------------------------------------------------------------------------------
+// Sequence
+// ----------------------------------------------------------------------------------------------------
+
+Sequence& Sequence::command(SupervisorCommandType type, double value)
+{
+    Step step(STEP_COMMAND);
+    step.command = SupervisorCommand(joint_, type, value);
+    steps_.push_back(step);
+    return *this;
+}
+
+// ----------------------------------------------------------------------------------------------------
+
+Sequence& Sequence::setError(const std::string& message)
+{
+    command(COMMAND_SET_ERROR);
+
+    // Owned by the step, so it outlives the command
+    Step& step = steps_.back();
+    step.message.reset(new std::string(message));
+    step.command.message = step.message->c_str();
+    return *this;
+}
+
+// ----------------------------------------------------------------------------------------------------
+
+Sequence& Sequence::waitForStatus(ControllerStatus status)
+{
+    Step step(STEP_WAIT_STATUS);
+    step.status = status;
+    steps_.push_back(step);
+    return *this;
+}
+
+// ----------------------------------------------------------------------------------------------------
+
+Sequence& Sequence::waitUntil(const Condition& condition)
+{
+    Step step(STEP_WAIT_CONDITION);
+    step.condition = condition;
+    steps_.push_back(step);
+    return *this;
+}
+
+// ----------------------------------------------------------------------------------------------------
+
+Sequence& Sequence::wait(double duration)
+{
+    Step step(STEP_WAIT_TIME);
+    step.duration = duration;
+    steps_.push_back(step);
+    return *this;
+}
+
+// ----------------------------------------------------------------------------------------------------
+
+Sequence& Sequence::timeout(double duration, bool set_error)
+{
+    if (!steps_.empty())
+    {
+        steps_.back().timeout = duration;
+        steps_.back().timeout_error = set_error;
+    }
+    return *this;
+}
+
+// ----------------------------------------------------------------------------------------------------
+// Supervisor
+// ----------------------------------------------------------------------------------------------------
+
+Supervisor::Supervisor(const std::shared_ptr<SupervisorBridge>& bridge)
+    : bridge_(bridge), feedback_(bridge->size()), received_(bridge->size(), false), commands_pushed_(0),
+      running_(false)
+{
+}
+
+// ----------------------------------------------------------------------------------------------------
+
+Supervisor::~Supervisor()
+{
+    stop();
+}
+
+// ----------------------------------------------------------------------------------------------------
+
+unsigned int Supervisor::runSequence(const Sequence& sequence)
+{
+    std::shared_ptr<Task> task(new Task(sequence));
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    tasks_.push_back(task);
+    return tasks_.size() - 1;
+}
+
+// ----------------------------------------------------------------------------------------------------
+
+void Supervisor::cancel(unsigned int id)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (id < tasks_.size() && tasks_[id]->state == RUNNING)
+        tasks_[id]->state = CANCELED;
+}
+
+// ----------------------------------------------------------------------------------------------------
+
+Supervisor::SequenceState Supervisor::state(unsigned int id) const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return id < tasks_.size() ? tasks_[id]->state : FAILED;
+}
+
+// ----------------------------------------------------------------------------------------------------
+
+std::string Supervisor::error_message(unsigned int id) const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return id < tasks_.size() ? tasks_[id]->error_msg : "Unknown sequence";
+}
+
+// ----------------------------------------------------------------------------------------------------
+
+unsigned int Supervisor::num_running() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    unsigned int n = 0;
+    for(std::vector<std::shared_ptr<Task> >::const_iterator it = tasks_.begin(); it != tasks_.end(); ++it)
+        if ((*it)->state == RUNNING)
+            ++n;
+    return n;
+}
+
+// ----------------------------------------------------------------------------------------------------
+
+void Supervisor::start(double period)
+{
+    stop();
+
+    running_ = true;
+    thread_ = std::thread(&Supervisor::run, this, period);
+}
+
+// ----------------------------------------------------------------------------------------------------
+
+void Supervisor::stop()
+{
+    running_ = false;
+    if (thread_.joinable())
+        thread_.join();
+}
+
+// ----------------------------------------------------------------------------------------------------
+
+void Supervisor::run(double period)
+{
+    typedef std::chrono::steady_clock Clock;
+
+    Clock::time_point t_start = Clock::now();
+    Clock::duration step = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(period));
+    Clock::time_point t_next = t_start;
+
+    while(running_)
+    {
+        Clock::time_point t = Clock::now();
+        spin(std::chrono::duration<double>(t - t_start).count());
+
+        t_next += step;
+        if (t_next < t)
+            t_next = t + step; // Overrun: do not try to catch up
+
+        std::this_thread::sleep_until(t_next);
+    }
+}
+
+// ----------------------------------------------------------------------------------------------------
+
+void Supervisor::spin(double now)
+{
+    // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+    // Keep the latest feedback per joint
+
+    JointFeedback f;
+    while(bridge_->feedback().pop(f))
+    {
+        if (f.joint >= feedback_.size())
+            continue;
+
+        feedback_[f.joint] = f;
+        received_[f.joint] = true;
+    }
+
+    // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+    // Resume the sequences
+
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    for(std::vector<std::shared_ptr<Task> >::iterator it = tasks_.begin(); it != tasks_.end(); ++it)
+    {
+        if ((*it)->error_pending)
+            pushError(**it);
+        else if ((*it)->state == RUNNING)
+            advance(**it, now);
+    }
+}
+
+// ----------------------------------------------------------------------------------------------------
+
+void Supervisor::fail(Task& task, const std::string& msg, bool set_error)
+{
+    task.state = FAILED;
+    task.error_msg = msg;
+
+    if (set_error)
+    {
+        task.error_pending = true;
+        pushError(task);
+    }
+}
+
+// ----------------------------------------------------------------------------------------------------
+
+void Supervisor::pushError(Task& task)
+{
+    // Retried in the next spin if the queue is full
+    SupervisorCommand cmd(task.sequence.joint(), COMMAND_SET_ERROR, 0, "Supervisor: sequence timeout");
+    if (bridge_->commands().push(cmd))
+    {
+        ++commands_pushed_;
+        task.error_pending = false;
+    }
+}
+
+// ----------------------------------------------------------------------------------------------------
+
+void Supervisor::advance(Task& task, double now)
+{
+    const std::vector<Sequence::Step>& steps = task.sequence.steps_;
+    unsigned int joint = task.sequence.joint();
+
+    while(task.step < steps.size())
+    {
+        const Sequence::Step& step = steps[task.step];
+
+        if (!is_set(task.step_start))
+            task.step_start = now;
+
+        if (joint >= feedback_.size())
+        {
+            fail(task, "Unknown joint", false);
+            return;
+        }
+
+        bool done = false;
+
+        if (step.type == Sequence::STEP_COMMAND)
+        {
+            // Retried in the next spin if the queue is full
+            if (!bridge_->commands().push(step.command))
+                return;
+
+            ++commands_pushed_;
+            task.min_commands = commands_pushed_;
+            done = true;
+        }
+        else if (step.type == Sequence::STEP_WAIT_TIME)
+        {
+            done = (now - task.step_start >= step.duration);
+        }
+        else
+        {
+            // Only feedback that reflects the commands issued so far
+            const JointFeedback& f = feedback_[joint];
+            if (received_[joint] && f.commands_applied >= task.min_commands)
+            {
+                if (step.type == Sequence::STEP_WAIT_STATUS)
+                    done = (f.status == step.status);
+                else
+                    done = step.condition(f);
+            }
+        }
+
+        if (!done)
+        {
+            if (is_set(step.timeout) && now - task.step_start > step.timeout)
+            {
+                std::stringstream s;
+                s << "Timeout in step " << task.step;
+                fail(task, s.str(), step.timeout_error);
+            }
+            return;
+        }
+
+        ++task.step;
+        task.step_start = INVALID_DOUBLE;
+    }
+
+    task.state = SUCCEEDED;
+}
+
+// ----------------------------------------------------------------------------------------------------
+
+} // end namespace control
+
+} // end namespace tue
@@ -0,0 +1,261 @@
+#include "tue/control/synchronized_trajectory.h"
+
+#include "tue/control/supervised_controller.h"
+
+namespace tue
+{
+namespace control
+{
+
+// ----------------------------------------------------------------------------------------------------
+
+SynchronizedTrajectory::SynchronizedTrajectory() : dt_(0), t_(0), duration_(0)
+{
+}
+
+// ----------------------------------------------------------------------------------------------------
+
+SynchronizedTrajectory::~SynchronizedTrajectory()
+{
+}
+
+// ----------------------------------------------------------------------------------------------------
+
+void SynchronizedTrajectory::configure(tue::Configuration& config, const std::vector<std::shared_ptr<SupervisedController> >& controllers,
+                                       double dt)
+{
+    dt_ = dt;
+    controllers_.clear();
+    max_vel_.clear();
+    max_acc_.clear();
+    max_jerk_.clear();
+
+    if (config.readArray("trajectory", tue::REQUIRED))
+    {
+        while(config.nextArrayItem())
+        {
+            std::string joint;
+            if (!config.value("joint", joint))
+                continue;
+
+            std::shared_ptr<SupervisedController> c;
+            for(std::vector<std::shared_ptr<SupervisedController> >::const_iterator it = controllers.begin(); it != controllers.end(); ++it)
+            {
+                if (*it && (*it)->name() == joint)
+                {
+                    c = *it;
+                    break;
+                }
+            }
+
+            if (!c)
+            {
+                config.addError("Unknown joint: '" + joint + "'");
+                continue;
+            }
+
+            double max_vel, max_acc, max_jerk = INFINITY;
+            config.value("max_velocity", max_vel);
+            config.value("max_acceleration", max_acc);
+            config.value("max_jerk", max_jerk, tue::OPTIONAL);
+
+            if (max_vel <= 0 || max_acc <= 0 || max_jerk <= 0)
+                config.addError("Joint '" + joint + "': max_velocity, max_acceleration and max_jerk must be > 0");
+
+            controllers_.push_back(c);
+            max_vel_.push_back(max_vel);
+            max_acc_.push_back(max_acc);
+            max_jerk_.push_back(max_jerk);
+        }
+
+        config.endArray();
+    }
+
+    unsigned int n = controllers_.size();
+
+    start_pos_.assign(n, 0);
+    target_.assign(n, 0);
+    scale_.assign(n, 1);
+    seg_time_.assign(n * (NUM_SEGMENTS + 1), 0);
+    seg_pos_.assign(n * NUM_SEGMENTS, 0);
+    seg_vel_.assign(n * NUM_SEGMENTS, 0);
+    seg_acc_.assign(n * NUM_SEGMENTS, 0);
+    seg_jerk_.assign(n * NUM_SEGMENTS, 0);
+
+    pos_.assign(n, 0);
+    vel_.assign(n, 0);
+    acc_.assign(n, 0);
+
+    t_ = 0;
+    duration_ = 0;
+}
+
+// ----------------------------------------------------------------------------------------------------
+
+double SynchronizedTrajectory::plan(unsigned int i, double distance)
+{
+    double D = std::abs(distance);
+    double sign = distance < 0 ? -1 : 1;
+
+    double v_max = max_vel_[i];
+    double a_max = max_acc_[i];
+    double j_max = max_jerk_[i];
+
+    // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+    // Jerk phase (Tj), acceleration phase (Ta, including jerk phases) and constant velocity phase (Tv)
+
+    double Tj, Ta, Tv;
+
+    if (std::isinf(j_max))
+        Tj = 0;
+    else if (v_max * j_max < a_max * a_max)
+        Tj = std::sqrt(v_max / j_max);      // max acceleration is not reached
+    else
+        Tj = a_max / j_max;
+
+    Ta = (Tj > 0 && Tj < a_max / j_max) ? 2 * Tj : Tj + v_max / a_max;
+    Tv = D / v_max - Ta;
+
+    if (Tv < 0)
+    {
+        // Max velocity is not reached
+        Tv = 0;
+        if (std::isinf(j_max) || D >= 2 * a_max * a_max * a_max / (j_max * j_max))
+        {
+            Tj = std::isinf(j_max) ? 0 : a_max / j_max;
+            Ta = Tj / 2 + std::sqrt(Tj * Tj / 4 + D / a_max);
+        }
+        else
+        {
+            Tj = std::cbrt(D / (2 * j_max));
+            Ta = 2 * Tj;
+        }
+    }
+
+    double a_lim = (Tj > 0 ? j_max * Tj : a_max);
+    double j = (Tj > 0 ? j_max : 0);
+
+    // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+    // Segments
+
+    const double durations[NUM_SEGMENTS] = { Tj, Ta - 2 * Tj, Tj, Tv, Tj, Ta - 2 * Tj, Tj };
+    const double accs[NUM_SEGMENTS] = { 0, a_lim, a_lim, 0, 0, -a_lim, -a_lim };
+    const double jerks[NUM_SEGMENTS] = { j, 0, -j, 0, -j, 0, j };
+
+    double* seg_time = &seg_time_[i * (NUM_SEGMENTS + 1)];
+    double* seg_pos = &seg_pos_[i * NUM_SEGMENTS];
+    double* seg_vel = &seg_vel_[i * NUM_SEGMENTS];
+    double* seg_acc = &seg_acc_[i * NUM_SEGMENTS];
+    double* seg_jerk = &seg_jerk_[i * NUM_SEGMENTS];
+
+    double t = 0, p = 0, v = 0;
+    for(unsigned int k = 0; k < NUM_SEGMENTS; ++k)
+    {
+        double d = std::max(durations[k], 0.0);
+        double a = accs[k];
+
+        seg_time[k] = t;
+        seg_pos[k] = sign * p;
+        seg_vel[k] = sign * v;
+        seg_acc[k] = sign * a;
+        seg_jerk[k] = sign * jerks[k];
+
+        p += v * d + a * d * d / 2 + jerks[k] * d * d * d / 6;
+        v += a * d + jerks[k] * d * d / 2;
+        t += d;
+    }
+
+    seg_time[NUM_SEGMENTS] = t;
+
+    return t;
+}
+
+// ----------------------------------------------------------------------------------------------------
+
+bool SynchronizedTrajectory::setTarget(const double* target)
+{
+    unsigned int n = controllers_.size();
+
+    for(unsigned int i = 0; i < n; ++i)
+    {
+        if (!controllers_[i]->accepts_references())
+            return false;
+    }
+
+    // Plan every joint in minimum time and determine the slowest one
+    duration_ = 0;
+    for(unsigned int i = 0; i < n; ++i)
+    {
+        const SupervisedController& c = *controllers_[i];
+        start_pos_[i] = is_set(c.reference_position()) ? c.reference_position() : c.measurement();
+        target_[i] = target[i];
+
+        scale_[i] = plan(i, target_[i] - start_pos_[i]);
+        duration_ = std::max(duration_, scale_[i]);
+    }
+
+    // Time scale all profiles to the common duration
+    for(unsigned int i = 0; i < n; ++i)
+        scale_[i] = (duration_ > 0 ? scale_[i] / duration_ : 1);
+
+    t_ = 0;
+
+    return true;
+}
+
+// ----------------------------------------------------------------------------------------------------
+
+void SynchronizedTrajectory::sample(double t, double* pos, double* vel, double* acc) const
+{
+    unsigned int n = controllers_.size();
+
+    for(unsigned int i = 0; i < n; ++i)
+    {
+        const double* seg_time = &seg_time_[i * (NUM_SEGMENTS + 1)];
+
+        double s = scale_[i];
+        double tau = t * s;     // time in the unscaled profile of joint i
+
+        if (tau >= seg_time[NUM_SEGMENTS])
+        {
+            pos[i] = target_[i];
+            vel[i] = 0;
+            acc[i] = 0;
+            continue;
+        }
+
+        unsigned int k = 0;
+        while(k + 1 < NUM_SEGMENTS && tau >= seg_time[k + 1])
+            ++k;
+
+        unsigned int idx = i * NUM_SEGMENTS + k;
+        double d = tau - seg_time[k];
+        double p0 = seg_pos_[idx], v0 = seg_vel_[idx], a0 = seg_acc_[idx], j = seg_jerk_[idx];
+
+        pos[i] = start_pos_[i] + p0 + v0 * d + a0 * d * d / 2 + j * d * d * d / 6;
+        vel[i] = s * (v0 + a0 * d + j * d * d / 2);
+        acc[i] = s * s * (a0 + j * d);
+    }
+}
+
+// ----------------------------------------------------------------------------------------------------
+
+void SynchronizedTrajectory::update()
+{
+    // A group without joints has no buffers to sample into
+    if (done() || controllers_.empty())
+        return;
+
+    t_ = std::min(t_ + dt_, duration_);
+    sample(t_, &pos_[0], &vel_[0], &acc_[0]);
+
+    for(unsigned int i = 0; i < controllers_.size(); ++i)
+        controllers_[i]->setReference(pos_[i], vel_[i], acc_[i]);
+}
+
+// ----------------------------------------------------------------------------------------------------
+
+} // end namespace control
+
+} // end namespace tue
+
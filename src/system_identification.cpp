@@ -0,0 +1,307 @@
+#include "tue/control/system_identification.h"
+
+#include <sstream>
+
+namespace tue
+{
+namespace control
+{
+
+namespace
+{
+
+// Maximum excitation period (samples)
+const unsigned int MAX_PERIOD = 1 << 17;
+
+// Galois LFSR feedback masks of maximal length sequences, for orders 5 to 16
+const unsigned int PRBS_MASKS[] = { 0x14, 0x30, 0x60, 0xB8, 0x110, 0x240, 0x500, 0x829, 0x100D, 0x2015, 0x6000, 0xD008 };
+
+}
+
+// ----------------------------------------------------------------------------------------------------
+
+SystemIdentification::SystemIdentification() : injection_(OUTPUT), state_(IDLE), index_(0), num_periods_(0),
+    period_count_(0), num_lines_(0)
+{
+}
+
+// ----------------------------------------------------------------------------------------------------
+
+SystemIdentification::~SystemIdentification()
+{
+}
+
+// ----------------------------------------------------------------------------------------------------
+
+void SystemIdentification::configure(tue::Configuration& config, double dt)
+{
+    period_.clear();
+    state_ = IDLE;
+
+    // Only the errors of these parameters count (the configuration may have unrelated errors already)
+    std::string excitation, injection;
+    double amplitude = 0, f_min = 0, f_max = 0;
+    bool valid = config.value("excitation", excitation) & config.value("injection", injection)
+            & config.value("amplitude", amplitude) & config.value("min_frequency", f_min)
+            & config.value("max_frequency", f_max);
+
+    int lines = 32;
+    int periods = 10;
+    config.value("lines", lines, tue::OPTIONAL);
+    config.value("periods", periods, tue::OPTIONAL);
+
+    if (injection == "output")
+        injection_ = OUTPUT;
+    else if (injection == "reference")
+        injection_ = REFERENCE;
+    else
+    {
+        config.addError("Identification: unknown injection '" + injection + "'");
+        valid = false;
+    }
+
+    if (lines < 1 || lines > static_cast<int>(MAX_IDENTIFICATION_LINES) || periods < 1)
+    {
+        config.addError("Identification: lines must be in [1, MAX_IDENTIFICATION_LINES] and periods >= 1");
+        valid = false;
+    }
+
+    if (f_min <= 0 || f_max <= f_min)
+    {
+        config.addError("Identification: 0 < min_frequency < max_frequency");
+        valid = false;
+    }
+
+    // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+    // Determine the period
+
+    double N = 0;
+    int prbs_order = 10;
+    int prbs_divider = 1;
+    if (excitation == "prbs")
+    {
+        config.value("prbs_order", prbs_order, tue::OPTIONAL);
+        config.value("prbs_divider", prbs_divider, tue::OPTIONAL);
+
+        if (prbs_order < 5 || prbs_order > 16 || prbs_divider < 1)
+        {
+            config.addError("Identification: prbs_order must be in [5, 16] and prbs_divider >= 1");
+            valid = false;
+        }
+        else
+            N = ((1 << prbs_order) - 1) * prbs_divider;
+    }
+    else
+    {
+        double f_res;
+        if (!config.value("frequency_resolution", f_res))
+            valid = false;
+        else if (f_res <= 0)
+        {
+            config.addError("Identification: frequency_resolution <= 0");
+            valid = false;
+        }
+        else
+            N = std::floor(1 / (f_res * dt) + 0.5);
+    }
+
+    if (valid && (N < 4 || N > MAX_PERIOD))
+    {
+        std::stringstream s;
+        s << "Identification: excitation period must be between 4 and " << MAX_PERIOD << " samples";
+        config.addError(s.str());
+        valid = false;
+    }
+
+    if (!valid)
+        return;
+
+    unsigned int n = N;
+    double f0 = 1 / (n * dt);
+
+    // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+    // Select the analysis lines (log-spaced harmonics of the period)
+
+    unsigned int k_min = std::max(1.0, std::ceil(f_min / f0));
+    unsigned int k_max = std::min(std::floor(f_max / f0), n / 2 - 1.0);
+
+    if (k_max < k_min)
+    {
+        config.addError("Identification: no frequency lines between min_frequency and max_frequency");
+        return;
+    }
+
+    unsigned int harmonics[MAX_IDENTIFICATION_LINES];
+    num_lines_ = 0;
+
+    if (k_max - k_min + 1 <= static_cast<unsigned int>(lines))
+    {
+        for(unsigned int k = k_min; k <= k_max; ++k)
+            harmonics[num_lines_++] = k;
+    }
+    else
+    {
+        for(int i = 0; i < lines; ++i)
+        {
+            double f = (lines == 1 ? 0 : static_cast<double>(i) / (lines - 1));
+            unsigned int k = std::floor(k_min * std::pow(static_cast<double>(k_max) / k_min, f) + 0.5);
+            if (num_lines_ == 0 || k > harmonics[num_lines_ - 1])
+                harmonics[num_lines_++] = k;
+        }
+    }
+
+    for(unsigned int i = 0; i < num_lines_; ++i)
+    {
+        double f = harmonics[i] * f0;
+        excitation_bins_[i].setFrequency(f, dt);
+        output_bins_[i].setFrequency(f, dt);
+        measurement_bins_[i].setFrequency(f, dt);
+    }
+
+    // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+    // Generate one period of the excitation
+
+    std::vector<double> period(n, 0);
+
+    if (excitation == "multisine")
+    {
+        // Schroeder phases for a low crest factor
+        for(unsigned int i = 0; i < num_lines_; ++i)
+        {
+            double phi = -M_PI * i * (i + 1) / num_lines_;
+            for(unsigned int j = 0; j < n; ++j)
+                period[j] += std::cos(2 * M_PI * harmonics[i] * j / n + phi);
+        }
+
+        double peak = 0;
+        for(unsigned int j = 0; j < n; ++j)
+            peak = std::max(peak, std::abs(period[j]));
+
+        for(unsigned int j = 0; j < n; ++j)
+            period[j] *= amplitude / peak;
+    }
+    else if (excitation == "chirp")
+    {
+        // Logarithmic sweep from min_frequency to max_frequency over one period
+        double T = n * dt;
+        double r = std::log(f_max / f_min);
+        for(unsigned int j = 0; j < n; ++j)
+            period[j] = amplitude * std::sin(2 * M_PI * f_min * T / r * (std::exp(j * dt * r / T) - 1));
+    }
+    else if (excitation == "prbs")
+    {
+        unsigned int length = (1u << prbs_order) - 1;
+        unsigned int mask = PRBS_MASKS[prbs_order - 5];
+
+        unsigned int lfsr = 1;
+        for(unsigned int j = 0; j < length; ++j)
+        {
+            double value = (lfsr & 1) ? amplitude : -amplitude;
+            for(int d = 0; d < prbs_divider; ++d)
+                period[j * prbs_divider + d] = value;
+
+            unsigned int lsb = lfsr & 1;
+            lfsr >>= 1;
+            if (lsb)
+                lfsr ^= mask;
+        }
+    }
+    else
+    {
+        config.addError("Identification: unknown excitation '" + excitation + "'");
+        return;
+    }
+
+    period_.swap(period);
+    num_periods_ = periods;
+}
+
+// ----------------------------------------------------------------------------------------------------
+
+void SystemIdentification::start()
+{
+    if (!is_configured())
+        return;
+
+    index_ = 0;
+    period_count_ = 0;
+    state_ = SETTLING;
+}
+
+// ----------------------------------------------------------------------------------------------------
+
+void SystemIdentification::stop()
+{
+    if (is_running())
+        state_ = IDLE;
+}
+
+// ----------------------------------------------------------------------------------------------------
+
+void SystemIdentification::update(double excitation, double output, double measurement)
+{
+    if (!is_running())
+        return;
+
+    if (state_ == MEASURING)
+    {
+        for(unsigned int i = 0; i < num_lines_; ++i)
+        {
+            excitation_bins_[i].update(excitation);
+            output_bins_[i].update(output);
+            measurement_bins_[i].update(measurement);
+        }
+    }
+
+    if (++index_ < period_.size())
+        return;
+
+    // End of period
+
+    index_ = 0;
+    ++period_count_;
+
+    if (state_ == SETTLING)
+    {
+        // Transients have settled; start accumulating
+        for(unsigned int i = 0; i < num_lines_; ++i)
+        {
+            excitation_bins_[i].reset();
+            output_bins_[i].reset();
+            measurement_bins_[i].reset();
+        }
+
+        period_count_ = 0;
+        state_ = MEASURING;
+    }
+    else if (period_count_ == num_periods_)
+    {
+        computeResult();
+        state_ = DONE;
+    }
+}
+
+// ----------------------------------------------------------------------------------------------------
+
+void SystemIdentification::computeResult()
+{
+    result_.size = num_lines_;
+    for(unsigned int i = 0; i < num_lines_; ++i)
+    {
+        std::complex<double> D(excitation_bins_[i].re, excitation_bins_[i].im);
+        std::complex<double> U(output_bins_[i].re, output_bins_[i].im);
+        std::complex<double> Y(measurement_bins_[i].re, measurement_bins_[i].im);
+
+        result_.frequency[i] = excitation_bins_[i].frequency;
+        result_.plant[i] = Y / U;
+        result_.closed_loop[i] = Y / D;
+        result_.sensitivity[i] = U / D;
+    }
+}
+
+// ----------------------------------------------------------------------------------------------------
+
+} // end namespace control
+
+} // end namespace tue
+
@@ -0,0 +1,695 @@
+#include "tue/control/telemetry.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <sstream>
+
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace tue
+{
+namespace control
+{
+
+namespace
+{
+
+// ----------------------------------------------------------------------------------------------------
+
+class BitWriter
+{
+
+public:
+
+    BitWriter(std::vector<unsigned char>& data) : data_(data), bits_(0) { data_.clear(); }
+
+    /// Writes the lowest n bits of 'value', most significant bit first
+    void write(uint64_t value, unsigned int n)
+    {
+        for(unsigned int i = n; i > 0; --i)
+        {
+            if (bits_ % 8 == 0)
+                data_.push_back(0);
+
+            if ((value >> (i - 1)) & 1)
+                data_.back() |= 0x80 >> (bits_ % 8);
+
+            ++bits_;
+        }
+    }
+
+    void writeVarint(uint64_t value)
+    {
+        while(value >= 0x80)
+        {
+            write(0x80 | (value & 0x7f), 8);
+            value >>= 7;
+        }
+        write(value, 8);
+    }
+
+private:
+
+    std::vector<unsigned char>& data_;
+
+    unsigned long bits_;
+
+};
+
+// ----------------------------------------------------------------------------------------------------
+
+class BitReader
+{
+
+public:
+
+    BitReader(const unsigned char* data, unsigned int size) : data_(data), size_(size), bits_(0), ok_(true) {}
+
+    uint64_t read(unsigned int n)
+    {
+        uint64_t value = 0;
+        for(unsigned int i = 0; i < n; ++i)
+        {
+            if (bits_ >= 8ul * size_)
+            {
+                ok_ = false;
+                return 0;
+            }
+
+            value = (value << 1) | ((data_[bits_ / 8] >> (7 - bits_ % 8)) & 1);
+            ++bits_;
+        }
+        return value;
+    }
+
+    uint64_t readVarint()
+    {
+        uint64_t value = 0;
+        for(unsigned int shift = 0; shift < 64 && ok_; shift += 7)
+        {
+            uint64_t group = read(8);
+            value |= (group & 0x7f) << shift;
+            if ((group & 0x80) == 0)
+                return value;
+        }
+
+        ok_ = false;
+        return 0;
+    }
+
+    bool ok() const { return ok_; }
+
+private:
+
+    const unsigned char* data_;
+
+    unsigned int size_;
+
+    unsigned long bits_;
+
+    bool ok_;
+
+};
+
+// ----------------------------------------------------------------------------------------------------
+
+uint64_t zigzag(int64_t v) { return (static_cast<uint64_t>(v) << 1) ^ static_cast<uint64_t>(v >> 63); }
+
+int64_t unzigzag(uint64_t u) { return static_cast<int64_t>(u >> 1) ^ -static_cast<int64_t>(u & 1); }
+
+// ----------------------------------------------------------------------------------------------------
+
+void writeDouble(BitWriter& w, double v, uint64_t& previous)
+{
+    uint64_t bits;
+    std::memcpy(&bits, &v, sizeof(bits));
+
+    uint64_t x = bits ^ previous;
+    previous = bits;
+
+    if (x == 0)
+    {
+        w.write(0, 1);
+        return;
+    }
+
+    unsigned int leading = __builtin_clzll(x);
+    unsigned int trailing = __builtin_ctzll(x);
+    unsigned int length = 64 - leading - trailing;
+
+    w.write(1, 1);
+    w.write(leading, 6);
+    w.write(length - 1, 6);
+    w.write(x >> trailing, length);
+}
+
+// ----------------------------------------------------------------------------------------------------
+
+double readDouble(BitReader& r, uint64_t& previous)
+{
+    if (r.read(1))
+    {
+        unsigned int leading = r.read(6);
+        unsigned int length = r.read(6) + 1;
+        if (leading + length > 64)
+            length = 64 - leading; // Corrupt: keep the shift defined, the frame is rejected anyway
+
+        uint64_t x = r.read(length) << (64 - leading - length);
+        previous ^= x;
+    }
+
+    double v;
+    std::memcpy(&v, &previous, sizeof(v));
+    return v;
+}
+
+// ----------------------------------------------------------------------------------------------------
+
+void appendVarint(uint64_t value, std::vector<unsigned char>& data)
+{
+    while(value >= 0x80)
+    {
+        data.push_back(0x80 | (value & 0x7f));
+        value >>= 7;
+    }
+    data.push_back(value);
+}
+
+} // end anonymous namespace
+
+// ----------------------------------------------------------------------------------------------------
+// TelemetryEncoder
+// ----------------------------------------------------------------------------------------------------
+
+TelemetryEncoder::TelemetryEncoder(unsigned int key_frame_interval)
+    : key_frame_interval_(std::max(1u, key_frame_interval)), frames_since_key_(key_frame_interval_), tick_(0),
+      samples_(0)
+{
+}
+
+// ----------------------------------------------------------------------------------------------------
+
+void TelemetryEncoder::encode(const TelemetryFrame& frame, std::vector<unsigned char>& data)
+{
+    bool key = (frames_since_key_ >= key_frame_interval_);
+    if (key)
+    {
+        // Encoded against zeros
+        tick_ = 0;
+        samples_ = 0;
+        std::fill(status_, status_ + MAX_TELEMETRY_JOINTS, 0);
+        std::fill(values_, values_ + MAX_TELEMETRY_JOINTS * NUM_TELEMETRY_SIGNALS * 4, 0);
+        frames_since_key_ = 0;
+    }
+    ++frames_since_key_;
+
+    unsigned int num_joints = std::min(frame.num_joints, MAX_TELEMETRY_JOINTS);
+
+    BitWriter w(payload_);
+    w.write(key ? 1 : 0, 1);
+    w.writeVarint(zigzag(static_cast<int64_t>(frame.tick - tick_)));
+    w.writeVarint(zigzag(static_cast<int64_t>(frame.samples) - samples_));
+    w.writeVarint(num_joints);
+
+    for(unsigned int i = 0; i < num_joints; ++i)
+    {
+        const TelemetryJoint& joint = frame.joints[i];
+
+        w.writeVarint(zigzag(static_cast<int>(joint.status) - status_[i]));
+        status_[i] = joint.status;
+
+        uint64_t* previous = &values_[i * NUM_TELEMETRY_SIGNALS * 4];
+        for(unsigned int j = 0; j < NUM_TELEMETRY_SIGNALS; ++j)
+        {
+            const TelemetryAggregate& a = joint.signals[j];
+            writeDouble(w, a.min, *previous++);
+            writeDouble(w, a.max, *previous++);
+            writeDouble(w, a.mean, *previous++);
+            writeDouble(w, a.last, *previous++);
+        }
+    }
+
+    tick_ = frame.tick;
+    samples_ = frame.samples;
+
+    appendVarint(payload_.size(), data);
+    data.insert(data.end(), payload_.begin(), payload_.end());
+}
+
+// ----------------------------------------------------------------------------------------------------
+// TelemetryDecoder
+// ----------------------------------------------------------------------------------------------------
+
+TelemetryDecoder::TelemetryDecoder() : synchronized_(false), tick_(0), samples_(0)
+{
+}
+
+// ----------------------------------------------------------------------------------------------------
+
+bool TelemetryDecoder::decode(const unsigned char* data, unsigned int available, TelemetryFrame& frame,
+                              unsigned int& size)
+{
+    size = 0;
+
+    // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+    // Length prefix
+
+    uint64_t length = 0;
+    unsigned int header = 0;
+    for(unsigned int shift = 0; ; shift += 7)
+    {
+        if (header >= available || shift > 28)
+            return false;
+
+        unsigned char b = data[header++];
+        length |= static_cast<uint64_t>(b & 0x7f) << shift;
+        if ((b & 0x80) == 0)
+            break;
+    }
+
+    if (header + length > available)
+        return false;
+
+    size = header + length;
+
+    // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+    // Payload
+
+    BitReader r(data + header, length);
+
+    bool key = r.read(1);
+    if (!key && !synchronized_)
+        return false;
+
+    if (key)
+    {
+        tick_ = 0;
+        samples_ = 0;
+        std::fill(status_, status_ + MAX_TELEMETRY_JOINTS, 0);
+        std::fill(values_, values_ + MAX_TELEMETRY_JOINTS * NUM_TELEMETRY_SIGNALS * 4, 0);
+    }
+
+    tick_ += unzigzag(r.readVarint());
+    samples_ += unzigzag(r.readVarint());
+    uint64_t num_joints = r.readVarint();
+
+    if (!r.ok() || num_joints > MAX_TELEMETRY_JOINTS)
+    {
+        synchronized_ = false;
+        return false;
+    }
+
+    frame.tick = tick_;
+    frame.samples = samples_;
+    frame.num_joints = num_joints;
+
+    for(unsigned int i = 0; i < num_joints; ++i)
+    {
+        TelemetryJoint& joint = frame.joints[i];
+
+        status_[i] += unzigzag(r.readVarint());
+        joint.status = static_cast<ControllerStatus>(status_[i]);
+
+        uint64_t* previous = &values_[i * NUM_TELEMETRY_SIGNALS * 4];
+        for(unsigned int j = 0; j < NUM_TELEMETRY_SIGNALS; ++j)
+        {
+            TelemetryAggregate& a = joint.signals[j];
+            a.min = readDouble(r, *previous++);
+            a.max = readDouble(r, *previous++);
+            a.mean = readDouble(r, *previous++);
+            a.last = readDouble(r, *previous++);
+        }
+    }
+
+    // A corrupt frame also invalidates the state the next frames are decoded against
+    synchronized_ = r.ok();
+    return synchronized_;
+}
+
+// ----------------------------------------------------------------------------------------------------
+// RotatingFileSink
+// ----------------------------------------------------------------------------------------------------
+
+RotatingFileSink::RotatingFileSink(const std::string& path, unsigned long max_size, unsigned int max_files)
+    : path_(path), max_size_(max_size), max_files_(std::max(1u, max_files)), size_(0), restarted_(true)
+{
+    fd_ = ::open(path_.c_str(), O_WRONLY | O_CREAT | O_APPEND, 0644);
+
+    // Keep the file of a previous run
+    struct stat st;
+    if (fd_ >= 0 && fstat(fd_, &st) == 0 && st.st_size > 0)
+        rotate();
+}
+
+// ----------------------------------------------------------------------------------------------------
+
+RotatingFileSink::~RotatingFileSink()
+{
+    if (fd_ >= 0)
+        ::close(fd_);
+}
+
+// ----------------------------------------------------------------------------------------------------
+
+bool RotatingFileSink::write(const unsigned char* data, unsigned int size)
+{
+    if (fd_ < 0)
+        return false;
+
+    if (::write(fd_, data, size) != static_cast<ssize_t>(size))
+        return false;
+
+    size_ += size;
+    if (size_ >= max_size_)
+        rotate();
+
+    return true;
+}
+
+// ----------------------------------------------------------------------------------------------------
+
+bool RotatingFileSink::restarted()
+{
+    bool r = restarted_;
+    restarted_ = false;
+    return r;
+}
+
+// ----------------------------------------------------------------------------------------------------
+
+void RotatingFileSink::rotate()
+{
+    ::close(fd_);
+
+    for(unsigned int i = max_files_ - 1; i > 0; --i)
+    {
+        std::stringstream from, to;
+        if (i > 1)
+            from << path_ << "." << i - 1;
+        else
+            from << path_;
+        to << path_ << "." << i;
+
+        ::rename(from.str().c_str(), to.str().c_str());
+    }
+
+    fd_ = ::open(path_.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_APPEND, 0644);
+    size_ = 0;
+    restarted_ = true;
+}
+
+// ----------------------------------------------------------------------------------------------------
+// SocketSink
+// ----------------------------------------------------------------------------------------------------
+
+SocketSink::SocketSink(const std::string& path) : path_(path)
+{
+    fd_ = socket(AF_UNIX, SOCK_DGRAM, 0);
+}
+
+// ----------------------------------------------------------------------------------------------------
+
+SocketSink::~SocketSink()
+{
+    if (fd_ >= 0)
+        ::close(fd_);
+}
+
+// ----------------------------------------------------------------------------------------------------
+
+bool SocketSink::write(const unsigned char* data, unsigned int size)
+{
+    sockaddr_un addr;
+    if (fd_ < 0 || path_.size() >= sizeof(addr.sun_path))
+        return false;
+
+    std::memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    std::strcpy(addr.sun_path, path_.c_str());
+
+    return sendto(fd_, data, size, MSG_DONTWAIT, reinterpret_cast<sockaddr*>(&addr), sizeof(addr))
+            == static_cast<ssize_t>(size);
+}
+
+// ----------------------------------------------------------------------------------------------------
+// Telemetry
+// ----------------------------------------------------------------------------------------------------
+
+Telemetry::Telemetry() : window_(1), ticks_(0), tick_(0), configured_(false), queue_(64), dropped_(0),
+    frames_written_(0), bytes_written_(0), running_(false)
+{
+}
+
+// ----------------------------------------------------------------------------------------------------
+
+Telemetry::~Telemetry()
+{
+    stop();
+}
+
+// ----------------------------------------------------------------------------------------------------
+
+void Telemetry::addController(const std::shared_ptr<SupervisedController>& controller)
+{
+    controllers_.push_back(controller);
+}
+
+// ----------------------------------------------------------------------------------------------------
+
+void Telemetry::configure(tue::Configuration& config, double dt)
+{
+    if (controllers_.size() > MAX_TELEMETRY_JOINTS)
+        config.addError("Too many controllers for telemetry (more than MAX_TELEMETRY_JOINTS)");
+
+    double window = 0.1;
+    config.value("window", window, tue::OPTIONAL);
+
+    int size = static_cast<int>(window / dt + 0.5);
+    if (size < 1)
+        config.addError("Telemetry window must be at least one sample");
+
+    int key_frame_interval = 100;
+    config.value("key_frame_interval", key_frame_interval, tue::OPTIONAL);
+
+    if (key_frame_interval < 1)
+        config.addError("key_frame_interval < 1");
+
+    if (config.readGroup("sink"))
+    {
+        std::string type, path;
+        config.value("type", type);
+        config.value("path", path);
+
+        if (type == "file")
+        {
+            int max_file_size = 10000000;
+            int max_files = 10;
+            config.value("max_file_size", max_file_size, tue::OPTIONAL);
+            config.value("max_files", max_files, tue::OPTIONAL);
+
+            if (max_file_size < 1 || max_files < 1)
+                config.addError("max_file_size < 1 || max_files < 1");
+            else
+            {
+                std::shared_ptr<RotatingFileSink> sink = std::make_shared<RotatingFileSink>(path, max_file_size, max_files);
+                if (!sink->is_open())
+                    config.addError("Could not open telemetry file '" + path + "'");
+                sink_ = sink;
+            }
+        }
+        else if (type == "socket")
+            sink_ = std::make_shared<SocketSink>(path);
+        else
+            config.addError("Unknown telemetry sink: '" + type + "'");
+
+        config.endGroup();
+    }
+
+    if (config.hasError())
+        return;
+
+    window_ = size;
+    ticks_ = 0;
+    tick_ = 0;
+
+    acc_.resize(controllers_.size() * NUM_TELEMETRY_SIGNALS);
+    for(unsigned int i = 0; i < acc_.size(); ++i)
+        clear(acc_[i]);
+
+    encoder_ = TelemetryEncoder(key_frame_interval);
+
+    configured_ = true;
+}
+
+// ----------------------------------------------------------------------------------------------------
+
+void Telemetry::update()
+{
+    if (!configured_)
+        return;
+
+    ++tick_;
+
+    // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+    // Accumulate
+
+    for(unsigned int i = 0; i < controllers_.size(); ++i)
+    {
+        const SupervisedController& c = *controllers_[i];
+
+        double v[NUM_TELEMETRY_SIGNALS];
+        v[TELEMETRY_ERROR] = c.error();
+        v[TELEMETRY_OUTPUT] = c.output();
+        v[TELEMETRY_MEASUREMENT] = c.measurement();
+        v[TELEMETRY_SATURATION] = c.output_clamp();
+
+        Accumulator* acc = &acc_[i * NUM_TELEMETRY_SIGNALS];
+        for(unsigned int j = 0; j < NUM_TELEMETRY_SIGNALS; ++j)
+        {
+            if (!is_set(v[j]))
+                continue;
+
+            Accumulator& a = acc[j];
+            if (a.n == 0 || v[j] < a.min)
+                a.min = v[j];
+            if (a.n == 0 || v[j] > a.max)
+                a.max = v[j];
+            a.sum += v[j];
+            a.last = v[j];
+            ++a.n;
+        }
+    }
+
+    if (++ticks_ < window_)
+        return;
+
+    ticks_ = 0;
+
+    // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+    // Complete the window
+
+    frame_.tick = tick_;
+    frame_.samples = window_;
+    frame_.num_joints = controllers_.size();
+
+    for(unsigned int i = 0; i < controllers_.size(); ++i)
+    {
+        TelemetryJoint& joint = frame_.joints[i];
+        joint.status = controllers_[i]->status();
+
+        for(unsigned int j = 0; j < NUM_TELEMETRY_SIGNALS; ++j)
+        {
+            Accumulator& a = acc_[i * NUM_TELEMETRY_SIGNALS + j];
+            TelemetryAggregate& s = joint.signals[j];
+
+            if (a.n > 0)
+            {
+                s.min = a.min;
+                s.max = a.max;
+                s.mean = a.sum / a.n;
+                s.last = a.last;
+            }
+            else
+                s.min = s.max = s.mean = s.last = INVALID_DOUBLE;
+
+            clear(a);
+        }
+    }
+
+    if (!queue_.push(frame_))
+        dropped_.fetch_add(1, std::memory_order_relaxed);
+}
+
+// ----------------------------------------------------------------------------------------------------
+
+void Telemetry::clear(Accumulator& acc)
+{
+    acc.min = 0;
+    acc.max = 0;
+    acc.sum = 0;
+    acc.last = 0;
+    acc.n = 0;
+}
+
+// ----------------------------------------------------------------------------------------------------
+
+void Telemetry::start(double period)
+{
+    stop();
+
+    running_ = true;
+    thread_ = std::thread(&Telemetry::run, this, period);
+}
+
+// ----------------------------------------------------------------------------------------------------
+
+void Telemetry::stop()
+{
+    running_ = false;
+    if (thread_.joinable())
+        thread_.join();
+
+    flush();
+}
+
+// ----------------------------------------------------------------------------------------------------
+
+void Telemetry::run(double period)
+{
+    typedef std::chrono::steady_clock Clock;
+
+    Clock::duration step = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(period));
+    Clock::time_point t_next = Clock::now();
+
+    while(running_)
+    {
+        flush();
+
+        t_next += step;
+        Clock::time_point t = Clock::now();
+        if (t_next < t)
+            t_next = t + step; // Overrun: do not try to catch up
+
+        std::this_thread::sleep_until(t_next);
+    }
+}
+
+// ----------------------------------------------------------------------------------------------------
+
+void Telemetry::flush()
+{
+    while(queue_.pop(write_frame_))
+    {
+        if (!sink_)
+            continue;
+
+        if (sink_->restarted())
+            encoder_.reset();
+
+        buffer_.clear();
+        encoder_.encode(write_frame_, buffer_);
+
+        if (sink_->write(&buffer_[0], buffer_.size()))
+        {
+            ++frames_written_;
+            bytes_written_ += buffer_.size();
+        }
+        else
+        {
+            // The next frame can not be decoded against this one, so make it a key frame
+            dropped_.fetch_add(1, std::memory_order_relaxed);
+            encoder_.reset();
+        }
+    }
+}
+
+// ----------------------------------------------------------------------------------------------------
+
+} // end namespace control
+
+} // end namespace tue
@@ -0,0 +1,167 @@
+#include "tue/control/watchdog.h"
+
+#include "tue/control/supervised_controller.h"
+
+#include <chrono>
+#include <cmath>
+#include <pthread.h>
+
+namespace tue
+{
+namespace control
+{
+
+// ----------------------------------------------------------------------------------------------------
+
+Watchdog::Watchdog() : running_(false)
+{
+}
+
+// ----------------------------------------------------------------------------------------------------
+
+Watchdog::~Watchdog()
+{
+    stop();
+}
+
+// ----------------------------------------------------------------------------------------------------
+
+void Watchdog::addController(const std::shared_ptr<SupervisedController>& controller, std::atomic<double>* output)
+{
+    std::shared_ptr<Entry> e(new Entry);
+    e->controller = controller;
+    e->output = output;
+    e->heartbeat = 0;
+    e->last_check = INVALID_DOUBLE;
+    e->held_output = 0;
+    e->written_output = 0;
+    e->tripped = false;
+
+    entries_.push_back(e);
+}
+
+// ----------------------------------------------------------------------------------------------------
+
+bool Watchdog::start(double period, int priority)
+{
+    stop();
+
+    running_ = true;
+    thread_ = std::thread(&Watchdog::run, this, period);
+
+    if (priority <= 0)
+        return true;
+
+    sched_param param;
+    param.sched_priority = priority;
+    return pthread_setschedparam(thread_.native_handle(), SCHED_FIFO, &param) == 0;
+}
+
+// ----------------------------------------------------------------------------------------------------
+
+void Watchdog::stop()
+{
+    running_ = false;
+    if (thread_.joinable())
+        thread_.join();
+}
+
+// ----------------------------------------------------------------------------------------------------
+
+void Watchdog::run(double period)
+{
+    typedef std::chrono::steady_clock Clock;
+
+    Clock::duration step = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(period));
+    Clock::time_point t_next = Clock::now();
+
+    while(running_)
+    {
+        // Same clock as the heartbeat times
+        Clock::time_point t = Clock::now();
+        check(std::chrono::duration<double>(t.time_since_epoch()).count());
+
+        t_next += step;
+        if (t_next < t)
+            t_next = t + step; // Overrun: do not try to catch up
+
+        std::this_thread::sleep_until(t_next);
+    }
+}
+
+// ----------------------------------------------------------------------------------------------------
+
+void Watchdog::check(double now)
+{
+    for(std::vector<std::shared_ptr<Entry> >::iterator it = entries_.begin(); it != entries_.end(); ++it)
+    {
+        Entry& e = **it;
+        const WatchdogSettings& settings = e.controller->watchdog_settings();
+        if (!settings.is_configured())
+            continue;
+
+        // The time is at least as recent as the heartbeat read before it
+        unsigned long beat = e.controller->heartbeat();
+        double beat_time = e.controller->heartbeat_time();
+
+        bool tripped = e.tripped.load(std::memory_order_relaxed);
+
+        // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+        // Trip
+
+        if (tripped)
+        {
+            // The controller is updated again (and goes to ERROR itself), so it owns the output again
+            if (beat != e.heartbeat)
+                tripped = false;
+        }
+        else if (is_set(beat_time) && now - beat_time > settings.timeout)
+        {
+            tripped = true;
+            e.heartbeat = beat;
+            e.controller->tripWatchdog();
+
+            e.written_output = e.output->load(std::memory_order_relaxed);
+            e.held_output = (settings.fallback == FALLBACK_HOLD && is_set(e.written_output)) ? e.written_output : 0;
+        }
+
+        // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+        // Write the fallback output, unless the real-time loop stored a newer output since the last
+        // time the monitor read or wrote it
+
+        if (tripped)
+        {
+            if (settings.fallback == FALLBACK_HOLD && is_set(e.last_check))
+                e.held_output *= std::exp(-(now - e.last_check) / settings.decay);
+
+            double expected = e.written_output;
+            if (e.output->compare_exchange_strong(expected, e.held_output, std::memory_order_relaxed))
+                e.written_output = e.held_output;
+            else
+                tripped = false;
+        }
+
+        e.tripped.store(tripped, std::memory_order_relaxed);
+        e.last_check = now;
+    }
+}
+
+// ----------------------------------------------------------------------------------------------------
+
+unsigned long Watchdog::late_ticks(unsigned int i) const
+{
+    return entries_[i]->controller->late_ticks();
+}
+
+// ----------------------------------------------------------------------------------------------------
+
+unsigned long Watchdog::missed_ticks(unsigned int i) const
+{
+    return entries_[i]->controller->missed_ticks();
+}
+
+// ----------------------------------------------------------------------------------------------------
+
+} // end namespace control
+
+} // end namespace tue
@@ -0,0 +1,133 @@
+#include <tue/control/supervised_controller.h>
+#include <tue/control/generic_controller.h>
+
+#include <chrono>
+#include <cmath>
+#include <iostream>
+
+// ----------------------------------------------------------------------------------------------------
+
+// Returns the average time of an update [ns]
+double benchmark(tue::control::SupervisedController& c, unsigned int n)
+{
+    c.enable();
+    c.update(0);
+
+    double sum = 0;
+
+    std::chrono::steady_clock::time_point t_start = std::chrono::steady_clock::now();
+
+    for(unsigned int i = 0; i < n; ++i)
+    {
+        c.update(1e-4 * std::sin(1e-3 * i));
+        sum += c.output();
+    }
+
+    std::chrono::steady_clock::time_point t_end = std::chrono::steady_clock::now();
+
+    // Use the result, so the loop can not be optimized away
+    if (sum == 12345)
+        std::cout << sum << std::endl;
+
+    return std::chrono::duration<double, std::nano>(t_end - t_start).count() / n;
+}
+
+// ----------------------------------------------------------------------------------------------------
+
+// Returns the average time of a controller core update [ns], called virtually or directly
+template<bool VIRTUAL>
+double benchmarkCore(tue::control::GenericController& c, unsigned int n)
+{
+    tue::control::Controller& base = c;
+
+    tue::control::ControllerInput input;
+    input.pos_reference = 0;
+    input.vel_reference = 0;
+    input.acc_reference = 0;
+
+    tue::control::ControllerOutput output;
+
+    double sum = 0;
+
+    std::chrono::steady_clock::time_point t_start = std::chrono::steady_clock::now();
+
+    for(unsigned int i = 0; i < n; ++i)
+    {
+        input.measurement = 1e-4 * std::sin(1e-3 * i);
+        if (VIRTUAL)
+            base.update(input, output);
+        else
+            c.tue::control::GenericController::update(input, output);
+        sum += output.value;
+    }
+
+    std::chrono::steady_clock::time_point t_end = std::chrono::steady_clock::now();
+
+    if (sum == 12345)
+        std::cout << sum << std::endl;
+
+    return std::chrono::duration<double, std::nano>(t_end - t_start).count() / n;
+}
+
+// ----------------------------------------------------------------------------------------------------
+
+int main(int argc, char **argv)
+{
+    if (argc != 2)
+    {
+        std::cerr << "Please provide config file" << std::endl;
+        return 1;
+    }
+
+    tue::Configuration config;
+    config.loadFromYAMLFile(argv[1]);
+    if (config.hasError())
+    {
+        std::cerr << config.error() << std::endl;
+        return 1;
+    }
+
+    double dt;
+    config.value("dt", dt);
+
+    // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+    // Same controller, held through a shared pointer (virtual dispatch) and inline (switch dispatch)
+
+    std::shared_ptr<tue::control::GenericController> generic = std::make_shared<tue::control::GenericController>();
+    generic->configure(config, dt);
+
+    tue::control::SupervisedController shared;
+    shared.setController(generic);
+    shared.configure(config, dt);
+
+    tue::control::SupervisedController inlined;
+    inlined.emplaceController(tue::control::INLINE_GENERIC)->configure(config, dt);
+    inlined.configure(config, dt);
+
+    if (config.hasError())
+    {
+        std::cerr << config.error() << std::endl;
+        return 1;
+    }
+
+    // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+    unsigned int n = 10000000;
+
+    // Warm up
+    benchmark(shared, n / 10);
+    benchmark(inlined, n / 10);
+
+    double t_shared = benchmark(shared, n);
+    double t_inlined = benchmark(inlined, n);
+
+    double t_virtual = benchmarkCore<true>(*generic, n);
+    double t_direct = benchmarkCore<false>(*generic, n);
+
+    std::cout << "SupervisedController, virtual dispatch: " << t_shared << " ns / update" << std::endl;
+    std::cout << "SupervisedController, inline storage:   " << t_inlined << " ns / update" << std::endl;
+    std::cout << "GenericController, virtual call:        " << t_virtual << " ns / update" << std::endl;
+    std::cout << "GenericController, direct call:         " << t_direct << " ns / update" << std::endl;
+
+    return 0;
+}
@@ -0,0 +1,211 @@
+#include <tue/control/supervised_controller.h>
+
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+// ----------------------------------------------------------------------------------------------------
+
+// Counts the cache misses of the calling thread. Not available if the kernel does not allow
+// perf_event_open (e.g. in containers), in which case only timings are reported.
+class CacheMissCounter
+{
+
+public:
+
+    CacheMissCounter()
+    {
+        perf_event_attr attr;
+        std::memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.config = PERF_COUNT_HW_CACHE_MISSES;
+        attr.disabled = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+
+        fd_ = syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0);
+    }
+
+    ~CacheMissCounter()
+    {
+        if (fd_ >= 0)
+            close(fd_);
+    }
+
+    bool is_available() const { return fd_ >= 0; }
+
+    void start()
+    {
+        if (fd_ < 0)
+            return;
+        ioctl(fd_, PERF_EVENT_IOC_RESET, 0);
+        ioctl(fd_, PERF_EVENT_IOC_ENABLE, 0);
+    }
+
+    long long stop()
+    {
+        if (fd_ < 0)
+            return -1;
+
+        ioctl(fd_, PERF_EVENT_IOC_DISABLE, 0);
+
+        long long count = 0;
+        if (read(fd_, &count, sizeof(count)) != sizeof(count))
+            return -1;
+        return count;
+    }
+
+private:
+
+    long fd_;
+
+};
+
+// ----------------------------------------------------------------------------------------------------
+
+struct ThreadResult
+{
+    ThreadResult() : ticks(0), cache_misses(-1) {}
+
+    unsigned long ticks;
+    long long cache_misses;
+};
+
+// Updates joints thread, thread + num_threads, ... (interleaved, so that neighbouring objects are
+// updated by different threads) for n ticks
+void run(std::vector<std::shared_ptr<tue::control::SupervisedController> >* controllers, unsigned int thread,
+         unsigned int num_threads, unsigned int n, std::atomic<unsigned int>* ready, ThreadResult* result)
+{
+    CacheMissCounter counter;
+
+    // Start at the same time
+    ready->fetch_add(1);
+    while(ready->load() < num_threads)
+        std::this_thread::yield();
+
+    counter.start();
+
+    double sum = 0;
+    for(unsigned int i = 0; i < n; ++i)
+    {
+        for(unsigned int j = thread; j < controllers->size(); j += num_threads)
+        {
+            tue::control::SupervisedController& c = *(*controllers)[j];
+            c.update(1e-4 * std::sin(1e-3 * (i + j)));
+            sum += c.output();
+            ++result->ticks;
+        }
+    }
+
+    result->cache_misses = counter.stop();
+
+    // Use the result, so the loop can not be optimized away
+    if (sum == 12345)
+        std::cout << sum << std::endl;
+}
+
+// ----------------------------------------------------------------------------------------------------
+
+int main(int argc, char **argv)
+{
+    if (argc < 2)
+    {
+        std::cerr << "Please provide config file (and optionally the number of threads)" << std::endl;
+        return 1;
+    }
+
+    tue::Configuration config;
+    config.loadFromYAMLFile(argv[1]);
+    if (config.hasError())
+    {
+        std::cerr << config.error() << std::endl;
+        return 1;
+    }
+
+    double dt;
+    config.value("dt", dt);
+
+    unsigned int num_threads = std::max(2u, std::thread::hardware_concurrency());
+    if (argc > 2)
+        num_threads = std::max(1, atoi(argv[2]));
+
+    // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+    // 64 joints, allocated one after the other (as the factory does)
+
+    const unsigned int NUM_JOINTS = 64;
+
+    std::vector<std::shared_ptr<tue::control::SupervisedController> > controllers;
+    for(unsigned int j = 0; j < NUM_JOINTS; ++j)
+    {
+        std::shared_ptr<tue::control::SupervisedController> c(new tue::control::SupervisedController);
+        c->emplaceController(tue::control::INLINE_GENERIC)->configure(config, dt);
+        c->configure(config, dt);
+        c->enable();
+        c->update(0);
+        controllers.push_back(c);
+    }
+
+    if (config.hasError())
+    {
+        std::cerr << config.error() << std::endl;
+        return 1;
+    }
+
+    unsigned int misaligned = 0;
+    for(unsigned int j = 0; j < NUM_JOINTS; ++j)
+        if (reinterpret_cast<std::uintptr_t>(controllers[j].get()) % tue::control::CACHE_LINE_SIZE != 0)
+            ++misaligned;
+
+    // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+    unsigned int n = 200000;
+
+    std::atomic<unsigned int> ready(0);
+    std::vector<ThreadResult> results(num_threads);
+
+    std::chrono::steady_clock::time_point t_start = std::chrono::steady_clock::now();
+
+    std::vector<std::thread> threads;
+    for(unsigned int t = 0; t < num_threads; ++t)
+        threads.push_back(std::thread(run, &controllers, t, num_threads, n, &ready, &results[t]));
+
+    for(unsigned int t = 0; t < num_threads; ++t)
+        threads[t].join();
+
+    std::chrono::steady_clock::time_point t_end = std::chrono::steady_clock::now();
+
+    unsigned long ticks = 0;
+    long long cache_misses = 0;
+    for(unsigned int t = 0; t < num_threads; ++t)
+    {
+        ticks += results[t].ticks;
+        if (results[t].cache_misses < 0 || cache_misses < 0)
+            cache_misses = -1;
+        else
+            cache_misses += results[t].cache_misses;
+    }
+
+    std::cout << NUM_JOINTS << " joints, " << num_threads << " threads, sizeof(SupervisedController) = "
+              << sizeof(tue::control::SupervisedController) << ", " << misaligned << " not cache line aligned" << std::endl;
+
+    std::cout << "Wall time: " << std::chrono::duration<double, std::nano>(t_end - t_start).count() / ticks
+              << " ns / update" << std::endl;
+
+    if (cache_misses >= 0)
+        std::cout << "Cache misses: " << static_cast<double>(cache_misses) / ticks << " / update" << std::endl;
+    else
+        std::cout << "Cache misses: not available (perf_event_open not permitted)" << std::endl;
+
+    return 0;
+}
@@ -0,0 +1,45 @@
+#ifndef TUE_CONTROL_TEST_PLANT_H_
+#define TUE_CONTROL_TEST_PLANT_H_
+
+#include <cmath>
+
+// ----------------------------------------------------------------------------------------------------
+
+// Flexible link: the tip is connected to the base (which follows the commanded position exactly)
+// by an undamped mode with the given frequency [Hz]
+
+class FlexibleLink
+{
+
+public:
+
+    FlexibleLink(double frequency) : w_(2 * M_PI * frequency), base_(0), tip_(0), tip_vel_(0) {}
+
+    void setPosition(double pos) { base_ = pos; tip_ = pos; tip_vel_ = 0; }
+
+    void update(double base, double dt)
+    {
+        // Sub-steps, such that the integration error is small compared to the residual vibration
+        const unsigned int N = 20;
+        for(unsigned int i = 0; i < N; ++i)
+        {
+            tip_vel_ += dt / N * w_ * w_ * (base - tip_);
+            tip_ += dt / N * tip_vel_;
+        }
+        base_ = base;
+    }
+
+    double base() const { return base_; }
+
+    double tip() const { return tip_; }
+
+private:
+
+    double w_;
+    double base_;
+    double tip_;
+    double tip_vel_;
+
+};
+
+#endif
@@ -0,0 +1,138 @@
+#include <tue/control/generic_controller.h>
+#include <tue/control/adaptive_notch.h>
+
+#include <tue/config/configuration.h>
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+// ----------------------------------------------------------------------------------------------------
+
+// Feeds a sine with the given frequency [Hz] and unit amplitude as error to the controller for
+// 'duration' [s], and returns the output amplitude over the last 0.5 s
+
+double sineResponse(tue::control::Controller& c, double frequency, double duration, double dt, double& t)
+{
+    tue::control::ControllerInput input;
+    tue::control::ControllerOutput output;
+    input.measurement = 0;
+
+    double amplitude = 0;
+    unsigned int n = static_cast<unsigned int>(duration / dt + 0.5);
+    for(unsigned int i = 0; i < n; ++i, t += dt)
+    {
+        input.pos_reference = std::sin(2 * M_PI * frequency * t);
+        c.update(input, output);
+
+        if (i * dt >= duration - 0.5)
+            amplitude = std::max(amplitude, std::abs(output.value));
+    }
+
+    return amplitude;
+}
+
+// ----------------------------------------------------------------------------------------------------
+
+int main(int argc, char **argv)
+{
+    if (argc != 2)
+    {
+        std::cerr << "Please provide config file" << std::endl;
+        return 1;
+    }
+
+    tue::Configuration config;
+    config.loadFromYAMLFile(argv[1]);
+    if (config.hasError())
+    {
+        std::cerr << config.error() << std::endl;
+        return 1;
+    }
+
+    double dt;
+    config.value("dt", dt);
+
+    std::vector<double> resonances(2, 0);
+    config.value("resonance", resonances[0]);
+    config.value("shifted_resonance", resonances[1]);
+
+    tue::control::GenericController fixed, adaptive;
+    if (config.readGroup("skewed_notch"))
+    {
+        fixed.configure(config, dt);
+        config.endGroup();
+    }
+
+    if (config.readGroup("adaptive_notch"))
+    {
+        adaptive.configure(config, dt);
+        config.endGroup();
+    }
+
+    if (config.hasError())
+    {
+        std::cerr << config.error() << std::endl;
+        return 1;
+    }
+
+    bool ok = true;
+
+    // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+    // Fixed notch: blocks its own frequency, passes low frequencies
+
+    double t = 0;
+    double at_notch = sineResponse(fixed, 40, 3, dt, t);
+    double below = sineResponse(fixed, 5, 3, dt, t);
+
+    std::cout << "Skewed notch at 40 Hz: gain " << at_notch << " at 40 Hz, " << below << " at 5 Hz" << std::endl;
+    ok &= (at_notch < 0.05 && below > 0.95);
+
+    // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+    // Adaptive notch: passes the resonance until it has found it, then blocks it; finds the new
+    // resonance after the change of payload
+
+    t = 0;
+    for(unsigned int k = 0; k < resonances.size(); ++k)
+    {
+        double f = resonances[k];
+        double initially = sineResponse(adaptive, f, 0.5, dt, t);
+        double settled = sineResponse(adaptive, f, 10, dt, t);
+
+        std::cout << "Adaptive notch, resonance at " << f << " Hz: gain " << initially << " initially, "
+                  << settled << " after 10 s" << std::endl;
+        ok &= (settled < 0.1 && initially > 4 * settled);
+    }
+
+    // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+    // Frequency estimate of the notch itself, and a configuration with an unrelated error
+
+    tue::control::AdaptiveNotch notch;
+    config.addError("unrelated error");
+    if (config.readGroup("adaptive_notch") && config.readGroup("filters") && config.readGroup("adaptive_notch"))
+    {
+        notch.configure(config, dt);
+        config.endGroup();
+        config.endGroup();
+        config.endGroup();
+    }
+
+    double f_estimate = 0;
+    if (notch.is_configured())
+    {
+        for(unsigned int i = 0; i < 10000; ++i)
+            notch.update(0, std::sin(2 * M_PI * resonances[0] * i * dt));
+        f_estimate = notch.frequency();
+    }
+
+    std::cout << "Estimated resonance: " << f_estimate << " Hz (actual " << resonances[0] << " Hz)" << std::endl;
+    ok &= (std::abs(f_estimate - resonances[0]) < 1);
+
+    if (!ok)
+    {
+        std::cerr << "Notch does not block the (tracked) resonance" << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
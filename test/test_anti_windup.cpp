@@ -0,0 +1,128 @@
+#include <tue/control/controller_factory.h>
+#include <tue/control/supervised_controller.h>
+
+#include <tue/control/generic_controller.h>
+
+#include <tue/control/plant_model.h>
+
+// ----------------------------------------------------------------------------------------------------
+
+struct StepResponse
+{
+    double overshoot;
+    double settling_time;
+    double max_slew;
+    unsigned int clamped_ticks;
+    bool error;
+};
+
+// ----------------------------------------------------------------------------------------------------
+
+// Runs a step response of 'c' that is large enough to saturate the output
+StepResponse stepResponse(tue::control::SupervisedController& c, double dt, double step)
+{
+    tue::control::PlantModel plant;
+    plant.reset(0);
+
+    c.enable();
+    c.update(plant.position());
+    c.setReference(step);
+
+    StepResponse r;
+    r.overshoot = 0;
+    r.settling_time = 0;
+    r.max_slew = 0;
+    r.clamped_ticks = 0;
+
+    double previous_output = c.output();
+
+    for(int t = 0; t < 10000; ++t)
+    {
+        c.update(plant.position());
+        plant.update(c.output(), dt);
+
+        r.overshoot = std::max(r.overshoot, (plant.position() - step) / step);
+        r.max_slew = std::max(r.max_slew, std::abs(c.output() - previous_output) / dt);
+        previous_output = c.output();
+
+        if (c.output_clamp() != 0)
+            ++r.clamped_ticks;
+
+        // Last time the error was outside a 1% band
+        if (std::abs(plant.position() - step) > 0.01 * step)
+            r.settling_time = (t + 1) * dt;
+    }
+
+    r.error = (c.status() == tue::control::ERROR);
+
+    return r;
+}
+
+// ----------------------------------------------------------------------------------------------------
+
+int main(int argc, char **argv)
+{
+    if (argc != 2)
+    {
+        std::cerr << "Please provide config file" << std::endl;
+        return 1;
+    }
+
+    tue::Configuration config;
+    config.loadFromYAMLFile(argv[1]);
+    if (config.hasError())
+    {
+        std::cerr << config.error() << std::endl;
+        return 1;
+    }
+
+    double dt;
+    config.value("dt", dt);
+
+    // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+    // Same controller, without and with anti-windup
+
+    tue::control::ControllerFactory factory;
+    factory.registerControllerType<tue::control::GenericController>("generic");
+
+    std::vector<std::shared_ptr<tue::control::SupervisedController> > controllers;
+    if (!factory.createControllers(config, dt, controllers) || controllers.size() != 2)
+    {
+        std::cerr << config.error() << std::endl;
+        return 1;
+    }
+
+    // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+    double step = 0.5;
+
+    // As configured (safety: slew_rate)
+    double slew_rate = 50000;
+
+    StepResponse r[2];
+    for(unsigned int i = 0; i < 2; ++i)
+    {
+        r[i] = stepResponse(*controllers[i], dt, step);
+        std::cout << controllers[i]->name() << ": overshoot = " << 100 * r[i].overshoot << "%, settling time = "
+                  << r[i].settling_time << " s, clamped " << r[i].clamped_ticks << " ticks, max slew rate = "
+                  << r[i].max_slew << (r[i].error ? " (ERROR)" : "") << std::endl;
+    }
+
+    // Both must have been limited (so the comparison is meaningful) and respect the slew rate limit
+    for(unsigned int i = 0; i < 2; ++i)
+    {
+        if (r[i].error || r[i].clamped_ticks == 0 || r[i].max_slew > slew_rate * (1 + 1e-9))
+        {
+            std::cerr << controllers[i]->name() << ": output was not limited as configured" << std::endl;
+            return 1;
+        }
+    }
+
+    if (r[1].overshoot >= r[0].overshoot || r[1].settling_time >= r[0].settling_time)
+    {
+        std::cerr << "Anti-windup did not improve the recovery after saturation" << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
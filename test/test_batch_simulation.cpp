@@ -0,0 +1,272 @@
+#include <tue/control/controller_factory.h>
+#include <tue/control/supervised_controller.h>
+
+#include <tue/control/batch_simulation.h>
+#include <tue/control/generic_controller.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <thread>
+
+// ----------------------------------------------------------------------------------------------------
+
+// Creates num_joints enabled controllers from the same configuration
+
+bool create(const tue::control::ControllerFactory& factory, tue::Configuration& config, double dt,
+            unsigned int num_joints, std::vector<std::shared_ptr<tue::control::SupervisedController> >& controllers)
+{
+    controllers.clear();
+    for(unsigned int j = 0; j < num_joints; ++j)
+    {
+        std::shared_ptr<tue::control::SupervisedController> c = factory.createController(config, dt);
+        if (!c)
+            return false;
+
+        c->enable();
+        c->update(0);
+        controllers.push_back(c);
+    }
+
+    return true;
+}
+
+// ----------------------------------------------------------------------------------------------------
+
+// Every joint gets a different plant
+
+tue::control::BatchPlant plant(unsigned int j)
+{
+    tue::control::BatchPlant p;
+    p.mass = 1 + 0.05 * j;
+    p.damping = 2 + 0.1 * j;
+    return p;
+}
+
+// ----------------------------------------------------------------------------------------------------
+
+// Runs a batch simulation of new controllers with the given number of threads, in runs of at most
+// max_ticks ticks. Returns the duration [s].
+
+double run(const tue::control::ControllerFactory& factory, tue::Configuration& config, double dt, unsigned int num_joints,
+           unsigned int num_threads, bool closed_loop, const std::vector<double>& input, unsigned int num_ticks,
+           unsigned int max_ticks, std::vector<double>& trace1, std::vector<double>& trace2)
+{
+    std::vector<std::shared_ptr<tue::control::SupervisedController> > controllers;
+    create(factory, config, dt, num_joints, controllers);
+
+    tue::control::BatchSimulation sim;
+    for(unsigned int j = 0; j < num_joints; ++j)
+    {
+        sim.addController(controllers[j]);
+        sim.setPlant(j, plant(j));
+    }
+    sim.setNumThreads(num_threads);
+
+    trace1.assign(input.size(), 0);
+    trace2.assign(input.size(), 0);
+
+    // Traces of a part of the run (consecutive runs continue where the previous one stopped)
+    std::vector<double> in, out1, out2;
+
+    std::chrono::steady_clock::time_point t_start = std::chrono::steady_clock::now();
+
+    for(unsigned int start = 0; start < num_ticks; start += max_ticks)
+    {
+        unsigned int n = std::min(max_ticks, num_ticks - start);
+
+        const double* in_ptr = &input[0];
+        double* out1_ptr = &trace1[0];
+        double* out2_ptr = &trace2[0];
+
+        if (n < num_ticks)
+        {
+            in.resize(num_joints * n);
+            out1.resize(num_joints * n);
+            out2.resize(num_joints * n);
+            for(unsigned int j = 0; j < num_joints; ++j)
+                std::copy(&input[j * num_ticks + start], &input[j * num_ticks + start + n], &in[j * n]);
+
+            in_ptr = &in[0];
+            out1_ptr = &out1[0];
+            out2_ptr = &out2[0];
+        }
+
+        if (closed_loop)
+            sim.runClosedLoop(in_ptr, n, out1_ptr, out2_ptr);
+        else
+            sim.runOpenLoop(in_ptr, n, out1_ptr, out2_ptr);
+
+        if (n < num_ticks)
+        {
+            for(unsigned int j = 0; j < num_joints; ++j)
+            {
+                std::copy(&out1[j * n], &out1[(j + 1) * n], &trace1[j * num_ticks + start]);
+                std::copy(&out2[j * n], &out2[(j + 1) * n], &trace2[j * num_ticks + start]);
+            }
+        }
+    }
+
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - t_start).count();
+}
+
+// ----------------------------------------------------------------------------------------------------
+
+int main(int argc, char **argv)
+{
+    if (argc != 2)
+    {
+        std::cerr << "Please provide config file" << std::endl;
+        return 1;
+    }
+
+    tue::Configuration config;
+    config.loadFromYAMLFile(argv[1]);
+    if (config.hasError())
+    {
+        std::cerr << config.error() << std::endl;
+        return 1;
+    }
+
+    double dt;
+    config.value("dt", dt);
+
+    tue::control::ControllerFactory factory;
+    factory.registerControllerType<tue::control::GenericController>("generic");
+
+    // One minute at 1 kHz for 50 joints
+    const unsigned int NUM_JOINTS = 50;
+    unsigned int num_ticks = static_cast<unsigned int>(60 / dt + 0.5);
+
+    std::vector<std::shared_ptr<tue::control::SupervisedController> > controllers;
+    if (!create(factory, config, dt, NUM_JOINTS, controllers))
+    {
+        std::cerr << config.error() << std::endl;
+        return 1;
+    }
+
+    // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+    // Reference: the same joints updated one by one, with a sine reference of their own
+
+    std::vector<double> references(NUM_JOINTS * num_ticks);
+    std::vector<double> positions(NUM_JOINTS * num_ticks);
+    std::vector<double> outputs(NUM_JOINTS * num_ticks);
+
+    double max_error = 0;
+    unsigned int num_active = 0;
+
+    for(unsigned int j = 0; j < NUM_JOINTS; ++j)
+    {
+        tue::control::SupervisedController& c = *controllers[j];
+        tue::control::BatchPlant p = plant(j);
+
+        double amplitude = 0.1 + 0.002 * j;
+        double frequency = 0.1 + 0.01 * j;
+
+        for(unsigned int t = 0; t < num_ticks; ++t)
+        {
+            unsigned int k = j * num_ticks + t;
+            references[k] = amplitude * std::sin(2 * M_PI * frequency * t * dt);
+
+            c.setReference(references[k]);
+            c.update(p.position);
+            max_error = std::max(max_error, std::abs(c.error()));
+
+            // mass * acc = output - damping * vel
+            double acc = (c.output() - p.damping * p.velocity) / p.mass;
+            p.velocity += dt * acc;
+            p.position += dt * p.velocity;
+
+            positions[k] = p.position;
+            outputs[k] = c.output();
+        }
+
+        if (c.status() == tue::control::ACTIVE)
+            ++num_active;
+    }
+
+    std::cout << num_active << " of " << NUM_JOINTS << " joints active, peak tracking error " << max_error << std::endl;
+
+    // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+    // Closed loop: all thread counts (also ones that do not divide the joints) and split runs
+    // must give exactly the traces of the loop above
+
+    unsigned int num_cores = std::max(1u, std::thread::hardware_concurrency());
+    unsigned int thread_counts[] = { 1, 7, 0 };
+    unsigned int max_ticks[] = { num_ticks, num_ticks, num_ticks / 3 + 1 };
+
+    // The joints must track their reference (the smallest amplitude is 0.1), not only stay within
+    // the safety limits, for the traces to be meaningful
+    bool ok = (num_active == NUM_JOINTS && max_error < 0.05);
+    double duration_serial = 0, duration_parallel = 0;
+
+    for(unsigned int i = 0; i < 3; ++i)
+    {
+        std::vector<double> batch_positions, batch_outputs;
+        double duration = run(factory, config, dt, NUM_JOINTS, thread_counts[i], true, references, num_ticks,
+                              max_ticks[i], batch_positions, batch_outputs);
+
+        bool same = (batch_positions == positions && batch_outputs == outputs);
+        if (!same)
+            ok = false;
+
+        if (thread_counts[i] == 1)
+            duration_serial = duration;
+        else if (thread_counts[i] == 0)
+            duration_parallel = duration;
+
+        std::cout << "Closed loop, " << (thread_counts[i] == 0 ? num_cores : thread_counts[i]) << " threads, runs of "
+                  << max_ticks[i] << " ticks: " << 1000 * duration << " ms, traces "
+                  << (same ? "equal" : "DIFFERENT") << std::endl;
+    }
+
+    // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+    // Open loop over the recorded positions
+
+    std::vector<double> open_outputs(NUM_JOINTS * num_ticks);
+    std::vector<double> open_errors(NUM_JOINTS * num_ticks);
+
+    create(factory, config, dt, NUM_JOINTS, controllers);
+    for(unsigned int j = 0; j < NUM_JOINTS; ++j)
+    {
+        tue::control::SupervisedController& c = *controllers[j];
+        for(unsigned int t = 0; t < num_ticks; ++t)
+        {
+            unsigned int k = j * num_ticks + t;
+            c.update(positions[k]);
+            open_outputs[k] = c.output();
+            open_errors[k] = c.error();
+        }
+    }
+
+    for(unsigned int i = 0; i < 3; ++i)
+    {
+        std::vector<double> batch_outputs, batch_errors;
+        double duration = run(factory, config, dt, NUM_JOINTS, thread_counts[i], false, positions, num_ticks,
+                              max_ticks[i], batch_outputs, batch_errors);
+
+        bool same = (batch_outputs == open_outputs && batch_errors == open_errors);
+        if (!same)
+            ok = false;
+
+        std::cout << "Open loop,   " << (thread_counts[i] == 0 ? num_cores : thread_counts[i]) << " threads, runs of "
+                  << max_ticks[i] << " ticks: " << 1000 * duration << " ms, traces "
+                  << (same ? "equal" : "DIFFERENT") << std::endl;
+    }
+
+    // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+    // A minute of all joints must take far less than a minute (a few hundred ms with an
+    // optimized build), even on a single thread
+
+    std::cout << "One minute of " << NUM_JOINTS << " joints at " << 1 / dt << " Hz: " << 1000 * duration_serial
+              << " ms on 1 thread, " << 1000 * duration_parallel << " ms on " << num_cores << std::endl;
+
+    if (!ok || duration_serial > 6)
+    {
+        std::cerr << "Batch simulation does not match the controllers updated one by one, or is too slow" << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,110 @@
+#include <tue/control/controller_factory.h>
+#include <tue/control/supervised_controller.h>
+
+#include <tue/control/generic_controller.h>
+
+#include <tue/control/plant_model.h>
+
+#include <cmath>
+
+// ----------------------------------------------------------------------------------------------------
+
+// Runs 'ticks' updates and returns the largest output step between two consecutive updates
+double run(tue::control::SupervisedController& c, tue::control::PlantModel& plant, double load, double dt,
+           unsigned int ticks)
+{
+    double max_step = 0;
+    for(unsigned int t = 0; t < ticks; ++t)
+    {
+        double previous = c.output();
+        c.update(plant.position());
+        plant.update(c.output() - load, dt);
+
+        max_step = std::max(max_step, std::abs(c.output() - previous));
+    }
+    return max_step;
+}
+
+// ----------------------------------------------------------------------------------------------------
+
+int main(int argc, char **argv)
+{
+    if (argc != 2)
+    {
+        std::cerr << "Please provide config file" << std::endl;
+        return 1;
+    }
+
+    tue::Configuration config;
+    config.loadFromYAMLFile(argv[1]);
+    if (config.hasError())
+    {
+        std::cerr << config.error() << std::endl;
+        return 1;
+    }
+
+    double dt, load;
+    config.value("dt", dt);
+    config.value("load", load);
+
+    tue::control::ControllerFactory factory;
+    factory.registerControllerType<tue::control::GenericController>("generic");
+
+    std::shared_ptr<tue::control::SupervisedController> c = factory.createController(config, dt);
+    if (config.hasError())
+    {
+        std::cerr << config.error() << std::endl;
+        return 1;
+    }
+
+    tue::control::PlantModel plant;
+    plant.reset(0);
+
+    bool ok = true;
+
+    // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+    // HOMING -> ACTIVE, while moving: the feedforward of the first active update (zero velocity
+    // reference, new observer state) differs from that of the last homing update
+
+    c->update(plant.position());
+    c->startHoming();
+    run(*c, plant, load, dt, 1000);
+
+    double before = c->output();
+    c->stopHoming(0);
+    c->update(plant.position());
+    plant.update(c->output() - load, dt);
+
+    double step = std::abs(c->output() - before);
+    std::cout << "HOMING -> ACTIVE: output " << before << " -> " << c->output() << std::endl;
+    ok &= (c->status() == tue::control::ACTIVE && step < 1e-6);
+
+    // Regular steps afterwards, for reference
+    double max_step = run(*c, plant, load, dt, 2000);
+    std::cout << "Largest step while active: " << max_step << std::endl;
+
+    // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+    // IDLE -> ACTIVE: continues from the zero output applied while idle
+
+    c->disable();
+    run(*c, plant, load, dt, 10);
+
+    before = c->output();
+    c->enable();
+    c->update(plant.position());
+    plant.update(c->output() - load, dt);
+
+    step = std::abs(c->output() - before);
+    std::cout << "IDLE -> ACTIVE: output " << before << " -> " << c->output() << std::endl;
+    ok &= (c->status() == tue::control::ACTIVE && step < 1e-6);
+
+    // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+    if (!ok)
+    {
+        std::cerr << "Output jumps at the transition to ACTIVE" << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
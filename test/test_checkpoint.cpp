@@ -0,0 +1,267 @@
+#include <tue/control/controller_factory.h>
+#include <tue/control/supervised_controller.h>
+
+#include <tue/control/checkpointer.h>
+#include <tue/control/generic_controller.h>
+
+#include <tue/control/plant_model.h>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <cmath>
+#include <thread>
+
+typedef std::vector<std::shared_ptr<tue::control::SupervisedController> > Controllers;
+
+// ----------------------------------------------------------------------------------------------------
+
+double reference(unsigned int tick, double dt)
+{
+    return 0.1 * std::sin(2 * M_PI * tick * dt);
+}
+
+// ----------------------------------------------------------------------------------------------------
+
+// Measurement of the plant, with a few dropouts around tick 'gap'
+double measure(const tue::control::PlantModel& plant, unsigned int tick, unsigned int gap)
+{
+    return (tick + 2 >= gap && tick < gap + 2) ? tue::control::INVALID_DOUBLE : plant.position();
+}
+
+// ----------------------------------------------------------------------------------------------------
+
+// Updates all controllers and plants for one tick
+void step(Controllers& controllers, std::vector<tue::control::PlantModel>& plants, unsigned int tick, double dt,
+          unsigned int gap)
+{
+    for(unsigned int i = 0; i < controllers.size(); ++i)
+    {
+        controllers[i]->setReference(reference(tick, dt));
+        controllers[i]->update(measure(plants[i], tick, gap));
+        plants[i].update(controllers[i]->output(), dt);
+    }
+}
+
+// ----------------------------------------------------------------------------------------------------
+
+// Lets 'writer' checkpoint controllers a from a thread, while 'reader' restores them into b. Returns
+// false if no checkpoint could be restored, or a restored set was torn.
+bool concurrent(tue::control::Checkpointer& writer, tue::control::Checkpointer& reader, Controllers& a, Controllers& b,
+                const tue::control::PlantModel& start_plant, unsigned int& tick, double dt)
+{
+    std::atomic<bool> running(true);
+    std::thread thread([&]()
+    {
+        tue::control::PlantModel plant = start_plant;
+        for(++tick; running.load(); ++tick)
+        {
+            double r = reference(tick, dt);
+            double m = plant.position();
+            for(unsigned int i = 0; i < a.size(); ++i)
+            {
+                a[i]->setReference(r);
+                a[i]->update(m);
+            }
+            plant.update(a[0]->output(), dt);
+            writer.update();
+        }
+    });
+
+    unsigned int restores = 0, torn = 0;
+    unsigned long first_sequence = reader.sequence();
+    while(reader.sequence() < first_sequence + 20000)
+    {
+        if (!reader.restore())
+            continue;
+
+        ++restores;
+        if (b[0]->output() != b[1]->output() || b[0]->status() != tue::control::ACTIVE)
+            ++torn;
+    }
+
+    running.store(false);
+    thread.join();
+
+    std::cout << "Concurrent: " << restores << " restores during " << reader.sequence() - first_sequence
+              << " checkpoints, " << torn << " torn" << std::endl;
+
+    return restores > 0 && torn == 0;
+}
+
+// ----------------------------------------------------------------------------------------------------
+
+// Maps the checkpoint segment directly, to tamper with it as a crashed writer would
+tue::control::CheckpointBuffer* map(const std::string& name)
+{
+    int fd = shm_open(("/" + name).c_str(), O_RDWR, 0600);
+    if (fd < 0)
+        return 0;
+
+    void* p = mmap(0, sizeof(tue::control::CheckpointBuffer), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+
+    return p == MAP_FAILED ? 0 : static_cast<tue::control::CheckpointBuffer*>(p);
+}
+
+// ----------------------------------------------------------------------------------------------------
+
+int main(int argc, char **argv)
+{
+    if (argc != 2)
+    {
+        std::cerr << "Please provide config file" << std::endl;
+        return 1;
+    }
+
+    tue::Configuration config;
+    config.loadFromYAMLFile(argv[1]);
+    if (config.hasError())
+    {
+        std::cerr << config.error() << std::endl;
+        return 1;
+    }
+
+    double dt;
+    std::string name;
+    config.value("dt", dt);
+    config.value("checkpoint", name);
+
+    tue::control::ControllerFactory factory;
+    factory.registerControllerType<tue::control::GenericController>("generic");
+
+    // Controllers of the running process (a), and of the process that takes over (b)
+    Controllers a, b;
+    if (!factory.createControllers(config, dt, a) || !factory.createControllers(config, dt, b))
+    {
+        std::cerr << config.error() << std::endl;
+        return 1;
+    }
+
+    // Start without the checkpoints of a previous run
+    shm_unlink(("/" + name).c_str());
+
+    tue::control::Checkpointer writer, reader;
+    for(unsigned int i = 0; i < a.size(); ++i)
+    {
+        writer.addController(a[i]);
+        reader.addController(b[i]);
+    }
+
+    if (!writer.open(name, 1) || !reader.open(name, 1))
+    {
+        std::cerr << writer.error_message() << reader.error_message() << std::endl;
+        return 1;
+    }
+
+    bool ok = true;
+
+    // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+    // Round trip: checkpoint while extrapolating a dropout, and compare the continuation of the
+    // restored controllers with that of the original ones
+
+    std::vector<tue::control::PlantModel> plants(a.size());
+
+    for(unsigned int i = 0; i < a.size(); ++i)
+    {
+        a[i]->enable();
+        a[i]->update(plants[i].position());
+    }
+
+    unsigned int checkpoint_tick = 3000;
+    for(unsigned int tick = 1; tick <= checkpoint_tick; ++tick)
+        step(a, plants, tick, dt, checkpoint_tick);
+
+    writer.write();
+    std::vector<tue::control::PlantModel> plants_b = plants;
+
+    if (!reader.restore())
+    {
+        std::cerr << reader.error_message() << std::endl;
+        return 1;
+    }
+
+    double max_difference = 0;
+    for(unsigned int tick = checkpoint_tick + 1; tick <= checkpoint_tick + 2000; ++tick)
+    {
+        step(a, plants, tick, dt, checkpoint_tick);
+        step(b, plants_b, tick, dt, checkpoint_tick);
+
+        for(unsigned int i = 0; i < a.size(); ++i)
+        {
+            if (b[i]->status() != a[i]->status())
+                ok = false;
+            max_difference = std::max(max_difference, std::abs(b[i]->output() - a[i]->output()));
+        }
+    }
+
+    std::cout << "Round trip: status " << b[0]->status_string() << ", max output difference = "
+              << max_difference << std::endl;
+    ok &= (max_difference == 0);
+
+    // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+    // Concurrent writer: both joints get the same input, so every consistent checkpoint set has
+    // equal outputs. A torn copy would mix sets of different ticks.
+
+    unsigned int tick = checkpoint_tick + 2000;
+    ok &= concurrent(writer, reader, a, b, plants[0], tick, dt);
+
+    // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+    // Writer that died while writing a set: the sequence stays odd and the slot is half written.
+    // The restarted writer must rewrite that slot, and leave the sequence even once published.
+
+    writer.close();
+
+    tue::control::CheckpointBuffer* buffer = map(name);
+    if (!buffer)
+    {
+        std::cerr << "Could not map the checkpoint segment" << std::endl;
+        return 1;
+    }
+
+    unsigned long sequence = buffer->sequence.load();
+    buffer->sequence.store(sequence + 1);
+    buffer->slots[(sequence / 2 + 1) & 1][0].output += 1;
+
+    tue::control::Checkpointer restarted;
+    for(unsigned int i = 0; i < a.size(); ++i)
+        restarted.addController(a[i]);
+
+    if (!restarted.open(name, 1))
+    {
+        std::cerr << restarted.error_message() << std::endl;
+        return 1;
+    }
+
+    bool even = true;
+    for(unsigned int i = 0; i < 3; ++i)
+    {
+        restarted.write();
+        even &= (buffer->sequence.load() % 2 == 0);
+    }
+
+    std::cout << "Restarted writer: sequence " << sequence << " interrupted, " << buffer->sequence.load()
+              << " after 3 checkpoints" << std::endl;
+    ok &= even;
+
+    munmap(buffer, sizeof(tue::control::CheckpointBuffer));
+
+    ok &= concurrent(restarted, reader, a, b, plants[0], tick, dt);
+    restarted.close();
+
+    // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+    writer.close();
+    reader.close();
+    shm_unlink(("/" + name).c_str());
+
+    if (!ok)
+    {
+        std::cerr << "Restored controllers do not continue where the checkpointed ones stopped" << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
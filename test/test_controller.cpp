@@ -5,34 +5,24 @@
 
 #include <tue/control/generic_controller.h>
 #include <tue/control/setpoint_controller.h>
+#include <tue/control/gain_scheduled_controller.h>
+#include <tue/control/mpc_controller.h>
 
-// ----------------------------------------------------------------------------------------------------
-
-class Plant
-{
-
-public:
+#include <tue/control/homing_coordinator.h>
 
-    void setMass(double mass) { mass_ = mass; }
-
-    void setPosition(double pos) { pos_ = pos; vel_ = 0; }
-
-    void update(double f, double dt)
-    {
-        double a = f / mass_;
-        vel_ += dt * a;
-        pos_ += dt * vel_;
-    }
+#include <tue/control/plant_model.h>
 
-    double position() const { return pos_; }
-
-private:
-
-    double mass_;
-    double pos_;
-    double vel_;
+// ----------------------------------------------------------------------------------------------------
 
-};
+// Steps the plant, which can not move beyond its mechanical end stops
+void updatePlant(tue::control::PlantModel& plant, double output, double dt, double min, double max)
+{
+    plant.update(output, dt);
+    if (plant.position() < min)
+        plant.reset(min);
+    else if (plant.position() > max)
+        plant.reset(max);
+}
 
 // ----------------------------------------------------------------------------------------------------
 
@@ -57,25 +47,36 @@ int main(int argc, char **argv)
     tue::control::ControllerFactory factory;
     factory.registerControllerType<tue::control::GenericController>("generic");
     factory.registerControllerType<tue::control::SetpointController>("setpoint");
+    factory.registerControllerType<tue::control::GainScheduledController>("gain_scheduled");
+    factory.registerControllerType<tue::control::MPCController>("mpc");
 
     typedef std::shared_ptr<tue::control::SupervisedController> SupvControllerPtr;
 
     double dt;
     config.value("dt", dt);
 
-    SupvControllerPtr c = factory.createController(config, dt);
-
-    if (config.hasError())
+    std::vector<SupvControllerPtr> controllers;
+    if (!factory.createControllers(config, dt, controllers) || controllers.size() != 2)
     {
         std::cerr << config.error() << std::endl;
         return 1;
     }
 
+    // The base must be homed before the torso (see 'homing/preconditions')
+    SupvControllerPtr base = controllers[0];
+    SupvControllerPtr c = controllers[1];
+
     // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
-    Plant torso;
-    torso.setMass(-1);
-    torso.setPosition(100);
+    tue::control::PlantModel base_plant;
+    base_plant.reset(0);
+
+    // The torso moves down for a positive output
+    tue::control::PlantParameters torso_params;
+    torso_params.mass = -1;
+
+    tue::control::PlantModel torso(torso_params);
+    torso.reset(100);
 
     std::cout << std::endl;
     std::cout << "-------------------------------------------------------------" << std::endl;
@@ -83,23 +84,39 @@ int main(int argc, char **argv)
     std::cout << "-------------------------------------------------------------" << std::endl;
     std::cout << std::endl;
 
+    // Homes both joints, each until its end stop is detected
+    tue::control::HomingCoordinator homing;
+    homing.addController(base);
+    homing.addController(c);
+
+    if (!homing.initialize(dt))
+    {
+        std::cerr << homing.error_message() << std::endl;
+        return 1;
+    }
+
     int t = 0;
 
-    c->startHoming();
+    homing.start();
 
-    while(true)
+    while(!homing.done())
     {
-        if (torso.position() >= 100.2)
-        {
-            c->stopHoming(0.4);
-            break;
-        }
+        base->update(base_plant.position());
+        updatePlant(base_plant, base->output(), dt, -0.02, 1);
 
         c->update(torso.position());
-        torso.update(c->output(), dt);
+        updatePlant(torso, c->output(), dt, 0, 100.2);
+
+        homing.update();
+        if (homing.failed())
+        {
+            std::cerr << homing.error_message() << std::endl;
+            return 1;
+        }
 
         if (t % 100 == 0)
-            std::cout << "[" << dt * t << "] controller output = " << c->output() << ", measurement = " << c->measurement() << std::endl;
+            std::cout << "[" << dt * t << "] controller output = " << c->output() << ", measurement = " << c->measurement()
+                      << " (" << c->status_string() << "), base: " << base->status_string() << std::endl;
 
         ++t;
     }
@@ -114,9 +131,11 @@ int main(int argc, char **argv)
 
     while(true)
     {
-        c->update(torso.position());
-        torso.update(c->output(), dt);
+        base->update(base_plant.position());
+        updatePlant(base_plant, base->output(), dt, -0.02, 1);
 
+        c->update(torso.position());
+        updatePlant(torso, c->output(), dt, 0, 100.2);
 
         if (t % 100 == 0)
             std::cout << "[" << dt * t << "] controller output = " << c->output() << ", measurement = " << c->measurement() << std::endl;
@@ -127,6 +146,33 @@ int main(int argc, char **argv)
         ++t;
     }
 
+    tue::control::LoopStatisticsSnapshot stats;
+    c->getStatistics(stats);
+
+    std::cout << std::endl;
+    for(unsigned int i = 0; i < stats.num_windows; ++i)
+    {
+        const tue::control::LoopStatisticsWindow& w = stats.windows[i];
+        if (w.samples == 0)
+        {
+            std::cout << "Statistics over " << w.duration << " s: no complete window yet" << std::endl;
+            continue;
+        }
+
+        std::cout << "Statistics over " << w.duration << " s: error rms = " << w.error_rms << ", error peak = " << w.error_peak
+                  << ", output rms = " << w.output_rms << ", saturation = " << 100 * w.saturation_duty_cycle << "%"
+                  << ", oscillation = " << w.oscillation_frequency << " Hz" << (w.oscillating ? " (OSCILLATING)" : "") << std::endl;
+    }
+
+    // The short window is complete, and the torso settled on the reference without oscillating
+    const tue::control::LoopStatisticsWindow& w = stats.windows[0];
+    if (stats.num_windows != 2 || w.samples != 100 || !(w.error_peak < 0.005) || w.error_rms > w.error_peak
+            || w.saturation_duty_cycle != 0 || w.oscillating)
+    {
+        std::cerr << "Unexpected loop statistics" << std::endl;
+        return 1;
+    }
+
     std::cout << std::endl;
     std::cout << "-------------------------------------------------------------" << std::endl;
     std::cout << "                            ERROR                            " << std::endl;
@@ -139,5 +185,32 @@ int main(int argc, char **argv)
 
     std::cout << "[" << dt * t << "] controller output = " << c->output() << ", measurement = " << c->measurement() << std::endl;
 
+    // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+    // The windows completed before the error are kept. After re-activation the short window starts
+    // anew: it completes after exactly 100 active ticks, not earlier with samples from before the error.
+
+    tue::control::LoopStatisticsWindow before = w;
+
+    c->enable();
+    for(unsigned int i = 0; i < 100; ++i)
+    {
+        c->getStatistics(stats);
+        if (stats.windows[0].error_peak != before.error_peak || stats.windows[0].error_rms != before.error_rms)
+        {
+            std::cerr << "Statistics window completed after " << i << " ticks since re-activation" << std::endl;
+            return 1;
+        }
+
+        c->update(torso.position());
+        updatePlant(torso, c->output(), dt, 0, 100.2);
+    }
+
+    c->getStatistics(stats);
+    if (c->status() != tue::control::ACTIVE || stats.windows[0].samples != 100 || stats.windows[0].error_rms == before.error_rms)
+    {
+        std::cerr << "Statistics window did not complete after 100 ticks since re-activation" << std::endl;
+        return 1;
+    }
+
     return 0;
 }
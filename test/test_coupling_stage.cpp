@@ -0,0 +1,147 @@
+#include <tue/control/controller_factory.h>
+#include <tue/control/supervised_controller.h>
+
+#include <tue/control/coupling_stage.h>
+#include <tue/control/generic_controller.h>
+#include <tue/control/measurement_filter.h>
+#include <tue/control/state_observer.h>
+
+#include <tue/control/plant_model.h>
+
+#include <cmath>
+
+// ----------------------------------------------------------------------------------------------------
+
+int main(int argc, char **argv)
+{
+    if (argc != 2)
+    {
+        std::cerr << "Please provide config file" << std::endl;
+        return 1;
+    }
+
+    tue::Configuration config;
+    config.loadFromYAMLFile(argv[1]);
+    if (config.hasError())
+    {
+        std::cerr << config.error() << std::endl;
+        return 1;
+    }
+
+    double dt;
+    config.value("dt", dt);
+
+    tue::control::ControllerFactory factory;
+    factory.registerControllerType<tue::control::GenericController>("generic");
+
+    std::vector<std::shared_ptr<tue::control::SupervisedController> > controllers;
+    if (!factory.createControllers(config, dt, controllers))
+    {
+        std::cerr << config.error() << std::endl;
+        return 1;
+    }
+
+    tue::control::CouplingStage coupling;
+    coupling.configure(config, controllers);
+    if (config.hasError() || coupling.size() != 3)
+    {
+        std::cerr << config.error() << std::endl;
+        return 1;
+    }
+
+    // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+    // Joint space plants behind the differential: motors m0 = q0 + q1, m1 = q0 - q1, and the
+    // motor forces f0, f1 act on the joints as (f0 + f1) / 2 and (f0 - f1) / 2
+
+    std::vector<tue::control::PlantModel> joints(3);
+    double motor_measurements[3], motor_outputs[3] = { 0, 0, 0 };
+    double references[3] = { 0.1, -0.05, 0.02 };
+
+    unsigned int dropout_start = 2000, dropout_end = 2200, num_ticks = 5000;
+    bool wrist_valid_during_dropout = true, gripper_invalid_during_dropout = true;
+
+    for(unsigned int i = 0; i < 3; ++i)
+        controllers[i]->enable();
+
+    for(unsigned int tick = 0; tick < num_ticks; ++tick)
+    {
+        motor_measurements[0] = joints[0].position() + joints[1].position();
+        motor_measurements[1] = joints[0].position() - joints[1].position();
+        motor_measurements[2] = joints[2].position();
+
+        // The gripper encoder drops out
+        if (tick >= dropout_start && tick < dropout_end)
+            motor_measurements[2] = tue::control::INVALID_DOUBLE;
+
+        for(unsigned int i = 0; i < 3; ++i)
+            if (controllers[i]->accepts_references())
+                controllers[i]->setReference(references[i]);
+
+        coupling.update(motor_measurements, motor_outputs);
+
+        if (tick >= dropout_start && tick < dropout_end)
+        {
+            wrist_valid_during_dropout &= tue::control::is_set(coupling.jointMeasurement(0))
+                    && tue::control::is_set(coupling.jointMeasurement(1)) && tue::control::is_set(motor_outputs[0])
+                    && tue::control::is_set(motor_outputs[1]);
+            gripper_invalid_during_dropout &= !tue::control::is_set(coupling.jointMeasurement(2));
+        }
+
+        joints[0].update(0.5 * (motor_outputs[0] + motor_outputs[1]), dt);
+        joints[1].update(0.5 * (motor_outputs[0] - motor_outputs[1]), dt);
+        joints[2].update(motor_outputs[2], dt);
+    }
+
+    bool ok = wrist_valid_during_dropout && gripper_invalid_during_dropout;
+
+    for(unsigned int i = 0; i < 3; ++i)
+    {
+        const tue::control::SupervisedController& c = *controllers[i];
+        std::cout << c.name() << ": " << c.status_string() << ", position = " << joints[i].position()
+                  << " (reference " << references[i] << ")" << std::endl;
+        ok &= (c.status() == tue::control::ACTIVE && std::abs(joints[i].position() - references[i]) < 1e-3);
+    }
+
+    std::cout << "During the gripper dropout: wrist " << (wrist_valid_during_dropout ? "valid" : "INVALID")
+              << ", gripper " << (gripper_invalid_during_dropout ? "invalid" : "VALID") << std::endl;
+
+    if (!ok)
+    {
+        std::cerr << "Invalid gripper measurement affected the wrist, or the joints did not track" << std::endl;
+        return 1;
+    }
+
+    // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+    // An unrelated error earlier in the configuration must not leave the stages unconfigured
+
+    config.addError("Unrelated error");
+
+    tue::control::CouplingStage coupling2;
+    coupling2.configure(config, controllers);
+
+    tue::control::MeasurementFilter filter;
+    if (config.readGroup("measurement"))
+    {
+        filter.configure(config, dt);
+        config.endGroup();
+    }
+
+    tue::control::StateObserver observer;
+    if (config.readGroup("observer"))
+    {
+        observer.configure(config, dt);
+        config.endGroup();
+    }
+
+    std::cout << "With an unrelated error: coupling size = " << coupling2.size() << ", measurement filter "
+              << (filter.is_configured() ? "configured" : "NOT configured") << ", observer "
+              << (observer.is_configured() ? "configured" : "NOT configured") << std::endl;
+
+    if (coupling2.size() != 3 || !filter.is_configured() || !observer.is_configured())
+    {
+        std::cerr << "Stage left unconfigured by an unrelated configuration error" << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
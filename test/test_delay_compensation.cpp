@@ -0,0 +1,119 @@
+#include <tue/control/controller_factory.h>
+#include <tue/control/supervised_controller.h>
+
+#include <tue/control/generic_controller.h>
+
+#include <tue/control/plant_model.h>
+
+// ----------------------------------------------------------------------------------------------------
+
+struct StepResponse
+{
+    double overshoot;
+    double final_error;
+    bool error;
+};
+
+// ----------------------------------------------------------------------------------------------------
+
+// Runs a step response of 'c' against a plant with measurement delay
+StepResponse stepResponse(tue::control::SupervisedController& c, unsigned int delay, double dt, double step)
+{
+    tue::control::PlantParameters params;
+    params.delay = delay;
+
+    tue::control::PlantModel plant(params);
+
+    c.enable();
+    c.update(plant.measurement());
+    c.setReference(step);
+
+    StepResponse r;
+    r.overshoot = 0;
+
+    for(int t = 0; t < 5000; ++t)
+    {
+        c.update(plant.measurement());
+        plant.update(c.output(), dt);
+
+        r.overshoot = std::max(r.overshoot, (plant.position() - step) / step);
+    }
+
+    r.final_error = std::abs(plant.position() - step);
+    r.error = (c.status() == tue::control::ERROR);
+
+    return r;
+}
+
+// ----------------------------------------------------------------------------------------------------
+
+int main(int argc, char **argv)
+{
+    if (argc != 2)
+    {
+        std::cerr << "Please provide config file" << std::endl;
+        return 1;
+    }
+
+    tue::Configuration config;
+    config.loadFromYAMLFile(argv[1]);
+    if (config.hasError())
+    {
+        std::cerr << config.error() << std::endl;
+        return 1;
+    }
+
+    double dt;
+    config.value("dt", dt);
+
+    int delay;
+    if (config.readGroup("delay_compensation"))
+    {
+        config.value("delay", delay);
+        config.endGroup();
+    }
+
+    // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+    // Delay compensated controller (created by factory)
+
+    tue::control::ControllerFactory factory;
+    factory.registerControllerType<tue::control::GenericController>("generic");
+
+    std::shared_ptr<tue::control::SupervisedController> compensated = factory.createController(config, dt);
+
+    // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+    // Same controller without compensation
+
+    std::shared_ptr<tue::control::GenericController> generic = std::make_shared<tue::control::GenericController>();
+    generic->configure(config, dt);
+
+    tue::control::SupervisedController uncompensated;
+    uncompensated.setController(generic);
+    uncompensated.configure(config, dt);
+
+    if (config.hasError())
+    {
+        std::cerr << config.error() << std::endl;
+        return 1;
+    }
+
+    // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+    double step = 0.01;
+
+    StepResponse r1 = stepResponse(uncompensated, delay, dt, step);
+    StepResponse r2 = stepResponse(*compensated, delay, dt, step);
+
+    std::cout << "Without compensation: overshoot = " << 100 * r1.overshoot << "%, final error = " << r1.final_error
+              << (r1.error ? " (ERROR)" : "") << std::endl;
+    std::cout << "With compensation:    overshoot = " << 100 * r2.overshoot << "%, final error = " << r2.final_error
+              << (r2.error ? " (ERROR)" : "") << std::endl;
+
+    if (r2.error || r2.final_error > 1e-3 * step || r2.overshoot >= r1.overshoot)
+    {
+        std::cerr << "Delay compensation did not improve the step response" << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
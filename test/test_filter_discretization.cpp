@@ -0,0 +1,159 @@
+#include <tue/control/generic_controller.h>
+
+#include <algorithm>
+#include <cmath>
+#include <complex>
+#include <iostream>
+
+typedef std::complex<double> Complex;
+
+// ----------------------------------------------------------------------------------------------------
+
+// Continuous frequency response of a filter stage, as specified in the configuration
+Complex continuous(const std::string& stage, const double* p, double f)
+{
+    Complex s(0, 2 * M_PI * f);
+
+    if (stage == "weak_integrator")
+        return (s + 2 * M_PI * p[0]) / s;
+
+    if (stage == "lead_lag")
+        return (s / (2 * M_PI * p[0]) + 1.0) / (s / (2 * M_PI * p[1]) + 1.0);
+
+    if (stage == "skewed_notch")
+    {
+        double wz = 2 * M_PI * p[0], wp = 2 * M_PI * p[2];
+        return (s * s / (wz * wz) + 2 * p[1] * s / wz + 1.0) / (s * s / (wp * wp) + 2 * p[3] * s / wp + 1.0);
+    }
+
+    // second_order_low_pass
+    double wp = 2 * M_PI * p[0];
+    return wp * wp / (s * s + 2 * p[1] * wp * s + wp * wp);
+}
+
+// ----------------------------------------------------------------------------------------------------
+
+// Frequency response of the controller at nominal dt: the error is a sine of integer frequency f,
+// and the output is correlated with it over one second (an integer number of periods) after the
+// transient has died out
+Complex measure(tue::control::GenericController& c, double f, double dt)
+{
+    c.reset();
+
+    tue::control::ControllerInput input;
+    input.measurement = 0;
+    input.vel_reference = 0;
+    input.acc_reference = 0;
+
+    tue::control::ControllerOutput output;
+
+    unsigned int n_transient = static_cast<unsigned int>(3 / dt + 0.5);
+    unsigned int n = static_cast<unsigned int>(1 / dt + 0.5);
+
+    Complex sum(0, 0);
+    for(unsigned int t = 0; t < n_transient + n; ++t)
+    {
+        double phase = 2 * M_PI * f * t * dt;
+        input.pos_reference = std::sin(phase);
+        c.update(input, output);
+
+        // sin(phase) = Im(exp(j phase)), so the response to it is Im(H exp(j phase))
+        if (t >= n_transient)
+            sum += output.value * Complex(std::sin(phase), std::cos(phase));
+    }
+
+    return sum * (2.0 / n);
+}
+
+// ----------------------------------------------------------------------------------------------------
+
+int main(int argc, char **argv)
+{
+    if (argc != 2)
+    {
+        std::cerr << "Please provide config file" << std::endl;
+        return 1;
+    }
+
+    tue::Configuration config;
+    config.loadFromYAMLFile(argv[1]);
+    if (config.hasError())
+    {
+        std::cerr << config.error() << std::endl;
+        return 1;
+    }
+
+    double dt;
+    config.value("dt", dt);
+
+    const char* stages[] = { "weak_integrator", "lead_lag", "skewed_notch", "second_order_low_pass" };
+    const char* parameters[4][4] = { { "fz" }, { "fz", "fp" }, { "fz", "dz", "fp", "dp" }, { "fp", "dp" } };
+
+    const double frequencies[] = { 1, 3, 5, 10, 20, 30, 50, 70, 100, 200 };
+
+    bool ok = true;
+    for(unsigned int i = 0; i < 4; ++i)
+    {
+        tue::control::GenericController c;
+        double p[4] = { 0, 0, 0, 0 };
+
+        if (config.readGroup(stages[i]))
+        {
+            c.configure(config, dt);
+            if (config.readGroup("filters"))
+            {
+                if (config.readGroup(stages[i]))
+                {
+                    for(unsigned int j = 0; j < 4 && parameters[i][j]; ++j)
+                        config.value(parameters[i][j], p[j]);
+                    config.endGroup();
+                }
+                config.endGroup();
+            }
+            config.endGroup();
+        }
+
+        if (config.hasError() || p[0] == 0)
+        {
+            std::cerr << stages[i] << ": " << config.error() << std::endl;
+            return 1;
+        }
+
+        std::cout << stages[i] << ":" << std::endl;
+
+        // Errors relative to the gain of the stage (at least 1, so the depth of the notch is compared
+        // in absolute terms):
+        // - Tustin maps frequency f exactly to the continuous frequency tan(pi f dt) / (pi dt), so
+        //   there the responses must be equal up to the measurement accuracy;
+        // - up to a twentieth of the sample frequency, the warping is small enough for the response to
+        //   match the specification at f itself.
+        double max_warped_error = 0, max_band_error = 0;
+        for(unsigned int k = 0; k < sizeof(frequencies) / sizeof(double); ++k)
+        {
+            double f = frequencies[k];
+            Complex h = measure(c, f, dt);
+            Complex h_c = continuous(stages[i], p, f);
+            Complex h_w = continuous(stages[i], p, std::tan(M_PI * f * dt) / (M_PI * dt));
+
+            max_warped_error = std::max(max_warped_error, std::abs(h - h_w) / std::max(1.0, std::abs(h_w)));
+            if (f <= 0.05 / dt)
+                max_band_error = std::max(max_band_error, std::abs(h - h_c) / std::max(1.0, std::abs(h_c)));
+
+            std::cout << "    " << f << " Hz: " << 20 * std::log10(std::abs(h)) << " dB " << std::arg(h) * 180 / M_PI
+                      << " deg (specification " << 20 * std::log10(std::abs(h_c)) << " dB "
+                      << std::arg(h_c) * 180 / M_PI << " deg)" << std::endl;
+        }
+
+        std::cout << stages[i] << ": error " << max_warped_error << " at the warped frequencies, "
+                  << max_band_error << " up to " << 0.05 / dt << " Hz" << std::endl;
+        ok &= (max_warped_error < 1e-6 && max_band_error < 0.03);
+    }
+
+    if (!ok)
+    {
+        std::cerr << "Discretized filters do not match their continuous specifications" << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
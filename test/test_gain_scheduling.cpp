@@ -0,0 +1,148 @@
+#include <tue/control/gain_scheduled_controller.h>
+#include <tue/control/generic_controller.h>
+
+#include <tue/config/configuration.h>
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+// ----------------------------------------------------------------------------------------------------
+
+bool configure(tue::Configuration& config, const std::string& group, tue::control::Controller& c, double dt)
+{
+    if (!config.readGroup(group))
+        return false;
+
+    c.configure(config, dt);
+    config.endGroup();
+    return !config.hasError();
+}
+
+// ----------------------------------------------------------------------------------------------------
+
+// Output of a single update with unit error, starting from a zero filter state
+
+double unitErrorOutput(tue::control::Controller& c, double scheduling_variable)
+{
+    tue::control::ControllerInput input;
+    tue::control::ControllerOutput output;
+    input.pos_reference = 1;
+    input.measurement = 0;
+    input.scheduling_variable = scheduling_variable;
+
+    c.reset();
+    c.update(input, output);
+    return output.value;
+}
+
+// ----------------------------------------------------------------------------------------------------
+
+int main(int argc, char **argv)
+{
+    if (argc != 2)
+    {
+        std::cerr << "Please provide config file" << std::endl;
+        return 1;
+    }
+
+    tue::Configuration config;
+    config.loadFromYAMLFile(argv[1]);
+    if (config.hasError())
+    {
+        std::cerr << config.error() << std::endl;
+        return 1;
+    }
+
+    double dt;
+    config.value("dt", dt);
+
+    tue::control::GainScheduledController scheduled, position_scheduled;
+    tue::control::GenericController generic;
+    if (!configure(config, "scheduled", scheduled, dt) || !configure(config, "generic", generic, dt)
+            || !configure(config, "position_scheduled", position_scheduled, dt))
+    {
+        std::cerr << config.error() << std::endl;
+        return 1;
+    }
+
+    bool ok = true;
+
+    // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+    // On an operating point, the controller equals a generic controller with its parameters
+
+    tue::control::ControllerInput input;
+    tue::control::ControllerOutput out_scheduled, out_generic;
+    input.measurement = 0;
+    input.scheduling_variable = 1;
+
+    scheduled.reset();
+    generic.reset();
+
+    double max_difference = 0;
+    for(unsigned int i = 0; i < 2000; ++i)
+    {
+        input.pos_reference = 0.01 * std::sin(2 * M_PI * 3 * i * dt);
+        scheduled.update(input, out_scheduled);
+        generic.update(input, out_generic);
+        max_difference = std::max(max_difference, std::abs(out_scheduled.value - out_generic.value));
+    }
+
+    std::cout << "On the operating point: max difference with the generic controller = " << max_difference << std::endl;
+    ok &= (max_difference < 1e-12);
+
+    // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+    // Across the breakpoints: the response to a unit error is continuous, and equals the nearest
+    // operating point outside the range
+
+    double at_points[3] = { unitErrorOutput(scheduled, 0), unitErrorOutput(scheduled, 1), unitErrorOutput(scheduled, 2) };
+
+    double previous = unitErrorOutput(scheduled, -0.5);
+    double max_step = 0;
+    for(double s = -0.5; s <= 2.5; s += 0.001)
+    {
+        double u = unitErrorOutput(scheduled, s);
+        max_step = std::max(max_step, std::abs(u - previous));
+        previous = u;
+    }
+
+    double below = unitErrorOutput(scheduled, -1);
+    double above = unitErrorOutput(scheduled, 3);
+    double midway = unitErrorOutput(scheduled, 0.5);
+    double range = at_points[2] - at_points[0];
+
+    std::cout << "Unit error response: " << at_points[0] << ", " << at_points[1] << ", " << at_points[2]
+              << " at the operating points, " << midway << " midway between the first two, largest step "
+              << max_step << std::endl;
+
+    ok &= (range > 0 && max_step < 0.01 * range);
+    ok &= (below == at_points[0] && above == at_points[2]);
+    ok &= (midway > at_points[0] && midway < at_points[1]);
+
+    // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+    // Scheduled on the position: without filters, the gain is interpolated linearly
+
+    double gains[5];
+    double positions[5] = { -0.2, -0.1, 0, 0.05, 0.2 };
+    double expected[5] = { 100, 100, 200, 250, 300 };
+    for(unsigned int i = 0; i < 5; ++i)
+    {
+        input.pos_reference = positions[i] + 0.001;
+        input.measurement = positions[i];
+
+        position_scheduled.reset();
+        position_scheduled.update(input, out_scheduled);
+        gains[i] = out_scheduled.value / 0.001;
+
+        std::cout << "Gain at position " << positions[i] << ": " << gains[i] << " (expected " << expected[i] << ")" << std::endl;
+        ok &= (std::abs(gains[i] - expected[i]) < 1e-6);
+    }
+
+    if (!ok)
+    {
+        std::cerr << "Gain scheduling does not interpolate the operating points" << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,195 @@
+#include <tue/control/controller_factory.h>
+#include <tue/control/supervised_controller.h>
+
+#include <tue/control/generic_controller.h>
+#include <tue/control/homing_coordinator.h>
+
+#include <tue/control/plant_model.h>
+
+#include <cmath>
+
+typedef std::vector<std::shared_ptr<tue::control::SupervisedController> > Controllers;
+
+// ----------------------------------------------------------------------------------------------------
+
+int main(int argc, char **argv)
+{
+    if (argc != 2)
+    {
+        std::cerr << "Please provide config file" << std::endl;
+        return 1;
+    }
+
+    tue::Configuration config;
+    config.loadFromYAMLFile(argv[1]);
+    if (config.hasError())
+    {
+        std::cerr << config.error() << std::endl;
+        return 1;
+    }
+
+    double dt;
+    config.value("dt", dt);
+
+    tue::control::ControllerFactory factory;
+    factory.registerControllerType<tue::control::GenericController>("generic");
+
+    Controllers chain, cyclic, timeout;
+    if (config.readGroup("chain"))
+    {
+        factory.createControllers(config, dt, chain);
+        config.endGroup();
+    }
+
+    if (config.readGroup("cyclic"))
+    {
+        factory.createControllers(config, dt, cyclic);
+        config.endGroup();
+    }
+
+    if (config.readGroup("timeout"))
+    {
+        factory.createControllers(config, dt, timeout);
+        config.endGroup();
+    }
+
+    if (config.hasError() || chain.size() != 4 || cyclic.size() != 2 || timeout.size() != 3)
+    {
+        std::cerr << config.error() << std::endl;
+        return 1;
+    }
+
+    bool ok = true;
+
+    // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+    // Cyclic preconditions are rejected before anything moves
+
+    tue::control::HomingCoordinator cyclic_homing;
+    for(unsigned int i = 0; i < cyclic.size(); ++i)
+        cyclic_homing.addController(cyclic[i]);
+
+    bool initialized = cyclic_homing.initialize(dt);
+    std::cout << "Cyclic: " << (initialized ? "initialized" : cyclic_homing.error_message()) << std::endl;
+    ok &= !initialized;
+
+    // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+    // Chain: every joint moves towards its own end stop, 0.02 from its start in the homing direction
+
+    tue::control::HomingCoordinator homing;
+    for(unsigned int i = 0; i < chain.size(); ++i)
+        homing.addController(chain[i]);
+
+    if (!homing.initialize(dt))
+    {
+        std::cerr << homing.error_message() << std::endl;
+        return 1;
+    }
+
+    std::vector<tue::control::PlantModel> plants(chain.size());
+    std::vector<int> started(chain.size(), -1), homed(chain.size(), -1);
+
+    homing.start();
+
+    int t = 0;
+    for(; t < 10000 && !homing.done() && !homing.failed(); ++t)
+    {
+        for(unsigned int i = 0; i < chain.size(); ++i)
+        {
+            tue::control::SupervisedController& c = *chain[i];
+            c.update(plants[i].position());
+            plants[i].update(c.output(), dt);
+
+            if (std::abs(plants[i].position()) > 0.02)
+                plants[i].reset(plants[i].position() > 0 ? 0.02 : -0.02);
+
+            if (c.status() == tue::control::HOMING && started[i] < 0)
+                started[i] = t;
+        }
+
+        homing.update();
+
+        for(unsigned int i = 0; i < chain.size(); ++i)
+        {
+            if (homing.state(i) == tue::control::HomingCoordinator::HOMED && homed[i] < 0)
+                homed[i] = t;
+        }
+    }
+
+    for(unsigned int i = 0; i < chain.size(); ++i)
+        std::cout << chain[i]->name() << ": homing from " << started[i] * dt << " to " << homed[i] * dt << " s, "
+                  << chain[i]->status_string() << ", measurement = " << chain[i]->measurement() << std::endl;
+
+    ok &= homing.done() && !homing.failed();
+
+    // a, b, c, d in the order of the configuration
+    int d = 0, a = 1, b = 2, c = 3;
+    ok &= (started[a] >= 0 && started[b] > homed[a] && started[c] > homed[a]);
+    ok &= (started[d] > homed[b] && started[d] > homed[c]);
+
+    // b and c home concurrently
+    ok &= (started[b] == started[c]);
+
+    for(unsigned int i = 0; i < chain.size(); ++i)
+        ok &= (chain[i]->status() == tue::control::ACTIVE && chain[i]->is_homed()
+               && std::abs(chain[i]->measurement()) < 0.005);
+
+    // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+    // A timeout stops the joints that are homing concurrently (they are no longer supervised), but
+    // does not touch the joints that did not start
+
+    tue::control::HomingCoordinator aborted;
+    for(unsigned int i = 0; i < timeout.size(); ++i)
+        aborted.addController(timeout[i]);
+
+    if (!aborted.initialize(dt))
+    {
+        std::cerr << aborted.error_message() << std::endl;
+        return 1;
+    }
+
+    std::vector<tue::control::PlantModel> timeout_plants(timeout.size());
+    aborted.start();
+
+    // Keep updating the controllers well after the failure
+    int failed_tick = -1;
+    bool slow_homing_after_failure = false;
+    for(t = 0; t < 2000; ++t)
+    {
+        for(unsigned int i = 0; i < timeout.size(); ++i)
+        {
+            tue::control::SupervisedController& c = *timeout[i];
+            c.update(timeout_plants[i].position());
+            timeout_plants[i].update(c.output(), dt);
+
+            if (std::abs(timeout_plants[i].position()) > 0.02)
+                timeout_plants[i].reset(timeout_plants[i].position() > 0 ? 0.02 : -0.02);
+        }
+
+        aborted.update();
+
+        if (aborted.failed() && failed_tick < 0)
+            failed_tick = t;
+        else if (failed_tick >= 0 && timeout[1]->status() == tue::control::HOMING)
+            slow_homing_after_failure = true;
+    }
+
+    std::cout << "Timeout: " << aborted.error_message() << " at " << failed_tick * dt << " s" << std::endl;
+    for(unsigned int i = 0; i < timeout.size(); ++i)
+        std::cout << timeout[i]->name() << ": " << timeout[i]->status_string() << " " << timeout[i]->error_message()
+                  << ", position " << timeout_plants[i].position() << std::endl;
+
+    typedef tue::control::HomingCoordinator HC;
+    ok &= aborted.failed() && failed_tick >= 0 && !slow_homing_after_failure;
+    ok &= (aborted.state(0) == HC::FAILED && aborted.state(1) == HC::FAILED && aborted.state(2) == HC::WAITING);
+    ok &= (timeout[0]->status() == tue::control::ERROR && timeout[1]->status() == tue::control::ERROR);
+    ok &= (timeout[1]->error_message().find("aborted") != std::string::npos);
+    ok &= (timeout[2]->status() != tue::control::ERROR && timeout[2]->status() != tue::control::HOMING);
+
+    if (!ok)
+    {
+        std::cerr << "Joints were not homed in the order of their preconditions, or not stopped on a failure" << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,97 @@
+#include <tue/control/controller_factory.h>
+#include <tue/control/supervised_controller.h>
+
+#include <tue/control/setpoint_controller.h>
+
+#include "plant.h"
+
+// ----------------------------------------------------------------------------------------------------
+
+// Moves a flexible link with a step reference, and returns the residual vibration of the tip after
+// the shaped move has finished, relative to the step size
+double residualVibration(tue::control::SupervisedController& c, double frequency, double dt, double step)
+{
+    FlexibleLink link(frequency);
+    link.setPosition(0);
+
+    c.disable();
+    c.update(link.base());
+    c.enable();
+    c.update(link.base());
+    c.setReference(step);
+
+    double settle_time = c.input_shaper().duration() + 2 * dt;
+
+    double residual = 0;
+    for(int t = 0; t < 2000; ++t)
+    {
+        c.update(link.base());
+        link.update(c.output(), dt);
+
+        if (t * dt > settle_time)
+            residual = std::max(residual, std::abs(link.tip() - step) / step);
+    }
+
+    return residual;
+}
+
+// ----------------------------------------------------------------------------------------------------
+
+int main(int argc, char **argv)
+{
+    if (argc != 2)
+    {
+        std::cerr << "Please provide config file" << std::endl;
+        return 1;
+    }
+
+    tue::Configuration config;
+    config.loadFromYAMLFile(argv[1]);
+    if (config.hasError())
+    {
+        std::cerr << config.error() << std::endl;
+        return 1;
+    }
+
+    double dt;
+    config.value("dt", dt);
+
+    // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+    // Unshaped, ZV, ZVD and EI (all for a 10 Hz mode)
+
+    tue::control::ControllerFactory factory;
+    factory.registerControllerType<tue::control::SetpointController>("setpoint");
+
+    std::vector<std::shared_ptr<tue::control::SupervisedController> > controllers;
+    if (!factory.createControllers(config, dt, controllers) || controllers.size() != 4)
+    {
+        std::cerr << config.error() << std::endl;
+        return 1;
+    }
+
+    // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+    // Residual vibration with the mode at the nominal frequency, and 10% off
+
+    double step = 0.1;
+
+    double nominal[4], off[4];
+    for(unsigned int i = 0; i < 4; ++i)
+    {
+        nominal[i] = residualVibration(*controllers[i], 10, dt, step);
+        off[i] = residualVibration(*controllers[i], 11, dt, step);
+
+        std::cout << controllers[i]->name() << ": residual vibration = " << 100 * nominal[i] << "% (10 Hz), "
+                  << 100 * off[i] << "% (11 Hz), delay = " << controllers[i]->input_shaper().duration() << " s"
+                  << std::endl;
+    }
+
+    // ZV and ZVD cancel the nominal mode, EI up to its tolerance; ZVD and EI are more robust than ZV
+    if (nominal[0] < 0.9 || nominal[1] > 0.01 || nominal[2] > 0.01 || nominal[3] > 0.06
+            || off[2] >= off[1] || off[3] >= off[1])
+    {
+        std::cerr << "Input shaping did not suppress the residual vibration as expected" << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
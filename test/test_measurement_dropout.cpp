@@ -0,0 +1,101 @@
+#include <tue/control/controller_factory.h>
+#include <tue/control/supervised_controller.h>
+
+#include <tue/control/generic_controller.h>
+
+#include <tue/control/plant_model.h>
+
+#include <cmath>
+
+// ----------------------------------------------------------------------------------------------------
+
+// Runs 'ticks' updates, with NaN measurements in the first 'dropouts' of them. Returns false if the
+// controller leaves 'status' at any point after the dropouts.
+bool run(tue::control::SupervisedController& c, tue::control::PlantModel& plant, double dt, unsigned int ticks,
+         unsigned int dropouts, tue::control::ControllerStatus status)
+{
+    bool ok = true;
+    for(unsigned int t = 0; t < ticks; ++t)
+    {
+        c.update(t < dropouts ? tue::control::INVALID_DOUBLE : plant.position());
+        plant.update(c.output(), dt);
+
+        if (t >= dropouts && c.status() != status)
+            ok = false;
+    }
+    return ok;
+}
+
+// ----------------------------------------------------------------------------------------------------
+
+int main(int argc, char **argv)
+{
+    if (argc != 2)
+    {
+        std::cerr << "Please provide config file" << std::endl;
+        return 1;
+    }
+
+    tue::Configuration config;
+    config.loadFromYAMLFile(argv[1]);
+    if (config.hasError())
+    {
+        std::cerr << config.error() << std::endl;
+        return 1;
+    }
+
+    double dt;
+    config.value("dt", dt);
+
+    tue::control::ControllerFactory factory;
+    factory.registerControllerType<tue::control::GenericController>("generic");
+
+    std::shared_ptr<tue::control::SupervisedController> c = factory.createController(config, dt);
+    if (config.hasError() || !c->measurement_filter().is_configured())
+    {
+        std::cerr << config.error() << std::endl;
+        return 1;
+    }
+
+    // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+    tue::control::PlantModel plant;
+    plant.reset(0);
+
+    c->enable();
+    c->update(plant.position());
+    c->setReference(0.01);
+
+    bool ok = true;
+
+    // Settle, then a burst within the budget (bridged by extrapolation)
+    ok &= run(*c, plant, dt, 2000, 0, tue::control::ACTIVE);
+    ok &= run(*c, plant, dt, 1000, 3, tue::control::ACTIVE);
+    std::cout << "Burst of 3 dropouts: " << c->status_string() << std::endl;
+
+    // Burst longer than the budget
+    ok &= run(*c, plant, dt, 100, 20, tue::control::ERROR);
+    std::cout << "Burst of 20 dropouts: " << c->status_string() << " (" << c->error_message() << ")" << std::endl;
+
+    // The joint moves (far beyond max_jump) while in error; the valid samples must not trip the
+    // budget again
+    plant.reset(0.3);
+    ok &= run(*c, plant, dt, 100, 0, tue::control::ERROR);
+
+    c->enable();
+    ok &= run(*c, plant, dt, 2000, 0, tue::control::ACTIVE);
+
+    // Enabling resets the reference to the measurement
+    double error = std::abs(c->measurement() - 0.3);
+    std::cout << "After enable: " << c->status_string() << ", error = " << error << ", dropouts = "
+              << c->measurement_filter().num_dropouts() << ", rejected = " << c->measurement_filter().num_rejected()
+              << std::endl;
+
+    if (!ok || error > 1e-3)
+    {
+        std::cerr << "Controller did not recover after exceeding the dropout budget" << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
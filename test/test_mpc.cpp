@@ -0,0 +1,87 @@
+#include <tue/control/controller_factory.h>
+#include <tue/control/supervised_controller.h>
+
+#include <tue/control/mpc_controller.h>
+
+#include <tue/control/plant_model.h>
+
+// ----------------------------------------------------------------------------------------------------
+
+int main(int argc, char **argv)
+{
+    if (argc != 2)
+    {
+        std::cerr << "Please provide config file" << std::endl;
+        return 1;
+    }
+
+    tue::Configuration config;
+    config.loadFromYAMLFile(argv[1]);
+    if (config.hasError())
+    {
+        std::cerr << config.error() << std::endl;
+        return 1;
+    }
+
+    double dt;
+    config.value("dt", dt);
+
+    double input_limit;
+    config.value("input_limit", input_limit);
+
+    // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+    std::shared_ptr<tue::control::MPCController> mpc = std::make_shared<tue::control::MPCController>();
+    mpc->setName("mpc_joint");
+    mpc->configure(config, dt);
+
+    tue::control::SupervisedController c;
+    c.setController(mpc);
+    c.configure(config, dt);
+
+    if (config.hasError())
+    {
+        std::cerr << config.error() << std::endl;
+        return 1;
+    }
+
+    // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+    // Step response against a plant with an unknown constant disturbance force (e.g. gravity)
+
+    double step = 0.01;
+    double disturbance = -1;
+
+    tue::control::PlantModel plant;
+    plant.reset(0);
+
+    c.enable();
+    c.update(plant.position());
+    c.setReference(step);
+
+    double overshoot = 0;
+    double max_output = 0;
+    for(int t = 0; t < 2000; ++t)
+    {
+        c.update(plant.position());
+        plant.update(c.output() + disturbance, dt);
+
+        overshoot = std::max(overshoot, (plant.position() - step) / step);
+        max_output = std::max(max_output, std::abs(c.output()));
+    }
+
+    double final_error = std::abs(plant.position() - step);
+
+    std::cout << "MPC step response: overshoot = " << 100 * overshoot << "%, final error = " << final_error
+              << ", max |output| = " << max_output << std::endl;
+    // The number of operations is fixed; the measured maximum also includes preemption by the OS
+    std::cout << "Solve: " << mpc->operations() << " multiply-adds, max time = " << 1e6 * mpc->max_solve_time() << " us"
+              << std::endl;
+
+    if (c.status() == tue::control::ERROR || final_error > 1e-3 * step || max_output > input_limit + 1e-9)
+    {
+        std::cerr << "MPC did not track the step within the input limit" << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,149 @@
+#include <tue/control/controller_factory.h>
+#include <tue/control/supervised_controller.h>
+
+#include <tue/control/gain_scheduled_controller.h>
+#include <tue/control/generic_controller.h>
+
+#include <tue/control/plant_model.h>
+
+#include <chrono>
+
+// ----------------------------------------------------------------------------------------------------
+
+// Creates the controllers of the given group (or the root if empty) of a freshly loaded
+// configuration, and returns the aggregated errors
+
+std::string create(const tue::control::ControllerFactory& factory, const char* path, const std::string& group,
+                   unsigned int num_threads, std::vector<std::shared_ptr<tue::control::SupervisedController> >& controllers,
+                   bool& ok, double& duration)
+{
+    tue::Configuration config;
+    config.loadFromYAMLFile(path);
+
+    double dt;
+    config.value("dt", dt);
+
+    if (!group.empty())
+        config.readGroup(group);
+
+    std::chrono::steady_clock::time_point t_start = std::chrono::steady_clock::now();
+    ok = factory.createControllers(config, dt, controllers, num_threads);
+    duration = std::chrono::duration<double>(std::chrono::steady_clock::now() - t_start).count();
+
+    return config.error();
+}
+
+// ----------------------------------------------------------------------------------------------------
+
+// Step response of every controller with a unit mass plant
+
+void simulate(std::vector<std::shared_ptr<tue::control::SupervisedController> >& controllers, double dt,
+              std::vector<double>& outputs)
+{
+    outputs.clear();
+    for(unsigned int i = 0; i < controllers.size(); ++i)
+    {
+        tue::control::SupervisedController& c = *controllers[i];
+        tue::control::PlantModel plant;
+        plant.reset(0);
+
+        c.enable();
+        c.update(plant.position());
+        c.setReference(0.05);
+
+        for(unsigned int t = 0; t < 1000; ++t)
+        {
+            c.update(plant.position());
+            plant.update(c.output(), dt);
+            outputs.push_back(c.output());
+        }
+    }
+}
+
+// ----------------------------------------------------------------------------------------------------
+
+int main(int argc, char **argv)
+{
+    if (argc != 2)
+    {
+        std::cerr << "Please provide config file" << std::endl;
+        return 1;
+    }
+
+    double dt = 0.001;
+
+    tue::control::ControllerFactory factory;
+    factory.registerControllerType<tue::control::GenericController>("generic");
+    factory.registerControllerType<tue::control::GainScheduledController>("gain_scheduled");
+
+    // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+    // Serial construction as the reference
+
+    std::vector<std::shared_ptr<tue::control::SupervisedController> > serial;
+    bool ok;
+    double serial_duration;
+    std::string error = create(factory, argv[1], "", 1, serial, ok, serial_duration);
+    if (!ok || serial.size() != 16)
+    {
+        std::cerr << error << std::endl;
+        return 1;
+    }
+
+    std::vector<double> serial_outputs;
+    simulate(serial, dt, serial_outputs);
+
+    // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+    // Parallel construction, repeatedly: every controller must get its own configuration (same
+    // order, names and behaviour as the serial construction)
+
+    unsigned int num_runs = 20, mismatches = 0;
+    double parallel_duration = 0;
+    for(unsigned int run = 0; run < num_runs; ++run)
+    {
+        std::vector<std::shared_ptr<tue::control::SupervisedController> > parallel;
+        double duration;
+        error = create(factory, argv[1], "", 8, parallel, ok, duration);
+        parallel_duration += duration / num_runs;
+
+        bool same = ok && parallel.size() == serial.size();
+        for(unsigned int i = 0; same && i < parallel.size(); ++i)
+            same = (parallel[i] && parallel[i]->name() == serial[i]->name());
+
+        std::vector<double> outputs;
+        if (same)
+        {
+            simulate(parallel, dt, outputs);
+            same = (outputs == serial_outputs);
+        }
+
+        if (!same)
+            ++mismatches;
+    }
+
+    std::cout << "Parallel construction: " << mismatches << " of " << num_runs << " runs differ from the serial one ("
+              << 1000 * serial_duration << " ms serial, " << 1000 * parallel_duration << " ms parallel)" << std::endl;
+
+    // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+    // Errors are reported in configuration order, and only the invalid controllers are missing
+
+    std::vector<std::shared_ptr<tue::control::SupervisedController> > invalid_serial, invalid_parallel;
+    bool ok_serial, ok_parallel;
+    double duration;
+    std::string error_serial = create(factory, argv[1], "invalid", 1, invalid_serial, ok_serial, duration);
+    std::string error_parallel = create(factory, argv[1], "invalid", 8, invalid_parallel, ok_parallel, duration);
+
+    bool errors_ok = !ok_serial && !ok_parallel && error_serial == error_parallel && invalid_parallel.size() == 6;
+    for(unsigned int i = 0; errors_ok && i < invalid_parallel.size(); ++i)
+        errors_ok = (static_cast<bool>(invalid_parallel[i]) == (i != 2 && i != 4));
+
+    std::cout << "Invalid configuration: " << (errors_ok ? "same errors" : "DIFFERENT errors")
+              << " serial and parallel:" << std::endl << error_parallel << std::endl;
+
+    if (mismatches > 0 || !errors_ok)
+    {
+        std::cerr << "Parallel construction does not match the serial construction" << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,196 @@
+#include <tue/control/controller_factory.h>
+#include <tue/control/supervised_controller.h>
+
+#include <tue/control/generic_controller.h>
+
+#include <tue/control/plant_server.h>
+
+#include <cmath>
+#include <iostream>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+// ----------------------------------------------------------------------------------------------------
+
+// Runs a set of controllers in real time against simulated plants, exchanging measurements and
+// outputs through a shared memory process image, and reports the response times of the loop.
+
+int main(int argc, char **argv)
+{
+    if (argc != 2)
+    {
+        std::cerr << "Please provide config file" << std::endl;
+        return 1;
+    }
+
+    tue::Configuration config;
+    config.loadFromYAMLFile(argv[1]);
+    if (config.hasError())
+    {
+        std::cerr << config.error() << std::endl;
+        return 1;
+    }
+
+    double dt, duration, step;
+    config.value("dt", dt);
+    config.value("duration", duration);
+    config.value("step", step);
+
+    // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+    // Plants
+
+    tue::control::PlantServer server;
+
+    if (config.readArray("plants"))
+    {
+        while(config.nextArrayItem())
+        {
+            std::shared_ptr<tue::control::PlantModel> plant = std::make_shared<tue::control::PlantModel>();
+            plant->configure(config);
+            server.addPlant(plant);
+        }
+        config.endArray();
+    }
+
+    // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+    // Controllers (one per plant)
+
+    tue::control::ControllerFactory factory;
+    factory.registerControllerType<tue::control::GenericController>("generic");
+
+    std::vector<std::shared_ptr<tue::control::SupervisedController> > controllers;
+    if (!factory.createControllers(config, dt, controllers) || config.hasError())
+    {
+        std::cerr << config.error() << std::endl;
+        return 1;
+    }
+
+    // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+    // Start the bus, and connect to it as the controller process would
+
+    if (!server.open("tue_control_test_plant_server"))
+    {
+        std::cerr << server.error_message() << std::endl;
+        return 1;
+    }
+
+    tue::control::ProcessImage image;
+    if (!image.open("tue_control_test_plant_server") || image.num_joints() != controllers.size())
+    {
+        std::cerr << "Could not open the process image: " << image.error_message() << std::endl;
+        server.close();
+        return 1;
+    }
+
+    server.start(dt, 50);
+
+    // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+    // Controller loop, paced by the bus
+
+    std::vector<double> outputs(controllers.size(), 0);
+
+    tue::control::ProcessData inputs;
+    inputs.cycle = 0;
+
+    unsigned long num_ticks = duration / dt;
+    unsigned long timeouts = 0;
+
+    for(unsigned long tick = 0; tick < num_ticks; ++tick)
+    {
+        if (!image.waitForInputs(inputs.cycle, inputs, 0.1))
+        {
+            ++timeouts;
+            continue;
+        }
+
+        for(unsigned int i = 0; i < controllers.size(); ++i)
+        {
+            tue::control::SupervisedController& c = *controllers[i];
+            c.update(inputs.values[i]);
+
+            if (tick == 0)
+            {
+                c.enable();
+                c.update(inputs.values[i]);
+                c.setReference(step);
+            }
+
+            outputs[i] = c.output();
+        }
+
+        image.writeOutputs(inputs.cycle, &outputs[0]);
+    }
+
+    server.stop();
+
+    // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+    // Controller process that died while writing its outputs, which leaves the sequence odd: after
+    // a restart, the outputs it writes must be readable again
+
+    image.close();
+
+    bool restart_ok = false;
+    int fd = shm_open("/tue_control_test_plant_server", O_RDWR, 0600);
+    void* p = fd >= 0 ? mmap(0, sizeof(tue::control::ProcessImageBuffer), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0) : MAP_FAILED;
+    if (fd >= 0)
+        close(fd);
+
+    if (p != MAP_FAILED)
+    {
+        tue::control::ProcessImageBuffer* buffer = static_cast<tue::control::ProcessImageBuffer*>(p);
+        buffer->output_sequence.store(buffer->output_sequence.load() | 1);
+
+        tue::control::ProcessImage restarted;
+        if (restarted.open("tue_control_test_plant_server"))
+        {
+            restarted.writeOutputs(inputs.cycle + 1, &outputs[0]);
+
+            tue::control::ProcessData written;
+            restart_ok = restarted.readOutputs(written) && written.cycle == inputs.cycle + 1
+                         && buffer->output_sequence.load() % 2 == 0;
+            restarted.close();
+        }
+
+        munmap(p, sizeof(tue::control::ProcessImageBuffer));
+    }
+
+    std::cout << "Outputs after a restart of the controller process: " << (restart_ok ? "readable" : "NOT readable")
+              << std::endl;
+
+    // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+    // Report
+
+    const tue::control::PlantServerStatistics& s = server.statistics();
+
+    std::cout << "Cycles: " << s.cycles << ", missed: " << s.missed << ", controller timeouts: " << timeouts
+              << std::endl;
+    std::cout << "Response time: mean = " << 1e6 * s.response_time_mean << " us, max = " << 1e6 * s.response_time_max
+              << " us" << std::endl;
+    std::cout << "Bus cycle max wakeup latency: " << 1e6 * s.wakeup_latency_max << " us" << std::endl;
+
+    bool ok = (s.responses > 0 && restart_ok);
+    for(unsigned int i = 0; i < controllers.size(); ++i)
+    {
+        const tue::control::SupervisedController& c = *controllers[i];
+        double error = std::abs(inputs.values[i] - step);
+
+        std::cout << c.name() << ": final error = " << error << (c.status() == tue::control::ERROR ? " (ERROR)" : "")
+                  << std::endl;
+
+        // Missed cycles (the OS is not real-time) only delay the outputs, so all joints must settle
+        if (c.status() == tue::control::ERROR || error > 0.05 * step)
+            ok = false;
+    }
+
+    server.close();
+
+    if (!ok)
+    {
+        std::cerr << "Not all joints reached the reference, or the outputs were not readable after a restart" << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
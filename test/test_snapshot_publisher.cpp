@@ -0,0 +1,155 @@
+#include <tue/control/controller_factory.h>
+#include <tue/control/supervised_controller.h>
+
+#include <tue/control/generic_controller.h>
+#include <tue/control/snapshot_publisher.h>
+
+#include <atomic>
+#include <thread>
+
+// ----------------------------------------------------------------------------------------------------
+
+// Result of one reader thread
+struct ReaderResult
+{
+    ReaderResult() : reads(0), retries(0), torn(0), backwards(0) {}
+
+    unsigned long reads;
+    unsigned long retries;
+
+    // Snapshots that mix joints of different ticks, or do not match their tick
+    unsigned long torn;
+
+    // Snapshots older than the previous one of the same reader
+    unsigned long backwards;
+};
+
+// ----------------------------------------------------------------------------------------------------
+
+int main(int argc, char **argv)
+{
+    if (argc != 2)
+    {
+        std::cerr << "Please provide config file" << std::endl;
+        return 1;
+    }
+
+    tue::Configuration config;
+    config.loadFromYAMLFile(argv[1]);
+    if (config.hasError())
+    {
+        std::cerr << config.error() << std::endl;
+        return 1;
+    }
+
+    double dt;
+    config.value("dt", dt);
+
+    tue::control::ControllerFactory factory;
+    factory.registerControllerType<tue::control::GenericController>("generic");
+
+    std::vector<std::shared_ptr<tue::control::SupervisedController> > controllers;
+    if (!factory.createControllers(config, dt, controllers))
+    {
+        std::cerr << config.error() << std::endl;
+        return 1;
+    }
+
+    // The smallest ring, so the writer regularly overwrites the slot a reader is copying
+    tue::control::SnapshotPublisher publisher;
+    for(unsigned int i = 0; i < controllers.size(); ++i)
+    {
+        publisher.addController(controllers[i]);
+        controllers[i]->enable();
+        controllers[i]->update(0);
+    }
+    publisher.initialize(2);
+
+    std::vector<tue::control::JointSnapshot> joints;
+    unsigned long tick;
+    if (publisher.read(joints, tick))
+    {
+        std::cerr << "Read succeeded before anything was published" << std::endl;
+        return 1;
+    }
+
+    // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+    // Writer as fast as possible: the references of all joints encode the tick
+
+    const unsigned int num_readers = 3;
+    const unsigned long num_ticks = 2000000;
+
+    std::atomic<bool> done(false);
+    std::vector<ReaderResult> results(num_readers);
+    std::vector<std::thread> readers;
+
+    for(unsigned int r = 0; r < num_readers; ++r)
+    {
+        readers.push_back(std::thread([&, r]()
+        {
+            ReaderResult& result = results[r];
+            std::vector<tue::control::JointSnapshot> joints;
+            unsigned long tick, previous = 0;
+            unsigned int retries;
+
+            while(!done.load())
+            {
+                if (!publisher.read(joints, tick, retries))
+                    continue;
+
+                ++result.reads;
+                result.retries += retries;
+
+                if (tick < previous)
+                    ++result.backwards;
+                previous = tick;
+
+                for(unsigned int i = 0; i < joints.size(); ++i)
+                {
+                    const tue::control::JointSnapshot& j = joints[i];
+                    if (j.pos_reference != tick || j.vel_reference != i || j.acc_reference != 2.0 * tick)
+                    {
+                        ++result.torn;
+                        break;
+                    }
+                }
+            }
+        }));
+    }
+
+    for(unsigned long t = 1; t <= num_ticks; ++t)
+    {
+        for(unsigned int i = 0; i < controllers.size(); ++i)
+            controllers[i]->setReference(t, i, 2.0 * t);
+
+        publisher.publish();
+    }
+
+    done.store(true);
+    for(unsigned int r = 0; r < num_readers; ++r)
+        readers[r].join();
+
+    // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+    // Report
+
+    bool ok = (publisher.ticks() == num_ticks && publisher.read(joints, tick) && tick == num_ticks
+               && joints[0].pos_reference == num_ticks);
+
+    for(unsigned int r = 0; r < num_readers; ++r)
+    {
+        const ReaderResult& result = results[r];
+        std::cout << "Reader " << r << ": " << result.reads << " reads, " << result.retries << " retries, "
+                  << result.torn << " torn, " << result.backwards << " backwards" << std::endl;
+
+        if (result.torn > 0 || result.backwards > 0)
+            ok = false;
+    }
+
+    if (!ok)
+    {
+        std::cerr << "Inconsistent snapshots" << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,150 @@
+#include <tue/control/controller_factory.h>
+#include <tue/control/supervised_controller.h>
+
+#include <tue/control/generic_controller.h>
+#include <tue/control/state_observer.h>
+
+#include <tue/control/plant_model.h>
+
+#include <cmath>
+
+// ----------------------------------------------------------------------------------------------------
+
+int main(int argc, char **argv)
+{
+    if (argc != 2)
+    {
+        std::cerr << "Please provide config file" << std::endl;
+        return 1;
+    }
+
+    tue::Configuration config;
+    config.loadFromYAMLFile(argv[1]);
+    if (config.hasError())
+    {
+        std::cerr << config.error() << std::endl;
+        return 1;
+    }
+
+    double dt, mass, load;
+    config.value("dt", dt);
+    config.value("mass", mass);
+    config.value("load", load);
+
+    tue::control::StateObserver alpha_beta, kalman;
+    if (config.readGroup("alpha_beta"))
+    {
+        alpha_beta.configure(config, dt);
+        config.endGroup();
+    }
+
+    if (config.readGroup("kalman"))
+    {
+        kalman.configure(config, dt);
+        config.endGroup();
+    }
+
+    tue::control::GenericController damping;
+    if (config.readGroup("damping"))
+    {
+        damping.configure(config, dt);
+        config.endGroup();
+    }
+
+    tue::control::ControllerFactory factory;
+    factory.registerControllerType<tue::control::GenericController>("generic");
+
+    std::vector<std::shared_ptr<tue::control::SupervisedController> > controllers;
+    if (!factory.createControllers(config, dt, controllers) || config.hasError()
+            || !alpha_beta.is_configured() || !kalman.is_configured())
+    {
+        std::cerr << config.error() << std::endl;
+        return 1;
+    }
+
+    bool ok = true;
+
+    // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+    // Alpha-beta: velocity of a constant velocity motion (the input is not used)
+
+    double velocity = 0.3;
+    for(unsigned int t = 0; t <= 2000; ++t)
+        alpha_beta.update(velocity * t * dt, 0);
+
+    std::cout << "alpha_beta: velocity = " << alpha_beta.velocity() << " (true " << velocity << ")" << std::endl;
+    ok &= (std::abs(alpha_beta.velocity() - velocity) < 1e-6 && std::abs(alpha_beta.position() - velocity * 2) < 1e-6);
+
+    // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+    // Kalman: velocity and the unknown load on a mass driven by a known (sinusoidal) force
+
+    tue::control::PlantParameters params;
+    params.mass = mass;
+
+    tue::control::PlantModel plant(params);
+    plant.reset(0);
+
+    double force = 0;
+    for(unsigned int t = 0; t <= 5000; ++t)
+    {
+        kalman.update(plant.position(), force);
+        force = std::sin(2 * M_PI * t * dt);
+        plant.update(force - load, dt);
+    }
+
+    std::cout << "kalman: velocity = " << kalman.velocity() << " (true " << plant.velocity() << "), disturbance = "
+              << kalman.disturbance() << " (true " << -load << ")" << std::endl;
+    ok &= (std::abs(kalman.velocity() - plant.velocity()) < 2e-3 && std::abs(kalman.disturbance() + load) < 0.01);
+
+    // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+    // Damping: acts on the difference between the reference and estimated velocity, also at zero error
+
+    tue::control::ControllerInput input;
+    input.pos_reference = 0.1;
+    input.measurement = 0.1;
+    input.vel_reference = 0.5;
+    input.vel_estimate = 0.2;
+
+    tue::control::ControllerOutput output;
+    damping.update(input, output);
+
+    std::cout << "damping: output = " << output.value << std::endl;
+    ok &= (std::abs(output.value - 20 * (0.5 - 0.2)) < 1e-12);
+
+    input.vel_estimate = tue::control::INVALID_DOUBLE;
+    damping.update(input, output);
+    ok &= (output.value == 0);
+
+    // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+    // Disturbance feedforward: without integrator, the load is only rejected if it is compensated
+
+    std::vector<tue::control::PlantModel> plants(controllers.size(), plant);
+    for(unsigned int i = 0; i < controllers.size(); ++i)
+    {
+        plants[i].reset(0);
+        controllers[i]->enable();
+    }
+
+    for(unsigned int t = 0; t <= 5000; ++t)
+    {
+        for(unsigned int i = 0; i < controllers.size(); ++i)
+        {
+            controllers[i]->update(plants[i].position());
+            plants[i].update(controllers[i]->output() - load, dt);
+        }
+    }
+
+    double error_without = controllers[0]->error();
+    double error_with = controllers[1]->error();
+
+    std::cout << "Steady state error with a load of " << load << ": " << error_without << " without, "
+              << error_with << " with disturbance compensation" << std::endl;
+    ok &= (std::abs(error_without - load / 3000) < 1e-5 && std::abs(error_with) < 1e-5);
+
+    if (!ok)
+    {
+        std::cerr << "Observer estimates do not match the plant" << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
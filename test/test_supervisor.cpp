@@ -0,0 +1,264 @@
+#include <tue/control/controller_factory.h>
+#include <tue/control/supervised_controller.h>
+
+#include <tue/control/generic_controller.h>
+#include <tue/control/supervisor.h>
+
+#include <tue/control/plant_model.h>
+
+#include <chrono>
+#include <cmath>
+#include <thread>
+
+// ----------------------------------------------------------------------------------------------------
+
+// One tick of the real-time thread: controllers, plants (with an end stop of the first joint at
+// -0.02), then the bridge
+
+void tick(std::vector<std::shared_ptr<tue::control::SupervisedController> >& controllers,
+          std::vector<tue::control::PlantModel>& plants, tue::control::SupervisorBridge& bridge, double dt)
+{
+    for(unsigned int i = 0; i < controllers.size(); ++i)
+    {
+        controllers[i]->update(plants[i].position());
+        plants[i].update(controllers[i]->output(), dt);
+    }
+
+    if (plants[0].position() < -0.02)
+        plants[0].reset(-0.02);
+
+    bridge.update();
+}
+
+// ----------------------------------------------------------------------------------------------------
+
+// Producer and consumer on separate threads, through a queue that is much smaller than the number
+// of items: every item must arrive exactly once and in order
+
+bool testQueue()
+{
+    tue::control::SPSCQueue<unsigned int> queue(10);
+    if (queue.capacity() != 16)
+    {
+        std::cerr << "SPSCQueue: capacity " << queue.capacity() << " instead of 16" << std::endl;
+        return false;
+    }
+
+    const unsigned int N = 1000000;
+
+    std::thread producer([&]()
+    {
+        for(unsigned int i = 0; i < N; ++i)
+            while(!queue.push(i))
+                std::this_thread::yield();
+    });
+
+    unsigned int expected = 0;
+    bool ok = true;
+    while(expected < N)
+    {
+        unsigned int item;
+        if (!queue.pop(item))
+        {
+            std::this_thread::yield();
+            continue;
+        }
+
+        if (item != expected)
+            ok = false;
+        ++expected;
+    }
+
+    producer.join();
+
+    unsigned int item;
+    if (!ok || queue.pop(item))
+    {
+        std::cerr << "SPSCQueue: items lost, duplicated or reordered" << std::endl;
+        return false;
+    }
+
+    std::cout << "SPSCQueue: " << N << " items passed in order" << std::endl;
+    return true;
+}
+
+// ----------------------------------------------------------------------------------------------------
+
+int main(int argc, char **argv)
+{
+    if (argc != 2)
+    {
+        std::cerr << "Please provide config file" << std::endl;
+        return 1;
+    }
+
+    tue::Configuration config;
+    config.loadFromYAMLFile(argv[1]);
+    if (config.hasError())
+    {
+        std::cerr << config.error() << std::endl;
+        return 1;
+    }
+
+    double dt;
+    config.value("dt", dt);
+
+    tue::control::ControllerFactory factory;
+    factory.registerControllerType<tue::control::GenericController>("generic");
+
+    std::vector<std::shared_ptr<tue::control::SupervisedController> > controllers;
+    if (!factory.createControllers(config, dt, controllers) || controllers.size() != 2)
+    {
+        std::cerr << config.error() << std::endl;
+        return 1;
+    }
+
+    if (!testQueue())
+        return 1;
+
+    using tue::control::Sequence;
+    using tue::control::Supervisor;
+
+    std::shared_ptr<tue::control::SupervisorBridge> bridge(new tue::control::SupervisorBridge(controllers, 64, 10));
+    Supervisor supervisor(bridge);
+
+    std::vector<tue::control::PlantModel> plants(controllers.size());
+
+    // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+    // Sequences: homing against the end stop followed by a move (shoulder), a wait for a status that
+    // never comes (elbow), one that is canceled, and one for a joint that does not exist
+
+    Sequence homing(0);
+    homing.command(tue::control::COMMAND_START_HOMING)
+          .waitForStatus(tue::control::HOMING).timeout(0.1)
+          .waitUntil([](const tue::control::JointFeedback& f) { return std::abs(f.error) > 0.005; }).timeout(5)
+          .command(tue::control::COMMAND_STOP_HOMING, 0.0)
+          .waitForStatus(tue::control::ACTIVE).timeout(0.1)
+          .command(tue::control::COMMAND_SET_REFERENCE, 0.05)
+          .waitUntil([](const tue::control::JointFeedback& f) { return std::abs(f.measurement - 0.05) < 0.001; }).timeout(2);
+
+    Sequence never(1);
+    never.command(tue::control::COMMAND_ENABLE)
+         .waitForStatus(tue::control::ACTIVE).timeout(0.1)
+         .wait(0.2)
+         .waitForStatus(tue::control::HOMING).timeout(0.3);
+
+    Sequence canceled(1);
+    canceled.waitUntil([](const tue::control::JointFeedback&) { return false; })
+            .command(tue::control::COMMAND_DISABLE);
+
+    unsigned int id_homing = supervisor.runSequence(homing);
+    unsigned int id_never = supervisor.runSequence(never);
+    unsigned int id_canceled = supervisor.runSequence(canceled);
+    unsigned int id_unknown = supervisor.runSequence(Sequence(5).command(tue::control::COMMAND_ENABLE));
+
+    // Deterministic: the supervisor spins in the same thread, every 5 ticks
+    unsigned int num_ticks = 0;
+    for(; num_ticks < 10000 && supervisor.num_running() > 0; ++num_ticks)
+    {
+        tick(controllers, plants, *bridge, dt);
+
+        if (num_ticks == 1000)
+            supervisor.cancel(id_canceled);
+
+        if (num_ticks % 5 == 0)
+            supervisor.spin(num_ticks * dt);
+    }
+
+    std::cout << "Sequences finished after " << num_ticks * dt << " s: homing = " << supervisor.state(id_homing)
+              << ", never = " << supervisor.state(id_never) << " (" << supervisor.error_message(id_never)
+              << "), canceled = " << supervisor.state(id_canceled) << ", unknown joint = "
+              << supervisor.state(id_unknown) << std::endl;
+
+    // Let the last commands take effect
+    for(unsigned int i = 0; i < 20; ++i)
+        tick(controllers, plants, *bridge, dt);
+
+    if (supervisor.state(id_homing) != Supervisor::SUCCEEDED || !controllers[0]->is_homed()
+            || controllers[0]->status() != tue::control::ACTIVE || std::abs(controllers[0]->measurement() - 0.05) > 0.001)
+    {
+        std::cerr << "Homing sequence did not home and move the shoulder: " << supervisor.error_message(id_homing) << std::endl;
+        return 1;
+    }
+
+    // The timeout drives the joint to ERROR; the canceled sequence never sends its DISABLE
+    if (supervisor.state(id_never) != Supervisor::FAILED || controllers[1]->status() != tue::control::ERROR
+            || supervisor.state(id_canceled) != Supervisor::CANCELED || supervisor.state(id_unknown) != Supervisor::FAILED)
+    {
+        std::cerr << "Timeout, cancel or unknown joint not handled" << std::endl;
+        return 1;
+    }
+
+    // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+    // Supervisor thread against a real-time loop: recover the elbow from ERROR
+
+    typedef std::chrono::steady_clock Clock;
+
+    Sequence recover(1);
+    recover.command(tue::control::COMMAND_ENABLE)
+           .waitForStatus(tue::control::ACTIVE).timeout(0.5)
+           .command(tue::control::COMMAND_DISABLE)
+           .waitForStatus(tue::control::IDLE).timeout(0.5)
+           .command(tue::control::COMMAND_ENABLE)
+           .waitForStatus(tue::control::ACTIVE).timeout(0.5);
+
+    unsigned int id_recover = supervisor.runSequence(recover);
+    supervisor.start(0.002);
+
+    Clock::time_point t_next = Clock::now();
+    for(unsigned int i = 0; i < 2000 && supervisor.num_running() > 0; ++i)
+    {
+        tick(controllers, plants, *bridge, dt);
+
+        t_next += std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(dt));
+        std::this_thread::sleep_until(t_next);
+    }
+
+    supervisor.stop();
+
+    std::cout << "Recovery: " << supervisor.state(id_recover) << ", elbow status = " << controllers[1]->status()
+              << ", dropped feedback = " << bridge->dropped_feedback() << std::endl;
+
+    if (supervisor.state(id_recover) != Supervisor::SUCCEEDED)
+    {
+        std::cerr << "Recovery sequence failed: " << supervisor.error_message(id_recover) << std::endl;
+        return 1;
+    }
+
+    // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+    // Timeout while the command queue is full: the SET_ERROR is sent as soon as there is room
+
+    std::shared_ptr<tue::control::SupervisorBridge> full_bridge(new tue::control::SupervisorBridge(controllers, 2, 10));
+    Supervisor full_supervisor(full_bridge);
+
+    unsigned int id_full = full_supervisor.runSequence(Sequence(1).waitForStatus(tue::control::HOMING).timeout(0.05));
+
+    while(full_bridge->commands().push(tue::control::SupervisorCommand(1, tue::control::COMMAND_SET_REFERENCE, 0))) {}
+
+    full_supervisor.spin(0);
+    full_supervisor.spin(0.1);
+    bool failed_while_full = (full_supervisor.state(id_full) == Supervisor::FAILED);
+
+    for(unsigned int i = 0; i < 5; ++i)
+    {
+        tick(controllers, plants, *full_bridge, dt);
+        full_supervisor.spin(0.1 + i * dt);
+    }
+
+    std::cout << "Timeout with a full command queue: elbow status = " << controllers[1]->status_string() << std::endl;
+
+    if (!failed_while_full || controllers[1]->status() != tue::control::ERROR)
+    {
+        std::cerr << "Timeout with a full command queue did not drive the joint to ERROR" << std::endl;
+        return 1;
+    }
+
+    // Ids that were never returned
+    if (full_supervisor.state(id_full + 1) != Supervisor::FAILED || full_supervisor.error_message(id_full + 1) != "Unknown sequence")
+    {
+        std::cerr << "Unknown sequence id not handled" << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
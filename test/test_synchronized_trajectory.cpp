@@ -0,0 +1,208 @@
+#include <tue/control/controller_factory.h>
+#include <tue/control/supervised_controller.h>
+
+#include <tue/control/generic_controller.h>
+#include <tue/control/synchronized_trajectory.h>
+
+#include <algorithm>
+#include <cmath>
+
+// ----------------------------------------------------------------------------------------------------
+
+struct Limits
+{
+    double vel;
+    double acc;
+    double jerk;
+};
+
+// ----------------------------------------------------------------------------------------------------
+
+// Samples the planned motion finely and checks that every joint stays within its limits, arrives at
+// the target at the end (at rest), and not before: all joints finish together. Returns the largest
+// fraction of a limit that was used.
+
+bool checkMotion(const tue::control::SynchronizedTrajectory& trajectory, const std::vector<Limits>& limits,
+                 const double* start, const double* target, double& max_usage)
+{
+    unsigned int n = trajectory.size();
+    double T = trajectory.duration();
+    double h = T / 20000;
+
+    std::vector<double> pos(n), vel(n), acc(n), prev_acc(n);
+    std::vector<double> arrival(n, 0);
+
+    bool ok = true;
+    max_usage = 0;
+
+    trajectory.sample(0, &pos[0], &vel[0], &prev_acc[0]);
+    for(unsigned int i = 0; i < n; ++i)
+        ok &= (std::abs(pos[i] - start[i]) < 1e-12 && vel[i] == 0);
+
+    for(unsigned int k = 1; k <= 20000; ++k)
+    {
+        trajectory.sample(k * h, &pos[0], &vel[0], &acc[0]);
+
+        for(unsigned int i = 0; i < n; ++i)
+        {
+            const Limits& l = limits[i];
+            double jerk = std::abs(acc[i] - prev_acc[i]) / h;
+
+            max_usage = std::max(max_usage, std::abs(vel[i]) / l.vel);
+            max_usage = std::max(max_usage, std::abs(acc[i]) / l.acc);
+            if (!std::isinf(l.jerk))
+                max_usage = std::max(max_usage, jerk / l.jerk);
+
+            // Time at which the joint has (nearly) arrived for good
+            if (std::abs(pos[i] - target[i]) > 1e-9 * std::abs(target[i] - start[i]))
+                arrival[i] = k * h;
+
+            prev_acc[i] = acc[i];
+        }
+    }
+
+    for(unsigned int i = 0; i < n; ++i)
+    {
+        ok &= (pos[i] == target[i] && vel[i] == 0 && acc[i] == 0);
+
+        // Joints that move at all, move until the end
+        if (target[i] != start[i])
+            ok &= (arrival[i] > T * 0.99);
+    }
+
+    ok &= (max_usage <= 1 + 1e-6);
+    return ok;
+}
+
+// ----------------------------------------------------------------------------------------------------
+
+int main(int argc, char **argv)
+{
+    if (argc != 2)
+    {
+        std::cerr << "Please provide config file" << std::endl;
+        return 1;
+    }
+
+    tue::Configuration config;
+    config.loadFromYAMLFile(argv[1]);
+    if (config.hasError())
+    {
+        std::cerr << config.error() << std::endl;
+        return 1;
+    }
+
+    double dt;
+    config.value("dt", dt);
+
+    tue::control::ControllerFactory factory;
+    factory.registerControllerType<tue::control::GenericController>("generic");
+
+    std::vector<std::shared_ptr<tue::control::SupervisedController> > controllers;
+    if (!factory.createControllers(config, dt, controllers))
+    {
+        std::cerr << config.error() << std::endl;
+        return 1;
+    }
+
+    // A trajectory without joints accepts any target and does nothing
+    tue::control::SynchronizedTrajectory empty;
+    if (!empty.setTarget(0) || !empty.done() || empty.size() != 0)
+    {
+        std::cerr << "Trajectory without joints" << std::endl;
+        return 1;
+    }
+    empty.update();
+
+    tue::control::SynchronizedTrajectory trajectory;
+    trajectory.configure(config, controllers, dt);
+
+    // Limits as in the configuration
+    std::vector<Limits> limits;
+    if (config.readArray("trajectory"))
+    {
+        while(config.nextArrayItem())
+        {
+            Limits l;
+            l.jerk = INFINITY;
+            config.value("max_velocity", l.vel);
+            config.value("max_acceleration", l.acc);
+            config.value("max_jerk", l.jerk, tue::OPTIONAL);
+            limits.push_back(l);
+        }
+        config.endArray();
+    }
+
+    if (config.hasError() || trajectory.size() != 3 || limits.size() != 3)
+    {
+        std::cerr << config.error() << std::endl;
+        return 1;
+    }
+
+    double current[3] = { 0, 0, 0 };
+    if (trajectory.setTarget(current))
+    {
+        std::cerr << "Target accepted while the controllers do not accept references" << std::endl;
+        return 1;
+    }
+
+    for(unsigned int i = 0; i < 3; ++i)
+    {
+        controllers[i]->enable();
+        controllers[i]->update(0);
+    }
+
+    // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+    // Long moves (velocity limited), short moves (acceleration or jerk limited), moves in opposite
+    // directions and a joint that does not move. Every motion is followed through update().
+
+    const double targets[][3] = { {  2.0, 1.0,    -3.0 },
+                                  {  1.9, 1.2,    -2.5 },
+                                  {  1.9, 1.2001, -2.5 },
+                                  {  0.5, 1.2001, -3.0 },
+                                  { -1.0, 0.0,     0.0 } };
+
+    bool ok = true;
+    for(unsigned int m = 0; m < sizeof(targets) / sizeof(targets[0]); ++m)
+    {
+        if (!trajectory.setTarget(targets[m]))
+        {
+            std::cerr << "Target not accepted" << std::endl;
+            return 1;
+        }
+
+        double max_usage;
+        bool motion_ok = checkMotion(trajectory, limits, current, targets[m], max_usage);
+
+        unsigned int ticks = 0;
+        while(!trajectory.done())
+        {
+            trajectory.update();
+            for(unsigned int i = 0; i < 3; ++i)
+                controllers[i]->update(controllers[i]->reference_position());
+            ++ticks;
+        }
+
+        for(unsigned int i = 0; i < 3; ++i)
+        {
+            motion_ok &= (controllers[i]->reference_position() == targets[m][i] && controllers[i]->reference_velocity() == 0);
+            current[i] = targets[m][i];
+        }
+
+        // The slowest joint uses (one of) its limits fully
+        motion_ok &= (max_usage > 0.99);
+        motion_ok &= (std::abs(ticks * dt - trajectory.duration()) < dt);
+
+        std::cout << "Motion " << m << ": " << trajectory.duration() << " s, " << ticks << " ticks, largest use of a limit = "
+                  << 100 * max_usage << "%" << (motion_ok ? "" : " (FAILED)") << std::endl;
+        ok &= motion_ok;
+    }
+
+    if (!ok)
+    {
+        std::cerr << "Joints violate their limits or do not finish together" << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
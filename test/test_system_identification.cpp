@@ -0,0 +1,150 @@
+#include <tue/control/controller_factory.h>
+#include <tue/control/supervised_controller.h>
+
+#include <tue/control/generic_controller.h>
+#include <tue/control/system_identification.h>
+
+#include <tue/control/plant_model.h>
+
+#include <algorithm>
+#include <cmath>
+#include <complex>
+
+// ----------------------------------------------------------------------------------------------------
+
+// Exact frequency response of the simulated mass-spring-damper at frequency f [Hz]: the semi-implicit
+// Euler discretization, from the force applied in one tick to the position measured in the next,
+// C (zI - A)^-1 B with z = exp(j 2 pi f dt)
+
+std::complex<double> plantResponse(const tue::control::PlantParameters& p, double f, double dt)
+{
+    double m = p.mass, k = p.stiffness, c = p.damping;
+
+    // State (position, velocity)
+    double a11 = 1 - k * dt * dt / m, a12 = dt * (1 - c * dt / m);
+    double a21 = -k * dt / m, a22 = 1 - c * dt / m;
+    double b1 = dt * dt / m, b2 = dt / m;
+
+    std::complex<double> z = std::exp(std::complex<double>(0, 2 * M_PI * f * dt));
+
+    // First row of (zI - A)^-1 times B
+    std::complex<double> det = (z - a11) * (z - a22) - a12 * a21;
+    return ((z - a22) * b1 + a12 * b2) / det;
+}
+
+// ----------------------------------------------------------------------------------------------------
+
+int main(int argc, char **argv)
+{
+    if (argc != 2)
+    {
+        std::cerr << "Please provide config file" << std::endl;
+        return 1;
+    }
+
+    tue::Configuration config;
+    config.loadFromYAMLFile(argv[1]);
+    if (config.hasError())
+    {
+        std::cerr << config.error() << std::endl;
+        return 1;
+    }
+
+    double dt;
+    config.value("dt", dt);
+
+    tue::control::PlantModel plant;
+    if (config.readGroup("plant"))
+    {
+        plant.configure(config);
+        config.endGroup();
+    }
+
+    tue::control::ControllerFactory factory;
+    factory.registerControllerType<tue::control::GenericController>("generic");
+
+    std::shared_ptr<tue::control::SupervisedController> c;
+    if (config.readGroup("joint"))
+    {
+        c = factory.createController(config, dt);
+        config.endGroup();
+    }
+
+    if (config.hasError() || !c || !c->identification())
+    {
+        std::cerr << config.error() << std::endl;
+        return 1;
+    }
+
+    // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+    // Identify the plant in closed loop, excited at the controller output
+
+    plant.reset(0);
+    c->enable();
+    c->update(plant.position());
+    c->startIdentification();
+
+    unsigned int num_ticks = 0;
+    for(; num_ticks < 100000 && c->identification()->is_running(); ++num_ticks)
+    {
+        c->update(plant.position());
+        plant.update(c->output(), dt);
+    }
+
+    const tue::control::FrequencyResponse& r = c->identification()->result();
+    if (c->identification()->state() != tue::control::SystemIdentification::DONE || r.size == 0)
+    {
+        std::cerr << "Identification did not finish" << std::endl;
+        return 1;
+    }
+
+    // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+    // Compare with the known plant; the closed loop must be consistent with the plant and the
+    // sensitivity (process sensitivity = plant * input sensitivity)
+
+    double max_plant_error = 0, max_loop_error = 0;
+    for(unsigned int i = 0; i < r.size; ++i)
+    {
+        std::complex<double> expected = plantResponse(plant.parameters(), r.frequency[i], dt);
+
+        double plant_error = std::abs(r.plant[i] / expected - 1.0);
+        double loop_error = std::abs(r.closed_loop[i] / (r.plant[i] * r.sensitivity[i]) - 1.0);
+        max_plant_error = std::max(max_plant_error, plant_error);
+        max_loop_error = std::max(max_loop_error, loop_error);
+
+        if (i % 4 == 0)
+            std::cout << r.frequency[i] << " Hz: |P| = " << std::abs(r.plant[i]) << " (expected " << std::abs(expected)
+                      << "), phase = " << std::arg(r.plant[i]) * 180 / M_PI << " deg (expected "
+                      << std::arg(expected) * 180 / M_PI << ")" << std::endl;
+    }
+
+    std::cout << "Identified " << r.size << " lines in " << num_ticks * dt << " s: max relative plant error = "
+              << max_plant_error << ", max closed loop inconsistency = " << max_loop_error << std::endl;
+
+    if (max_plant_error > 1e-6 || max_loop_error > 1e-9)
+    {
+        std::cerr << "Identified frequency response does not match the plant" << std::endl;
+        return 1;
+    }
+
+    // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+    // An unrelated error earlier in the configuration must not disable the identification
+
+    config.addError("Unrelated error");
+
+    tue::control::SystemIdentification identification;
+    if (config.readGroup("joint") && config.readGroup("identification"))
+    {
+        identification.configure(config, dt);
+        config.endGroup();
+        config.endGroup();
+    }
+
+    if (!identification.is_configured())
+    {
+        std::cerr << "Identification left unconfigured by an unrelated configuration error" << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,207 @@
+#include <tue/control/controller_factory.h>
+#include <tue/control/supervised_controller.h>
+
+#include <tue/control/generic_controller.h>
+#include <tue/control/telemetry.h>
+
+#include <tue/control/plant_model.h>
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iterator>
+#include <iostream>
+
+// ----------------------------------------------------------------------------------------------------
+
+struct ErrorRange
+{
+    double min;
+    double max;
+};
+
+// ----------------------------------------------------------------------------------------------------
+
+int main(int argc, char **argv)
+{
+    if (argc != 2)
+    {
+        std::cerr << "Please provide config file" << std::endl;
+        return 1;
+    }
+
+    tue::Configuration config;
+    config.loadFromYAMLFile(argv[1]);
+    if (config.hasError())
+    {
+        std::cerr << config.error() << std::endl;
+        return 1;
+    }
+
+    double dt;
+    config.value("dt", dt);
+
+    tue::control::ControllerFactory factory;
+    factory.registerControllerType<tue::control::GenericController>("generic");
+
+    std::vector<std::shared_ptr<tue::control::SupervisedController> > controllers;
+    if (!factory.createControllers(config, dt, controllers))
+    {
+        std::cerr << config.error() << std::endl;
+        return 1;
+    }
+
+    // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+    // Telemetry, starting without files of a previous run
+
+    std::string path;
+    double window = 0;
+
+    tue::control::Telemetry telemetry;
+    for(unsigned int i = 0; i < controllers.size(); ++i)
+        telemetry.addController(controllers[i]);
+
+    if (config.readGroup("telemetry"))
+    {
+        config.value("window", window);
+        if (config.readGroup("sink"))
+        {
+            config.value("path", path);
+            config.endGroup();
+        }
+
+        std::vector<std::string> files;
+        files.push_back(path + ".2");
+        files.push_back(path + ".1");
+        files.push_back(path);
+        for(unsigned int i = 0; i < files.size(); ++i)
+            std::remove(files[i].c_str());
+
+        telemetry.configure(config, dt);
+        config.endGroup();
+    }
+
+    if (config.hasError())
+    {
+        std::cerr << config.error() << std::endl;
+        return 1;
+    }
+
+    // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+    // Track a slow reference, with a single-tick disturbance on the first joint near the end
+
+    std::vector<tue::control::PlantModel> plants(controllers.size());
+
+    unsigned int num_ticks = 20000;
+    unsigned int disturbance_tick = 18123;
+    unsigned int window_size = static_cast<unsigned int>(window / dt + 0.5);
+
+    // Range of the error of the first joint per window, to compare with the telemetry
+    std::vector<ErrorRange> expected(num_ticks / window_size);
+
+    for(unsigned int i = 0; i < controllers.size(); ++i)
+    {
+        controllers[i]->enable();
+        controllers[i]->update(plants[i].position());
+    }
+
+    for(unsigned int tick = 1; tick <= num_ticks; ++tick)
+    {
+        for(unsigned int i = 0; i < controllers.size(); ++i)
+        {
+            tue::control::SupervisedController& c = *controllers[i];
+            c.setReference(0.1 * std::sin(M_PI * tick * dt));
+            c.update(plants[i].position());
+
+            double f = c.output();
+            if (i == 0 && tick == disturbance_tick)
+                f += 400;
+
+            plants[i].update(f, dt);
+        }
+
+        telemetry.update();
+
+        ErrorRange& r = expected[(tick - 1) / window_size];
+        double e = controllers[0]->error();
+        if ((tick - 1) % window_size == 0)
+            r.min = r.max = e;
+        r.min = std::min(r.min, e);
+        r.max = std::max(r.max, e);
+
+        // Writer thread
+        if (tick % 1000 == 0)
+            telemetry.flush();
+    }
+
+    telemetry.stop();
+
+    // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+    // Decode the remaining files, oldest first; each must start with a key frame
+
+    unsigned int num_frames = 0;
+    unsigned int num_files = 0;
+    bool ok = (telemetry.dropped() == 0);
+    double spike = 0;
+    double typical = 0;
+
+    const char* suffixes[] = { ".2", ".1", "" };
+    for(unsigned int f = 0; f < 3; ++f)
+    {
+        std::ifstream file((path + suffixes[f]).c_str(), std::ios::binary);
+        if (!file)
+            continue;
+
+        std::vector<unsigned char> data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+        ++num_files;
+
+        tue::control::TelemetryDecoder decoder;
+        tue::control::TelemetryFrame frame;
+        unsigned int offset = 0, size;
+
+        while(offset < data.size())
+        {
+            if (!decoder.decode(&data[offset], data.size() - offset, frame, size))
+            {
+                std::cerr << "Could not decode frame at byte " << offset << " of " << path << suffixes[f] << std::endl;
+                ok = false;
+                break;
+            }
+            offset += size;
+            ++num_frames;
+
+            // Aggregates are lossless, so the peaks must match exactly
+            const tue::control::TelemetryAggregate& error = frame.joints[0].signals[tue::control::TELEMETRY_ERROR];
+            const ErrorRange& r = expected[frame.tick / window_size - 1];
+            if (error.min != r.min || error.max != r.max)
+                ok = false;
+
+            double peak = std::max(std::abs(error.min), std::abs(error.max));
+            if (frame.tick >= disturbance_tick && frame.tick < disturbance_tick + window_size)
+                spike = peak;
+            else if (frame.tick < disturbance_tick)
+                typical = std::max(typical, peak);
+        }
+    }
+
+    // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+    // Report
+
+    double raw_bytes = 8.0 * tue::control::NUM_TELEMETRY_SIGNALS * controllers.size() * num_ticks;
+
+    std::cout << "Frames: " << telemetry.frames_written() << " written, " << num_frames << " decoded from "
+              << num_files << " files" << std::endl;
+    std::cout << "Bytes: " << telemetry.bytes_written() << " (" << double(telemetry.bytes_written()) / telemetry.frames_written()
+              << " per frame), full traces: " << raw_bytes << " (" << raw_bytes / telemetry.bytes_written()
+              << " times as much)" << std::endl;
+    std::cout << "Peak error: " << spike << " in the window of the disturbance, at most " << typical
+              << " before" << std::endl;
+
+    if (!ok || num_frames == 0 || !(spike > 10 * typical))
+    {
+        std::cerr << "Telemetry does not match the controller signals" << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
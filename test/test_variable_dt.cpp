@@ -0,0 +1,123 @@
+#include <tue/control/controller_factory.h>
+#include <tue/control/supervised_controller.h>
+
+#include <tue/control/generic_controller.h>
+#include <tue/control/gain_scheduled_controller.h>
+
+#include <tue/control/plant_model.h>
+
+#include <cmath>
+#include <cstdlib>
+
+typedef std::shared_ptr<tue::control::SupervisedController> ControllerPtr;
+
+// ----------------------------------------------------------------------------------------------------
+
+int main(int argc, char **argv)
+{
+    if (argc != 2)
+    {
+        std::cerr << "Please provide config file" << std::endl;
+        return 1;
+    }
+
+    tue::Configuration config;
+    config.loadFromYAMLFile(argv[1]);
+    if (config.hasError())
+    {
+        std::cerr << config.error() << std::endl;
+        return 1;
+    }
+
+    double dt, jitter;
+    config.value("dt", dt);
+    config.value("jitter", jitter);
+
+    tue::control::ControllerFactory factory;
+    factory.registerControllerType<tue::control::GenericController>("generic");
+    factory.registerControllerType<tue::control::GainScheduledController>("gain_scheduled");
+
+    ControllerPtr controllers[3];
+    const char* groups[] = { "estimation", "generic", "gain_scheduled" };
+    for(unsigned int i = 0; i < 3; ++i)
+    {
+        if (config.readGroup(groups[i]))
+        {
+            controllers[i] = factory.createController(config, dt);
+            config.endGroup();
+        }
+    }
+
+    if (config.hasError() || !controllers[0] || !controllers[1] || !controllers[2])
+    {
+        std::cerr << config.error() << std::endl;
+        return 1;
+    }
+
+    // Sample times with jitter (fixed seed)
+    std::srand(1);
+    std::vector<double> timestamps(5000);
+    for(unsigned int t = 1; t < timestamps.size(); ++t)
+        timestamps[t] = timestamps[t - 1] + dt + jitter * (2.0 * std::rand() / RAND_MAX - 1);
+
+    bool ok = true;
+
+    // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+    // Constant velocity motion, with a dropout every 50 samples: the extrapolation and the observer
+    // prediction are exact if they use the actual elapsed time
+
+    tue::control::SupervisedController& e = *controllers[0];
+
+    double velocity = 0.3;
+    double max_error = 0;
+    for(unsigned int t = 0; t < timestamps.size(); ++t)
+    {
+        double position = velocity * timestamps[t];
+        e.update(t % 50 == 49 ? tue::control::INVALID_DOUBLE : position, timestamps[t]);
+        if (t > 0)
+            max_error = std::max(max_error, std::abs(e.measurement() - position));
+    }
+
+    double velocity_error = std::abs(e.observer().velocity() - velocity);
+
+    std::cout << "Measurement filter: max error = " << max_error << ", observer velocity error = "
+              << velocity_error << std::endl;
+    ok &= (max_error < 1e-12 && velocity_error < 1e-9);
+
+    // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+    // The gain scheduled controller uses the same (per sample time) discretization as the generic one
+
+    tue::control::PlantModel plants[2];
+    double max_difference = 0;
+    for(unsigned int i = 1; i < 3; ++i)
+    {
+        controllers[i]->enable();
+        controllers[i]->update(0, 0);
+    }
+
+    for(unsigned int t = 1; t < timestamps.size(); ++t)
+    {
+        double h = timestamps[t] - timestamps[t - 1];
+        for(unsigned int i = 0; i < 2; ++i)
+        {
+            tue::control::SupervisedController& c = *controllers[i + 1];
+            c.setReference(t < 100 ? 0 : 0.01);
+            c.update(plants[i].position(), timestamps[t]);
+            plants[i].update(c.output(), h);
+        }
+
+        max_difference = std::max(max_difference, std::abs(controllers[2]->output() - controllers[1]->output()));
+    }
+
+    std::cout << "Gain scheduled vs generic: max output difference = " << max_difference << ", final error = "
+              << controllers[2]->error() << std::endl;
+    ok &= (max_difference < 1e-9 && std::abs(controllers[2]->error()) < 1e-4);
+
+    if (!ok)
+    {
+        std::cerr << "The actual elapsed time is not used" << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
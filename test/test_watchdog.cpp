@@ -0,0 +1,134 @@
+#include <tue/control/controller_factory.h>
+#include <tue/control/supervised_controller.h>
+
+#include <tue/control/generic_controller.h>
+#include <tue/control/watchdog.h>
+
+#include <tue/control/plant_model.h>
+
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <thread>
+
+// ----------------------------------------------------------------------------------------------------
+
+int main(int argc, char **argv)
+{
+    if (argc != 2)
+    {
+        std::cerr << "Please provide config file" << std::endl;
+        return 1;
+    }
+
+    tue::Configuration config;
+    config.loadFromYAMLFile(argv[1]);
+    if (config.hasError())
+    {
+        std::cerr << config.error() << std::endl;
+        return 1;
+    }
+
+    double dt, load;
+    config.value("dt", dt);
+    config.value("load", load);
+
+    tue::control::ControllerFactory factory;
+    factory.registerControllerType<tue::control::GenericController>("generic");
+
+    std::shared_ptr<tue::control::SupervisedController> c = factory.createController(config, dt);
+    if (config.hasError() || !c->watchdog_settings().is_configured())
+    {
+        std::cerr << config.error() << std::endl;
+        return 1;
+    }
+
+    // Output slot, as sent to the drive
+    std::atomic<double> output(0);
+
+    tue::control::Watchdog watchdog;
+    watchdog.addController(c, &output);
+    watchdog.start(0.0005);
+
+    // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+    // Real-time loop, with one late tick (within the timeout) and a stall (beyond the timeout)
+
+    typedef std::chrono::steady_clock Clock;
+
+    unsigned int late_tick = 300, stall_tick = 600, num_ticks = 800;
+    double late = 0.005, stall = 0.15;
+
+    std::atomic<bool> stalled(false);
+    std::atomic<double> last_output(0);
+    std::atomic<unsigned long> late_before_stall(0);
+
+    std::thread loop([&]()
+    {
+        tue::control::PlantModel plant;
+        plant.reset(0);
+
+        c->enable();
+
+        Clock::time_point t_next = Clock::now();
+        for(unsigned int tick = 0; tick < num_ticks; ++tick)
+        {
+            c->update(plant.position());
+            plant.update(c->output() - load, dt);
+            output.store(c->output());
+
+            t_next += std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(dt));
+            if (tick == late_tick)
+                t_next += std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(late));
+            else if (tick == stall_tick)
+            {
+                late_before_stall.store(c->late_ticks());
+                last_output.store(c->output());
+                stalled.store(true);
+                t_next += std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(stall));
+            }
+
+            std::this_thread::sleep_until(t_next);
+        }
+    });
+
+    // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+    // During the stall: ERROR, and the decaying held output
+
+    while(!stalled.load())
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+
+    std::this_thread::sleep_for(std::chrono::duration<double>(stall * 0.75));
+
+    bool tripped = watchdog.tripped(0);
+    tue::control::ControllerStatus status = c->status();
+    double held = output.load();
+
+    loop.join();
+    watchdog.stop();
+
+    bool ok = true;
+
+    std::cout << "Late ticks before the stall: " << late_before_stall.load() << std::endl;
+    ok &= (late_before_stall.load() >= 1);
+
+    std::cout << "During the stall: tripped = " << tripped << ", status = "
+              << (status == tue::control::ERROR ? "ERROR" : "not ERROR") << ", output " << last_output.load()
+              << " held as " << held << std::endl;
+    ok &= tripped && status == tue::control::ERROR;
+    ok &= (std::abs(held) > 0 && std::abs(held) < std::abs(last_output.load()) && held * last_output.load() > 0);
+
+    // The counters include the stall, and the output slot is the controller's again
+    std::cout << "After the stall: " << c->status_string() << " (" << c->error_message() << "), late ticks = "
+              << watchdog.late_ticks(0) << ", missed ticks = " << watchdog.missed_ticks(0) << ", output = "
+              << output.load() << std::endl;
+    ok &= (c->status() == tue::control::ERROR && output.load() == c->output());
+    ok &= (watchdog.late_ticks(0) >= 2 && watchdog.missed_ticks(0) >= static_cast<unsigned long>((late + stall) / dt) - 5);
+
+    if (!ok)
+    {
+        std::cerr << "Watchdog did not detect the late and missed ticks" << std::endl;
+        return 1;
+    }
+
+    return 0;
+}